@@ -0,0 +1,20 @@
+#!/bin/sh
+# Compiles a forest emitted by exportCpp() into a shared object.
+#
+# Usage:  build.sh forest.cc [libforest.so]
+#
+# The output defaults to libforest.so, beside the source.
+#
+# The compiler and flags may be overridden through CXX and CXXFLAGS.
+
+set -e
+
+if [ $# -lt 1 ]; then
+  echo "Usage:  $0 source.cc [output.so]" >&2
+  exit 1
+fi
+
+src="$1"
+out="${2:-$(dirname "$src")/lib$(basename "$src" .cc).so}"
+
+${CXX:-c++} ${CXXFLAGS:--O2} -fPIC -shared -o "$out" "$src"
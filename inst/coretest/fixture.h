@@ -0,0 +1,167 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file fixture.h
+
+   @brief Randomized forests and frames against which engines are checked.
+
+   Trees are assembled through the complex node encoding, as when read
+   from a front end, and walked node by node for reference.
+
+   @author Mark Seligman
+ */
+
+#ifndef CORETEST_FIXTURE_H
+#define CORETEST_FIXTURE_H
+
+#include "dectree.h"
+#include "forest.h"
+#include "predictframe.h"
+#include "bv.h"
+
+#include <complex>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Fixture shape:  numeric predictors precede factors in core order.
+ */
+struct Fixture {
+  static constexpr PredictorT nPredNum = 4;
+  static constexpr PredictorT nPredFac = 3;
+  static constexpr PredictorT cardinality = 5; ///< Levels per factor.
+
+  mt19937_64 rng;
+
+  Fixture(uint64_t seed) : rng(seed) {
+    DecNode::initMasks(nPredNum + nPredFac);
+  }
+
+
+  double unif() {
+    return uniform_real_distribution<double>(-1.0, 1.0)(rng);
+  }
+
+
+  /**
+     @brief Builds a random tree in level order, children adjacent.
+
+     Factor splits carry a bit for each level, plus one for the proxy
+     code of unobserved levels.
+
+     @param nPredSplit is the number of core predictors eligible to split.
+
+     @param full is true iff every terminal lies at maximal depth.
+   */
+  DecTree tree(PredictorT nPredSplit,
+	       unsigned int maxDepth,
+	       bool full = false) {
+    vector<DecNode> node(1);
+    vector<unsigned int> depth(1);
+    vector<bool> splitBit, observedBit;
+    for (IndexT nodeIdx = 0; nodeIdx < node.size(); nodeIdx++) {
+      if (depth[nodeIdx] >= maxDepth || (!full && depth[nodeIdx] > 0 && rng() % 4 == 0)) {
+	node[nodeIdx] = DecNode(complex<double>(0.0, 0.0));
+	continue;
+      }
+      PredictorT predIdx = rng() % nPredSplit;
+      DecNode split;
+      split.setPredIdx(predIdx);
+      split.setDelIdx(node.size() - nodeIdx);
+      double crit;
+      if (predIdx >= nPredNum) {
+	crit = splitBit.size();
+	for (PredictorT code = 0; code <= cardinality; code++) {
+	  splitBit.push_back(rng() % 2);
+	  observedBit.push_back(rng() % 5 != 0);
+	}
+      }
+      else {
+	crit = unif();
+	split.setInvert(rng() % 2);
+      }
+      complex<double> packed;
+      split.dump(packed);
+      node[nodeIdx] = DecNode(complex<double>(packed.real(), crit));
+      node.resize(node.size() + 2);
+      depth.insert(depth.end(), 2, depth[nodeIdx] + 1);
+    }
+
+    // Leaves are numbered as by training:  contiguously beneath each node.
+    vector<IndexRange> leafDom = Forest::leafDominators(node);
+    for (IndexT nodeIdx = 0; nodeIdx < node.size(); nodeIdx++) {
+      if (node[nodeIdx].isTerminal())
+	node[nodeIdx] = DecNode(complex<double>(0.0, leafDom[nodeIdx].getStart()));
+    }
+
+    BV facSplit(splitBit.size()), facObserved(observedBit.size());
+    for (size_t pos = 0; pos < splitBit.size(); pos++) {
+      facSplit.setBit(pos, splitBit[pos]);
+      facObserved.setBit(pos, observedBit[pos]);
+    }
+
+    vector<double> score(node.size());
+    for (auto & sc : score)
+      sc = unif();
+
+    return DecTree(node, facSplit, facObserved, score);
+  }
+
+
+  /**
+     @brief Fills a frame with uniform values, some missing.
+
+     Factor codes include the proxy.  Some numeric values are drawn
+     from the trees' own cuts, to exercise ties.
+   */
+  PredictFrame frame(size_t nRow,
+		     bool withFac,
+		     const vector<DecTree>& decTree) {
+    PredictFrame frame(nPredNum, withFac ? nPredFac : 0);
+    frame.num.resize(nRow * nPredNum);
+    frame.fac.resize(nRow * frame.getNPredFac());
+    for (auto & num : frame.num) {
+      num = rng() % 20 == 0 ? nan("") : unif();
+    }
+    for (auto & fac : frame.fac) {
+      fac = rng() % (cardinality + 1);
+    }
+    for (size_t row = 0; row < nRow; row++) {
+      const DecNode& root = decTree[rng() % decTree.size()].getNode()[0];
+      if (root.isNonterminal() && root.getPredIdx() < nPredNum && rng() % 4 == 0) {
+	complex<double> packed;
+	root.dump(packed);
+	frame.num[row * nPredNum + root.getPredIdx()] = packed.imag();
+      }
+    }
+    return frame;
+  }
+
+
+  /**
+     @return index of the terminal reached by walking the node vector.
+   */
+  static IndexT walk(const DecTree& tree,
+		     const PredictFrame& frame,
+		     size_t row) {
+    IndexT nodeIdx = 0;
+    IndexT delIdx;
+    do {
+      delIdx = tree.getNode()[nodeIdx].advance(frame, tree.getFacSplit(), tree.getFacObserved(), frame.baseFac(row), frame.baseNum(row));
+      nodeIdx += delIdx;
+    } while (delIdx != 0);
+
+    return nodeIdx;
+  }
+};
+
+#endif
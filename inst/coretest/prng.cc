@@ -0,0 +1,84 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file prng.cc
+
+   @brief Implements random variate generation without a front end.
+
+   Substitutes a seedable engine for the R session's generator, with
+   LocalScope diverting variates exactly as does the R implementation.
+
+   @author Mark Seligman
+ */
+
+#include "prng.h"
+
+#include <random>
+#include <memory>
+
+
+/**
+   @brief Stands in for the front-end session's generator.
+ */
+static mt19937_64 sessionEngine;
+
+
+/**
+   @brief Per-thread engine, installed by LocalScope.  Null iff
+   variates are to be drawn from the session.
+ */
+static thread_local unique_ptr<mt19937_64> localEngine;
+
+
+/**
+   @brief Reseeds the session, as would set.seed() in R.
+ */
+void seedSession(uint64_t seed) {
+  sessionEngine.seed(seed);
+}
+
+
+static vector<double> engineUnif(size_t len,
+				 double scale) {
+  mt19937_64& engine = localEngine ? *localEngine : sessionEngine;
+  uniform_real_distribution<double> unif(0.0, scale);
+  vector<double> rn(len);
+  for (auto & ru : rn)
+    ru = unif(engine);
+  return rn;
+}
+
+
+PRNG::LocalScope::LocalScope(double seed) {
+  localEngine = make_unique<mt19937_64>(static_cast<uint64_t>(seed * 9007199254740992.0)); // 2^53.
+}
+
+
+PRNG::LocalScope::~LocalScope() {
+  localEngine = nullptr;
+}
+
+
+vector<double> PRNG::rUnif(size_t len, double scale) {
+  return engineUnif(len, scale);
+}
+
+
+vector<size_t> PRNG::rUnifIndex(size_t len, size_t scale) {
+  vector<double> rn = engineUnif(len, scale);
+  return vector<size_t>(rn.begin(), rn.end());
+}
+
+
+vector<size_t> PRNG::rUnifIndex(const vector<size_t>& scale) {
+  vector<double> rn = engineUnif(scale.size(), 1.0);
+  vector<size_t> rnOut(rn.size());
+  for (size_t i = 0; i < rn.size(); i++)
+    rnOut[i] = rn[i] * scale[i];
+  return rnOut;
+}
@@ -0,0 +1,77 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testbagcode.cc
+
+   @brief Checks bags decoded block by block against the sampled rows.
+
+   @author Mark Seligman
+ */
+
+#include "sampler.h"
+#include "samplernux.h"
+#include "bagcode.h"
+#include "bv.h"
+#include "ompthread.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+
+
+int main() {
+  OmpThread::init(4);
+  mt19937_64 rng(28);
+  const IndexT nObs = 50000;
+  SamplerNux::setMasks(nObs);
+
+  // Sparse bags exercise multibyte deltas; the empty bag is trivial.
+  vector<vector<bool>> inBag;
+  vector<vector<SamplerNux>> samples;
+  for (double density : {0.9, 0.3, 0.01, 0.0005, 1.0}) {
+    vector<bool> bagged(nObs);
+    vector<SamplerNux> nux;
+    IndexT rowPrev = 0;
+    for (IndexT row = 0; row < nObs; row++) {
+      if (density == 1.0 || uniform_real_distribution<double>()(rng) < density) {
+	bagged[row] = true;
+	if (density != 1.0) {
+	  nux.emplace_back(row - rowPrev, 1 + rng() % 3);
+	  rowPrev = row;
+	}
+      }
+    }
+    inBag.push_back(bagged);
+    samples.push_back(nux);
+  }
+  Sampler sampler(nObs, nObs, samples);
+  unique_ptr<BagCode> bag = sampler.bagRows(true);
+
+  const unsigned int nTree = samples.size();
+  size_t nBad = 0, nCheck = 0;
+  for (size_t span : {size_t(0x1000), size_t(777)}) {
+    vector<BagCursor> cursor;
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++)
+      cursor.push_back(bag->begin(tIdx));
+    BitMatrix window(nTree, span);
+    for (size_t rowStart = 0; rowStart < nObs; rowStart += span) {
+      size_t extent = min(span, nObs - rowStart);
+      bag->decodeBlock(cursor, rowStart, extent, &window);
+      for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+	for (size_t row = rowStart; row < rowStart + extent; row++) {
+	  nBad += window.testBit(tIdx, row - rowStart) != inBag[tIdx][row];
+	  nCheck++;
+	}
+      }
+    }
+  }
+  SamplerNux::unsetMasks();
+
+  printf("bag code:  %zu of %zu bits disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
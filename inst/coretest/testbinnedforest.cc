@@ -0,0 +1,51 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testbinnedforest.cc
+
+   @brief Checks walks over binned rows against the node-by-node walk.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "binnedforest.h"
+
+#include <cstdio>
+
+
+int main() {
+  Fixture fixture(35);
+  const size_t nRow = 800;
+  size_t nBad = 0, nCheck = 0;
+  for (bool trap : {false, true}) {
+    DecNode::initTrap(trap);
+    vector<DecTree> decTree;
+    for (unsigned int tIdx = 0; tIdx < 40; tIdx++)
+      decTree.push_back(fixture.tree(Fixture::nPredNum, 10));
+    PredictFrame frame = fixture.frame(nRow, false, decTree);
+    if (!BinnedForest::eligible(decTree, frame)) {
+      printf("binned:  forest ineligible\n");
+      return 1;
+    }
+
+    BinnedForest binned(decTree, Fixture::nPredNum);
+    vector<BinnedForest::BinT> rowBin(Fixture::nPredNum);
+    for (size_t row = 0; row < nRow; row++) {
+      binned.binRow(frame.baseNum(row), rowBin.data());
+      for (unsigned int tIdx = 0; tIdx < decTree.size(); tIdx++) {
+	nBad += binned.walkBinned(rowBin.data(), tIdx) != Fixture::walk(decTree[tIdx], frame, row);
+	nCheck++;
+      }
+    }
+  }
+  DecNode::initTrap(false);
+
+  printf("binned forest:  %zu of %zu walks disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
@@ -0,0 +1,82 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testcodegen.cc
+
+   @brief Compiles an emitted forest and checks its scores against
+   those of the node-by-node walk.
+
+   The source is named with a space, and the library takes the
+   script's default output path.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "codegen.h"
+
+#include <cstdio>
+#include <dlfcn.h>
+#include <fstream>
+
+
+int main() {
+  Fixture fixture(36);
+  DecNode::initTrap(false);
+  const size_t nRow = 500;
+  const double nu = 0.1;
+  const double baseScore = 0.25;
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < 20; tIdx++)
+    decTree.push_back(fixture.tree(Fixture::nPredNum + Fixture::nPredFac, 8));
+  PredictFrame frame = fixture.frame(nRow, true, decTree);
+
+  vector<DecTree> forestTree(decTree);
+  Forest forest(std::move(forestTree), make_tuple(nu, baseScore, string("sum")), Leaf());
+  CodeGen codeGen(&forest, Fixture::nPredNum, vector<PredictorT>(Fixture::nPredFac, Fixture::cardinality));
+  ofstream("gen forest.cc") << codeGen.emit();
+  if (system("sh ../codegen/build.sh './gen forest.cc'") != 0) {
+    printf("codegen:  emitted source failed to build\n");
+    return 1;
+  }
+  void* handle = dlopen("./libgen forest.so", RTLD_NOW);
+  auto predict = handle == nullptr ? nullptr : reinterpret_cast<void (*)(const double*, const unsigned int*, size_t, double*)>(dlsym(handle, "sgb_predict"));
+  if (predict == nullptr) {
+    printf("codegen:  entry point not found\n");
+    return 1;
+  }
+
+  // Out-of-range codes take the proxy level, as does the reference.
+  vector<unsigned int> fac(frame.fac.begin(), frame.fac.end());
+  for (auto & code : fac) {
+    if (code == Fixture::cardinality && fixture.rng() % 2 == 0) {
+      const unsigned int outOfRange[] = {Fixture::cardinality + 1, 1000, 0xffffffffu};
+      code = outOfRange[fixture.rng() % 3];
+    }
+  }
+  vector<double> score(nRow);
+  predict(frame.num.data(), fac.data(), nRow, score.data());
+  dlclose(handle);
+
+  size_t nBad = 0;
+  for (size_t row = 0; row < nRow; row++) {
+    double expected = baseScore;
+    for (const DecTree& tree : decTree) {
+      expected += nu * tree.getScore(Fixture::walk(tree, frame, row));
+    }
+    nBad += fabs(score[row] - expected) > 1e-12;
+  }
+
+  remove("gen forest.cc");
+  remove("libgen forest.so");
+
+  printf("codegen:  %zu of %zu rows disagree\n", nBad, nRow);
+  return nBad != 0;
+}
@@ -0,0 +1,95 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testflatforest.cc
+
+   @brief Checks flattened walks, scalar and batched, packed and wide,
+   against the node-by-node walk.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "flatforest.h"
+
+#include <cstdio>
+
+
+/**
+   @brief Walks every row of the frame through every tree, singly and
+   in batches, and by node.
+
+   @return # disagreements.
+ */
+static size_t checkWalks(const vector<DecTree>& decTree,
+			 const PredictFrame& frame,
+			 size_t nRow,
+			 size_t& nCheck) {
+  FlatForest flat(decTree, Fixture::nPredNum);
+  size_t nBad = 0;
+  for (size_t row = 0; row < nRow; row++) {
+    for (unsigned int tIdx = 0; tIdx < decTree.size(); tIdx++) {
+      nBad += flat.walkObs(frame, row, tIdx) != Fixture::walk(decTree[tIdx], frame, row);
+      nCheck++;
+    }
+  }
+
+  IndexT leafIdx[FlatForest::batchRows];
+  for (size_t row = 0; row + FlatForest::batchRows <= nRow; row += FlatForest::batchRows) {
+    for (unsigned int tIdx = 0; tIdx < decTree.size(); tIdx++) {
+      if (!flat.isBatchable(tIdx))
+	continue;
+      flat.walkBatch(frame, row, tIdx, leafIdx);
+      for (unsigned int lane = 0; lane < FlatForest::batchRows; lane++) {
+	nBad += leafIdx[lane] != Fixture::walk(decTree[tIdx], frame, row + lane);
+	nCheck++;
+      }
+    }
+  }
+
+  return nBad;
+}
+
+
+int main() {
+  Fixture fixture(29);
+  const size_t nRow = 800;
+  size_t nBad = 0, nCheck = 0;
+  for (bool trap : {false, true}) {
+    DecNode::initTrap(trap);
+    for (PredictorT nPredSplit : {Fixture::nPredNum, Fixture::nPredNum + Fixture::nPredFac}) {
+      vector<DecTree> decTree;
+      for (unsigned int tIdx = 0; tIdx < 30; tIdx++)
+	decTree.push_back(fixture.tree(nPredSplit, 9));
+      PredictFrame frame = fixture.frame(nRow, nPredSplit > Fixture::nPredNum, decTree);
+      nBad += checkWalks(decTree, frame, nRow, nCheck);
+    }
+  }
+  DecNode::initTrap(false);
+
+  // Forests of ordinary size walk packed nodes; a single wide tree
+  // defeats packing.
+  size_t nLayout = 0;
+  for (bool wide : {false, true}) {
+    vector<DecTree> decTree;
+    for (unsigned int tIdx = 0; tIdx < 8; tIdx++)
+      decTree.push_back(fixture.tree(Fixture::nPredNum + Fixture::nPredFac, 9));
+    if (wide)
+      decTree.push_back(fixture.tree(Fixture::nPredNum, 17, true));
+    nLayout += (FlatForest(decTree, Fixture::nPredNum).getArrays().compact == nullptr) != wide;
+    PredictFrame frame = fixture.frame(nRow, true, decTree);
+    nBad += checkWalks(decTree, frame, nRow, nCheck);
+  }
+  if (nLayout != 0) {
+    printf("flat forest:  unexpected node layout\n");
+    return 1;
+  }
+
+  printf("flat forest:  %zu of %zu walks disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
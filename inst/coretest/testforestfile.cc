@@ -0,0 +1,137 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testforestfile.cc
+
+   @brief Checks scores from a forest image, viewed in place, against
+   those of the node-by-node walk, and that corrupted images are
+   rejected.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "forestfile.h"
+#include "rowscorer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+
+
+/**
+   @brief Reads an image into memory aligned as if mapped.
+ */
+static shared_ptr<char> readImage(const string& path,
+				  size_t& length) {
+  ifstream in(path, ios::binary | ios::ate);
+  length = in.tellg();
+  shared_ptr<char> image(static_cast<char*>(aligned_alloc(ForestFile::align, (length + ForestFile::align - 1) & ~(ForestFile::align - 1))), free);
+  in.seekg(0);
+  in.read(image.get(), length);
+  return image;
+}
+
+
+/**
+   @brief Views an image of a plurality forest, with its final terminal
+   score overwritten.
+
+   @return true iff the image is accepted.
+ */
+static bool viewPlurality(const vector<DecTree>& decTree,
+			  const string& path,
+			  CtgT nCtg,
+			  double lastScore) {
+  vector<DecTree> forestTree(decTree);
+  Forest forest(std::move(forestTree), make_tuple(0.0, 0.0, string("plurality")), Leaf());
+  forest.initWalkers(PredictFrame(Fixture::nPredNum, 0));
+  ForestFile::write(forest.getFlatForest(), forest.getScoreDesc(), path, Fixture::nPredNum, {}, nCtg);
+
+  size_t length;
+  shared_ptr<char> image = readImage(path, length);
+  const ForestFile::Header* header = reinterpret_cast<const ForestFile::Header*>(image.get());
+  // Branches lie strictly ahead, so the final node is terminal.
+  double* score = reinterpret_cast<double*>(image.get() + header->offset[ForestFile::score]);
+  score[header->nNode - 1] = lastScore;
+  try {
+    ForestFile forestFile(image.get(), length);
+  }
+  catch (const runtime_error&) {
+    return false;
+  }
+  return true;
+}
+
+
+int main() {
+  Fixture fixture(39);
+  DecNode::initTrap(false);
+  const size_t nRow = 500;
+  const double nu = 0.1;
+  const double baseScore = 0.25;
+  const string path = "forest.sgbf";
+  size_t nBad = 0, nCheck = 0;
+  // A single wide tree defeats node packing.
+  for (bool wide : {false, true}) {
+    vector<DecTree> decTree;
+    for (unsigned int tIdx = 0; tIdx < 20; tIdx++)
+      decTree.push_back(fixture.tree(Fixture::nPredNum + Fixture::nPredFac, 8));
+    if (wide)
+      decTree.push_back(fixture.tree(Fixture::nPredNum, 17, true));
+    PredictFrame frame = fixture.frame(nRow, true, decTree);
+
+    vector<DecTree> forestTree(decTree);
+    Forest forest(std::move(forestTree), make_tuple(nu, baseScore, string("sum")), Leaf());
+    forest.initWalkers(PredictFrame(Fixture::nPredNum, Fixture::nPredFac));
+    ForestFile::write(forest.getFlatForest(), forest.getScoreDesc(), path, Fixture::nPredNum, vector<PredictorT>(Fixture::nPredFac, Fixture::cardinality), 0);
+
+    size_t length;
+    shared_ptr<char> image = readImage(path, length);
+    ForestFile forestFile(image.get(), length);
+    if ((forestFile.getFlatForest()->getArrays().compact == nullptr) != wide) {
+      printf("forest file:  unexpected node layout\n");
+      return 1;
+    }
+    RowScorer rowScorer(forestFile.getFlatForest(), forestFile.getScoreDesc(), forestFile.getNCtg());
+    for (size_t row = 0; row < nRow; row++) {
+      double expected = baseScore;
+      for (const DecTree& tree : decTree) {
+	expected += nu * tree.getScore(Fixture::walk(tree, frame, row));
+      }
+      nBad += fabs(rowScorer.score(frame.baseNum(row), frame.baseFac(row)) - expected) > 1e-12;
+      nCheck++;
+    }
+  }
+
+  // Terminal scores of a plurality forest must index the categories.
+  const CtgT nCtg = 3;
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < 10; tIdx++) {
+    DecTree tree = fixture.tree(Fixture::nPredNum, 6);
+    vector<double> score(tree.nodeCount());
+    for (auto & sc : score)
+      sc = fixture.rng() % nCtg + 0.25;
+    decTree.emplace_back(tree.getNode(), tree.getFacSplit(), tree.getFacObserved(), score);
+  }
+  const double corrupt[] = {-0.5, nCtg, 1e300, nan("")};
+  size_t nImage = 2 + sizeof(corrupt) / sizeof(corrupt[0]);
+  size_t nMisjudged = !viewPlurality(decTree, path, nCtg, 0.0);
+  nMisjudged += viewPlurality(decTree, path, 0, 0.0);
+  for (double lastScore : corrupt) {
+    nMisjudged += viewPlurality(decTree, path, nCtg, lastScore);
+  }
+  remove(path.c_str());
+
+  printf("forest file:  %zu of %zu rows disagree\n", nBad, nCheck);
+  printf("forest file:  %zu of %zu images misjudged\n", nMisjudged, nImage);
+  return nBad + nMisjudged != 0;
+}
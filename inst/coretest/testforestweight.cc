@@ -0,0 +1,177 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testforestweight.cc
+
+   @brief Checks sparse forest weights against dense weights gathered
+   from the leaves below each final node.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "sampler.h"
+#include "samplernux.h"
+#include "rleframe.h"
+#include "forestweight.h"
+#include "predict.h"
+#include "predictbridge.h"
+#include "quant.h"
+#include "response.h"
+
+#include <cstdio>
+
+
+/**
+   @brief Collects the leaves below a node, by recursive descent.
+ */
+static void leavesBelow(const DecTree& tree,
+			IndexT nodeIdx,
+			vector<IndexT>& leaves) {
+  IndexT leafIdx;
+  if (tree.getLeafIdx(nodeIdx, leafIdx)) {
+    leaves.push_back(leafIdx);
+    return;
+  }
+  IndexT delIdx = tree.getDelIdx(nodeIdx);
+  leavesBelow(tree, nodeIdx + delIdx, leaves);
+  leavesBelow(tree, nodeIdx + delIdx + 1, leaves);
+}
+
+
+int main() {
+  Fixture fixture(45);
+  const size_t nTrain = 2000;
+  const size_t nRow = 400;
+  const unsigned int nTree = 12;
+  PredictBridge::initPredict(false, false, 0, false);
+  PredictBridge::initQuant({});
+  PredictBridge::initCtgProb(false);
+  PredictBridge::initStage({});
+  PredictBridge::initShap(false);
+  PredictBridge::initOmp(2);
+
+  vector<double> yTrain(nTrain);
+  for (auto & y : yTrain)
+    y = fixture.unif();
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++)
+    decTree.push_back(fixture.tree(Fixture::nPredNum, 6));
+
+  // Bags rows with small multiplicities, scattering samples over leaves.
+  SamplerNux::setMasks(nTrain);
+  vector<vector<SamplerNux>> samples(nTree);
+  vector<vector<size_t>> sampleObs(nTree);
+  vector<vector<IndexT>> sampleCount(nTree);
+  vector<size_t> treeHeight, leafHeight;
+  vector<IndexT> sampleIdx;
+  vector<vector<vector<IndexT>>> leafSamples(nTree);
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    size_t obsPrev = 0;
+    for (size_t obs = 0; obs < nTrain; obs++) {
+      if (fixture.rng() % 3 == 0) {
+	IndexT sCount = 1 + fixture.rng() % 3;
+	samples[tIdx].emplace_back(obs - obsPrev, sCount);
+	sampleObs[tIdx].push_back(obs);
+	sampleCount[tIdx].push_back(sCount);
+	obsPrev = obs;
+      }
+    }
+    IndexT nLeaf = 0;
+    for (const DecNode& node : decTree[tIdx].getNode())
+      nLeaf += node.isTerminal();
+    leafSamples[tIdx] = vector<vector<IndexT>>(nLeaf);
+    for (IndexT sIdx = 0; sIdx < sampleObs[tIdx].size(); sIdx++)
+      leafSamples[tIdx][fixture.rng() % nLeaf].push_back(sIdx);
+    for (const vector<IndexT>& leaf : leafSamples[tIdx]) {
+      sampleIdx.insert(sampleIdx.end(), leaf.begin(), leaf.end());
+      leafHeight.push_back(sampleIdx.size());
+    }
+    treeHeight.push_back(leafHeight.size());
+  }
+
+  PredictFrame frame = fixture.frame(nRow, false, decTree);
+  vector<double> dense(nRow * Fixture::nPredNum);
+  for (size_t row = 0; row < nRow; row++) {
+    for (PredictorT predIdx = 0; predIdx < Fixture::nPredNum; predIdx++)
+      dense[predIdx * nRow + row] = frame.baseNum(row)[predIdx];
+  }
+  Sampler sampler(yTrain, std::move(samples), nTrain, make_unique<RLEFrame>(nRow, Fixture::nPredNum, dense.data()));
+  vector<DecTree> forestTree(decTree);
+  Forest forest(std::move(forestTree), make_tuple(0.0, 0.0, string("mean")), Leaf(&sampler, treeHeight, leafHeight, sampleIdx));
+
+  // Final nodes are mostly terminal, but some walks bail early and
+  // some rows are bagged.
+  const IndexT noNode = forest.getNoNode();
+  vector<double> finalIdx(nRow * nTree);
+  for (size_t row = 0; row < nRow; row++) {
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      IndexT nodeIdx = Fixture::walk(decTree[tIdx], frame, row);
+      unsigned int draw = fixture.rng() % 8;
+      if (draw == 0) {
+	nodeIdx = noNode;
+      }
+      else if (draw == 1) {
+	unsigned int depth = fixture.rng() % 4;
+	nodeIdx = 0;
+	for (IndexT delIdx; depth-- > 0 && (delIdx = decTree[tIdx].getDelIdx(nodeIdx)) != 0; )
+	  nodeIdx += delIdx + fixture.rng() % 2;
+      }
+      finalIdx[row * nTree + tIdx] = nodeIdx;
+    }
+  }
+  SparseWeight sparse = Predict::forestWeight(&forest, &sampler, nRow, finalIdx.data());
+  // A second call reuses the cached sample ranges.
+  SparseWeight again = Predict::forestWeight(&forest, &sampler, nRow, finalIdx.data());
+
+  size_t nBad = (again.rowHeight != sparse.rowHeight) + (again.obsIdx != sparse.obsIdx) + (again.weight != sparse.weight);
+  nBad += sparse.rowHeight.size() != nRow;
+  size_t rowStart = 0;
+  for (size_t row = 0; row < nRow && row < sparse.rowHeight.size(); row++) {
+    vector<double> weight(nTrain);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      IndexT nodeIdx = finalIdx[row * nTree + tIdx];
+      if (nodeIdx == noNode)
+	continue;
+      vector<IndexT> leaves;
+      leavesBelow(decTree[tIdx], nodeIdx, leaves);
+      IndexT sCountNode = 0;
+      for (IndexT leafIdx : leaves) {
+	for (IndexT sIdx : leafSamples[tIdx][leafIdx])
+	  sCountNode += sampleCount[tIdx][sIdx];
+      }
+      for (IndexT leafIdx : leaves) {
+	for (IndexT sIdx : leafSamples[tIdx][leafIdx])
+	  weight[sampleObs[tIdx][sIdx]] += static_cast<double>(sampleCount[tIdx][sIdx]) / sCountNode;
+      }
+    }
+    double weightTot = 0.0;
+    for (double w : weight)
+      weightTot += w;
+
+    // Nonzero entries appear exactly once, in ascending order.
+    vector<double> expanded(nTrain);
+    size_t obsPrev = 0;
+    for (size_t idx = rowStart; idx < sparse.rowHeight[row]; idx++) {
+      nBad += (idx > rowStart && sparse.obsIdx[idx] <= obsPrev) || sparse.obsIdx[idx] >= nTrain || sparse.weight[idx] == 0.0;
+      obsPrev = sparse.obsIdx[idx];
+      if (obsPrev < nTrain)
+	expanded[obsPrev] = sparse.weight[idx];
+    }
+    for (size_t obs = 0; obs < nTrain; obs++) {
+      double expected = weightTot == 0.0 ? 0.0 : weight[obs] / weightTot;
+      nBad += fabs(expanded[obs] - expected) > 1e-12;
+    }
+    rowStart = sparse.rowHeight[row];
+  }
+
+  printf("forest weight:  %zu of %zu weights disagree\n", nBad, nRow * nTrain);
+  return nBad != 0;
+}
@@ -0,0 +1,165 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testframefile.cc
+
+   @brief Checks a frame image, mapped in place, against the presorted
+   frame from which it was written, and that corrupted images are
+   rejected.
+
+   @author Mark Seligman
+ */
+
+#include "rleframe.h"
+#include "framefile.h"
+#include "fixture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+
+/**
+   @return true iff the spans agree elementwise, NaN matching NaN.
+ */
+template<typename eltType>
+static bool sameSpans(const vector<ArraySpan<eltType>>& a,
+		      const vector<ArraySpan<eltType>>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t idx = 0; idx < a.size(); idx++) {
+    if (a[idx].size() != b[idx].size() || !equal(a[idx].begin(), a[idx].end(), b[idx].begin(), [](eltType x, eltType y) { return x == y || (x != x && y != y); }))
+      return false;
+  }
+  return true;
+}
+
+
+/**
+   @return true iff the runs agree, predictor by predictor.
+ */
+static bool sameRuns(const vector<ArraySpan<RLEVal<szType>>>& a,
+		     const vector<ArraySpan<RLEVal<szType>>>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t predIdx = 0; predIdx < a.size(); predIdx++) {
+    if (a[predIdx].size() != b[predIdx].size())
+      return false;
+    for (size_t idx = 0; idx < a[predIdx].size(); idx++) {
+      const RLEVal<szType>& x = a[predIdx][idx];
+      const RLEVal<szType>& y = b[predIdx][idx];
+      if (x.val != y.val || x.row != y.row || x.extent != y.extent)
+	return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+   @brief Maps an image after rewriting it with a corruption applied.
+
+   @return true iff the image is accepted.
+ */
+template<typename Corrupt>
+static bool mapCorrupted(const vector<char>& image,
+			 const string& path,
+			 Corrupt corrupt) {
+  vector<char> corrupted(image);
+  corrupt(corrupted);
+  ofstream(path, ios::binary | ios::trunc).write(corrupted.data(), corrupted.size());
+  try {
+    FrameFile frameFile(path);
+  }
+  catch (const runtime_error&) {
+    return false;
+  }
+  return true;
+}
+
+
+int main() {
+  OmpThread::init(2);
+  mt19937 rng(49);
+  const size_t nRow = 5003;
+  const string path = "frame.sgbr";
+  const vector<unsigned int> factorTop{0, 4, 0, 3};
+  vector<vector<double>> num(2, vector<double>(nRow));
+  vector<vector<unsigned int>> fac(2, vector<unsigned int>(nRow));
+  uniform_int_distribution<int> draw(0, 40);
+  for (size_t row = 0; row < nRow; row++) {
+    int x = draw(rng);
+    num[0][row] = x == 0 ? nan("") : (x - 20) * 0.25;
+    num[1][row] = normal_distribution<double>()(rng);
+    fac[0][row] = 1 + draw(rng) % 4;
+    fac[1][row] = 1 + (row / 100) % 3; // Long runs.
+  }
+  RLECresc rleCresc(nRow, factorTop.size());
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++)
+    rleCresc.setFactor(predIdx, factorTop[predIdx]);
+  rleCresc.encodeFrame({num[0].data(), fac[0].data(), num[1].data(), fac[1].data()});
+
+  // Unpacks the runs and ranked values, as does the front end.
+  vector<size_t> rleHeight = rleCresc.getHeight();
+  vector<size_t> runVal(rleHeight.back()), runLength(rleHeight.back()), runRow(rleHeight.back());
+  rleCresc.dump(runVal, runLength, runRow);
+  vector<double> numVal;
+  vector<size_t> numHeight;
+  for (const vector<double>& numPred : rleCresc.getValNum()) {
+    numVal.insert(numVal.end(), numPred.begin(), numPred.end());
+    numHeight.push_back(numVal.size());
+  }
+  vector<unsigned int> facVal;
+  vector<size_t> facHeight;
+  for (const vector<unsigned int>& facPred : rleCresc.getValFac()) {
+    facVal.insert(facVal.end(), facPred.begin(), facPred.end());
+    facHeight.push_back(facVal.size());
+  }
+  RLEFrame inMemory(nRow, rleCresc.dumpTopIdx(), runVal, runLength, runRow, rleHeight, numVal, numHeight, facVal, facHeight);
+
+  const vector<unsigned char> frontEnd{'s', 'i', 'g', 0, 0xff};
+  FrameFile::write(&inMemory, frontEnd, path);
+  size_t nBad = 0;
+  {
+    RLEFrame viewed(make_shared<const FrameFile>(path));
+    nBad += viewed.nObs != inMemory.nObs || viewed.factorTop != inMemory.factorTop;
+    nBad += !sameRuns(viewed.rlePred, inMemory.rlePred);
+    nBad += !sameSpans(viewed.numRanked, inMemory.numRanked);
+    nBad += !sameSpans(viewed.facRanked, inMemory.facRanked);
+    nBad += viewed.frameFile->getFrontEnd() != frontEnd;
+  }
+
+  // Each corruption is caught while checking the header.
+  ifstream in(path, ios::binary);
+  const vector<char> image{istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+  auto header = [](vector<char>& img) {
+    return reinterpret_cast<FrameFile::Header*>(img.data());
+  };
+  size_t nImage = 5;
+  size_t nMisjudged = !mapCorrupted(image, path, [](vector<char>&) {});
+  nMisjudged += mapCorrupted(image, path, [](vector<char>& img) {
+      img.resize(img.size() / 2);
+    });
+  nMisjudged += mapCorrupted(image, path, [&](vector<char>& img) {
+      header(img)->nPredNum++;
+    });
+  nMisjudged += mapCorrupted(image, path, [&](vector<char>& img) {
+      header(img)->offset[FrameFile::numVal] += 8;
+    });
+  nMisjudged += mapCorrupted(image, path, [&](vector<char>& img) {
+      RLEVal<szType>* run = reinterpret_cast<RLEVal<szType>*>(img.data() + header(img)->offset[FrameFile::rle]);
+      run[0].extent = nRow + 1;
+    });
+  remove(path.c_str());
+
+  printf("frame file:  %zu of 5 sections disagree\n", nBad);
+  printf("frame file:  %zu of %zu images misjudged\n", nMisjudged, nImage);
+  return nBad + nMisjudged != 0;
+}
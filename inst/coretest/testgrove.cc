@@ -0,0 +1,155 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testgrove.cc
+
+   @brief Checks that a seeded block of trees trains identically,
+   whether sequentially or concurrently.
+
+   @author Mark Seligman
+ */
+
+#include "rlecresc.h"
+#include "rleframe.h"
+#include "samplerbridge.h"
+#include "trainbridge.h"
+#include "grovebridge.h"
+#include "leafbridge.h"
+
+#include <omp.h>
+#include <complex>
+#include <cstdio>
+#include <random>
+
+
+/**
+   @brief Defined by the stand-in PRNG.
+ */
+void seedSession(uint64_t seed);
+
+
+/**
+   @brief Trained contents of a grove, as dumped to a front end.
+ */
+struct GroveDump {
+  vector<complex<double>> node;
+  vector<double> score;
+  vector<unsigned char> facSplit;
+
+  bool operator==(const GroveDump& other) const {
+    return node == other.node && score == other.score && facSplit == other.facSplit;
+  }
+};
+
+
+/**
+   @brief Unpacks an encoding as a front end would.
+ */
+static unique_ptr<RLEFrame> unpack(const RLECresc& cresc,
+				   size_t nRow) {
+  vector<size_t> rleHeight = cresc.getHeight();
+  size_t nRun = rleHeight.back();
+  vector<size_t> runVal(nRun), runLength(nRun), runRow(nRun);
+  cresc.dump(runVal, runLength, runRow);
+
+  vector<double> numVal;
+  vector<size_t> numHeight;
+  for (const vector<double>& val : cresc.getValNum()) {
+    numVal.insert(numVal.end(), val.begin(), val.end());
+    numHeight.push_back(numVal.size());
+  }
+  vector<unsigned int> facVal;
+  vector<size_t> facHeight;
+  for (const vector<unsigned int>& val : cresc.getValFac()) {
+    facVal.insert(facVal.end(), val.begin(), val.end());
+    facHeight.push_back(facVal.size());
+  }
+
+  return make_unique<RLEFrame>(nRow, cresc.dumpTopIdx(), runVal, runLength, runRow, rleHeight, numVal, numHeight, facVal, facHeight);
+}
+
+
+/**
+   @brief Trains a single block of trees as does the R front end, with
+   independent trees.
+ */
+static GroveDump trainBlock(const RLECresc& cresc,
+			    const vector<double>& y,
+			    const vector<double>& samples,
+			    unsigned int nTree,
+			    unsigned int nThread,
+			    uint64_t seed) {
+  vector<string> diag;
+  TrainBridge trainBridge(unpack(cresc, y.size()), 0.25, false, diag);
+  PredictorT nPred = trainBridge.getPredMap().size();
+  trainBridge.initProb(0, vector<double>(nPred, 0.4));
+  trainBridge.initSplit(3, 6, 0.01, vector<double>(nPred, 0.5));
+  trainBridge.initBooster("l2", "sum", 0.0);
+  trainBridge.initNodeScorer("mean");
+  trainBridge.initTree(0);
+  trainBridge.initGrove(false, nTree, 0);
+  trainBridge.initOmp(nThread);
+  trainBridge.initMono(vector<double>(nPred));
+
+  SamplerBridge samplerBridge(y, y.size(), nTree, samples.data());
+  LeafBridge leafBridge(samplerBridge);
+  seedSession(seed);
+  unique_ptr<GroveBridge> grove = GroveBridge::train(trainBridge, samplerBridge, 0, nTree, leafBridge);
+
+  GroveDump dump;
+  dump.node = vector<complex<double>>(grove->getNodeCount());
+  grove->dumpTree(dump.node.data());
+  dump.score = vector<double>(grove->getNodeCount());
+  grove->dumpScore(dump.score.data());
+  dump.facSplit = vector<unsigned char>(grove->getFactorBytes());
+  grove->dumpFactorRaw(dump.facSplit.data());
+  TrainBridge::deInit();
+
+  return dump;
+}
+
+
+int main() {
+  omp_set_num_threads(4); // Admits concurrency on any host.
+  mt19937 rng(26);
+  const size_t nRow = 400;
+  const unsigned int nTree = 8;
+  const vector<unsigned int> factorTop{0, 0, 3, 0, 0};
+  vector<vector<double>> num(4, vector<double>(nRow));
+  vector<unsigned int> fac(nRow);
+  vector<double> y(nRow);
+  for (size_t row = 0; row < nRow; row++) {
+    for (auto & col : num)
+      col[row] = normal_distribution<double>()(rng);
+    fac[row] = 1 + rng() % 3;
+    y[row] = num[0][row] - 2.0 * num[1][row] * (fac[row] == 2) + normal_distribution<double>(0.0, 0.1)(rng);
+  }
+  RLECresc cresc(nRow, factorTop.size());
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++)
+    cresc.setFactor(predIdx, factorTop[predIdx]);
+  cresc.encodeFrame({num[0].data(), num[1].data(), fac.data(), num[2].data(), num[3].data()});
+
+  // Bags are drawn once and shared by every training.
+  seedSession(1);
+  SamplerBridge bagger(nRow, nRow, nTree, true, nullptr);
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++)
+    bagger.sample();
+  vector<double> samples(bagger.getNuxCount());
+  bagger.dumpNux(samples.data());
+
+  GroveDump sequential = trainBlock(cresc, y, samples, nTree, 1, 26);
+  unsigned int nBad = 0;
+  for (unsigned int nThread : {2, 4}) {
+    nBad += !(trainBlock(cresc, y, samples, nTree, nThread, 26) == sequential);
+  }
+  // A different seed must train a different grove.
+  nBad += trainBlock(cresc, y, samples, nTree, 4, 27) == sequential;
+
+  printf("grove:  %u of 3 trainings disagree\n", nBad);
+  return nBad != 0;
+}
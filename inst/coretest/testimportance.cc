@@ -0,0 +1,101 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testimportance.cc
+
+   @brief Checks incremental permutation tests against those of the
+   full forest, walked node by node over each permuted frame.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "sampler.h"
+#include "rleframe.h"
+#include "predict.h"
+#include "predictbridge.h"
+#include "prng.h"
+#include "sample.h"
+#include "quant.h"
+#include "response.h"
+
+#include <cstdio>
+
+
+/**
+   @brief Defined by the stand-in PRNG.
+ */
+void seedSession(uint64_t seed);
+
+
+int main() {
+  Fixture fixture(42);
+  const size_t nRow = 1000;
+  const double nu = 0.1;
+  const double baseScore = 0.25;
+  const unsigned int nPermute = 2;
+  PredictBridge::initPredict(false, false, nPermute, false);
+  PredictBridge::initQuant({});
+  PredictBridge::initCtgProb(false);
+  PredictBridge::initStage({});
+  PredictBridge::initShap(false);
+  PredictBridge::initOmp(2);
+
+  // The final predictor never splits, so permuting it changes nothing.
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < 30; tIdx++)
+    decTree.push_back(fixture.tree(Fixture::nPredNum - 1, 8));
+  PredictFrame frame = fixture.frame(nRow, false, decTree);
+  vector<double> dense(nRow * Fixture::nPredNum);
+  vector<double> yTest(nRow);
+  for (size_t row = 0; row < nRow; row++) {
+    for (PredictorT predIdx = 0; predIdx < Fixture::nPredNum; predIdx++)
+      dense[predIdx * nRow + row] = frame.baseNum(row)[predIdx];
+    yTest[row] = fixture.unif();
+  }
+
+  vector<DecTree> forestTree(decTree);
+  Forest forest(std::move(forestTree), make_tuple(nu, baseScore, string("sum")), Leaf());
+  Sampler sampler(vector<double>(nRow), vector<vector<SamplerNux>>(decTree.size()), nRow, make_unique<RLEFrame>(nRow, Fixture::nPredNum, dense.data()));
+  seedSession(42);
+  unique_ptr<SummaryReg> summary = sampler.predictReg(&forest, yTest);
+  vector<vector<double>> ssePermuted = summary->getSSEPermuted();
+
+  // Permutations are drawn as by the engine:  a seed per task.
+  seedSession(42);
+  vector<double> taskSeed = PRNG::rUnif(Fixture::nPredNum * nPermute);
+  size_t nBad = 0;
+  for (PredictorT predIdx = 0; predIdx < Fixture::nPredNum; predIdx++) {
+    for (unsigned int rep = 0; rep < nPermute; rep++) {
+      vector<size_t> idxPerm;
+      {
+	PRNG::LocalScope prngScope(taskSeed[predIdx * nPermute + rep]);
+	idxPerm = Sample::permute<size_t>(nRow);
+      }
+      PredictFrame permuted(frame);
+      for (size_t row = 0; row < nRow; row++) {
+	permuted.num[row * Fixture::nPredNum + predIdx] = frame.baseNum(idxPerm[row])[predIdx];
+      }
+      double sse = 0.0;
+      for (size_t row = 0; row < nRow; row++) {
+	double yPred = baseScore;
+	for (const DecTree& tree : decTree) {
+	  yPred += nu * tree.getScore(Fixture::walk(tree, permuted, row));
+	}
+	sse += (yPred - yTest[row]) * (yPred - yTest[row]);
+      }
+      nBad += fabs(ssePermuted[predIdx][rep] - sse) > 1e-9 * sse;
+    }
+  }
+  nBad += ssePermuted[Fixture::nPredNum - 1][0] != summary->getSSE();
+
+  printf("importance:  %zu of %u tests disagree\n", nBad, Fixture::nPredNum * nPermute + 1);
+  return nBad != 0;
+}
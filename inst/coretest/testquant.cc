@@ -0,0 +1,144 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testquant.cc
+
+   @brief Checks quantiles from precomputed leaf histograms against
+   those binned afresh from the samples of each reached leaf.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "sampler.h"
+#include "samplernux.h"
+#include "rleframe.h"
+#include "predict.h"
+#include "predictbridge.h"
+#include "quant.h"
+#include "response.h"
+
+#include <algorithm>
+#include <cstdio>
+
+
+int main() {
+  Fixture fixture(44);
+  const size_t nTrain = 10000;
+  const size_t nRow = 300;
+  const unsigned int nTree = 10;
+  const vector<double> quantile{0.1, 0.25, 0.5, 0.75, 0.9};
+  PredictBridge::initPredict(false, false, 0, false);
+  PredictBridge::initQuant(quantile);
+  PredictBridge::initCtgProb(false);
+  PredictBridge::initStage({});
+  PredictBridge::initShap(false);
+  PredictBridge::initOmp(2);
+
+  // Ties among more distinct responses than bins.
+  vector<double> yTrain(nTrain);
+  for (auto & y : yTrain)
+    y = floor((1.0 + fixture.unif()) * 3000.0) / 6000.0;
+  vector<double> distinct(yTrain);
+  sort(distinct.begin(), distinct.end());
+  distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+  unsigned int rankScale = 0;
+  while ((0x1000u << rankScale) < distinct.size())
+    rankScale++;
+  vector<unsigned int> binOf(nTrain);
+  vector<double> binMean((distinct.size() - 1) / (1 << rankScale) + 1);
+  vector<size_t> binCount(binMean.size());
+  for (size_t obs = 0; obs < nTrain; obs++) {
+    binOf[obs] = (lower_bound(distinct.begin(), distinct.end(), yTrain[obs]) - distinct.begin()) >> rankScale;
+    binMean[binOf[obs]] += yTrain[obs];
+    binCount[binOf[obs]]++;
+  }
+  for (size_t bin = 0; bin < binMean.size(); bin++)
+    binMean[bin] /= binCount[bin];
+
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++)
+    decTree.push_back(fixture.tree(Fixture::nPredNum, 6));
+
+  // Bags rows with small multiplicities, scattering samples over leaves.
+  SamplerNux::setMasks(nTrain);
+  vector<vector<SamplerNux>> samples(nTree);
+  vector<vector<size_t>> sampleObs(nTree);
+  vector<vector<IndexT>> sampleCount(nTree);
+  vector<size_t> treeHeight, leafHeight;
+  vector<IndexT> sampleIdx;
+  vector<vector<vector<IndexT>>> leafSamples(nTree);
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    size_t obsPrev = 0;
+    for (size_t obs = 0; obs < nTrain; obs++) {
+      if (fixture.rng() % 2 == 0) {
+	IndexT sCount = 1 + fixture.rng() % 3;
+	samples[tIdx].emplace_back(obs - obsPrev, sCount);
+	sampleObs[tIdx].push_back(obs);
+	sampleCount[tIdx].push_back(sCount);
+	obsPrev = obs;
+      }
+    }
+    IndexT nLeaf = 0;
+    for (const DecNode& node : decTree[tIdx].getNode())
+      nLeaf += node.isTerminal();
+    leafSamples[tIdx] = vector<vector<IndexT>>(nLeaf);
+    for (IndexT sIdx = 0; sIdx < sampleObs[tIdx].size(); sIdx++)
+      leafSamples[tIdx][fixture.rng() % nLeaf].push_back(sIdx);
+    for (const vector<IndexT>& leaf : leafSamples[tIdx]) {
+      sampleIdx.insert(sampleIdx.end(), leaf.begin(), leaf.end());
+      leafHeight.push_back(sampleIdx.size());
+    }
+    treeHeight.push_back(leafHeight.size());
+  }
+
+  PredictFrame frame = fixture.frame(nRow, false, decTree);
+  vector<double> dense(nRow * Fixture::nPredNum);
+  for (size_t row = 0; row < nRow; row++) {
+    for (PredictorT predIdx = 0; predIdx < Fixture::nPredNum; predIdx++)
+      dense[predIdx * nRow + row] = frame.baseNum(row)[predIdx];
+  }
+  Sampler sampler(yTrain, std::move(samples), nTrain, make_unique<RLEFrame>(nRow, Fixture::nPredNum, dense.data()));
+  vector<DecTree> forestTree(decTree);
+  Forest forest(std::move(forestTree), make_tuple(0.0, 0.0, string("mean")), Leaf(&sampler, treeHeight, leafHeight, sampleIdx));
+  unique_ptr<SummaryReg> summary = sampler.predictReg(&forest, {});
+  const vector<double>& qPred = summary->getQPred();
+  const vector<double>& qEst = summary->getQEst();
+  const vector<double>& yPred = summary->getYPred();
+
+  size_t nBad = 0;
+  for (size_t row = 0; row < nRow; row++) {
+    vector<size_t> sCountBin(binMean.size());
+    size_t totSample = 0;
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      IndexT leafIdx;
+      decTree[tIdx].getLeafIdx(Fixture::walk(decTree[tIdx], frame, row), leafIdx);
+      for (IndexT sIdx : leafSamples[tIdx][leafIdx]) {
+	sCountBin[binOf[sampleObs[tIdx][sIdx]]] += sampleCount[tIdx][sIdx];
+	totSample += sampleCount[tIdx][sIdx];
+      }
+    }
+
+    // Bin means accumulate in rank order, hence the tolerance.
+    size_t seen = 0, left = 0;
+    unsigned int qSlot = 0;
+    for (size_t bin = 0; bin < binMean.size(); bin++) {
+      seen += sCountBin[bin];
+      for (; qSlot < quantile.size() && seen >= totSample * quantile[qSlot]; qSlot++)
+	nBad += fabs(qPred[row * quantile.size() + qSlot] - binMean[bin]) > 1e-12;
+      if (yPred[row] > binMean[bin])
+	left = seen;
+    }
+    nBad += qEst[row] != static_cast<double>(left) / totSample;
+  }
+
+  printf("quantile:  %zu of %zu values disagree\n", nBad, nRow * (quantile.size() + 1));
+  return nBad != 0;
+}
@@ -0,0 +1,49 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testquickscorer.cc
+
+   @brief Checks bitvector traversal against the node-by-node walk.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "quickscorer.h"
+
+#include <cstdio>
+
+
+int main() {
+  Fixture fixture(30);
+  DecNode::initTrap(false);
+  const size_t nRow = 1000;
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < 30; tIdx++)
+    decTree.push_back(fixture.tree(Fixture::nPredNum, 6));
+  PredictFrame frame = fixture.frame(nRow, false, decTree);
+  if (!QuickScorer::eligible(decTree, frame)) {
+    printf("quickscorer:  forest ineligible\n");
+    return 1;
+  }
+
+  QuickScorer qs(decTree, Fixture::nPredNum);
+  vector<uint64_t> leafBits(decTree.size());
+  vector<IndexT> leafIdx(decTree.size());
+  size_t nBad = 0, nCheck = 0;
+  for (size_t row = 0; row < nRow; row++) {
+    qs.walkRow(frame, row, leafBits.data(), leafIdx.data());
+    for (unsigned int tIdx = 0; tIdx < decTree.size(); tIdx++) {
+      nBad += leafIdx[tIdx] != Fixture::walk(decTree[tIdx], frame, row);
+      nCheck++;
+    }
+  }
+
+  printf("quickscorer:  %zu of %zu walks disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
@@ -0,0 +1,75 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testradixsort.cc
+
+   @brief Checks radix-sorted value/row pairs against comparison sorting.
+
+   @author Mark Seligman
+ */
+
+#include "valrank.h"
+#include "radixsort.h"
+#include "fixture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+
+/**
+   @return # positions at which the sorted rows differ.
+ */
+template<typename valType>
+static size_t checkSort(const vector<valType>& val,
+			unsigned int nThread) {
+  vector<ValRank<valType>> expected, sorted;
+  for (size_t row = 0; row < val.size(); row++) {
+    expected.emplace_back(val[row], row);
+    sorted.emplace_back(val[row], row);
+  }
+  sort(expected.begin(), expected.end(), ValRankCompare<valType>);
+  RadixSort::sort(sorted, nThread);
+
+  size_t nBad = 0;
+  for (size_t idx = 0; idx < val.size(); idx++) {
+    nBad += sorted[idx].row != expected[idx].row;
+  }
+  return nBad;
+}
+
+
+int main() {
+  mt19937_64 rng(47);
+  size_t nBad = 0, nCheck = 0;
+  for (size_t nRow : {1000, 5000, 100000}) {
+    // Signed zeroes, infinities, NaNs and ties, among spread values.
+    vector<double> num(nRow);
+    for (auto & val : num) {
+      switch (rng() % 8) {
+      case 0: val = nan(""); break;
+      case 1: val = -0.0; break;
+      case 2: val = 0.0; break;
+      case 3: val = -INFINITY; break;
+      case 4: val = rng() % 10; break;
+      default: val = normal_distribution<double>(0.0, 1.0e3)(rng);
+      }
+    }
+    vector<unsigned int> fac(nRow);
+    for (auto & code : fac) {
+      code = rng() % (nRow < 5000 ? 7 : 100000);
+    }
+    for (unsigned int nThread : {1, 3, 8}) {
+      nBad += checkSort(num, nThread) + checkSort(fac, nThread);
+      nCheck += 2 * nRow;
+    }
+  }
+
+  printf("radix sort:  %zu of %zu rows disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
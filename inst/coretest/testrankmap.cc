@@ -0,0 +1,111 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testrankmap.cc
+
+   @brief Checks narrowed rank maps, and missing-data ranks, against
+   the run-length encoding from which they are expanded, whatever the
+   order of its runs.
+
+   @author Mark Seligman
+ */
+
+#include "rlecresc.h"
+#include "rleframe.h"
+#include "predictorframe.h"
+#include "rankmap.h"
+#include "coproc.h"
+#include "fixture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+
+/**
+   @brief Unpacks an encoding as a front end would.
+
+   @param descending reverses each predictor's runs, leaving equal
+   ranks adjacent.
+ */
+static unique_ptr<RLEFrame> unpack(const RLECresc& cresc,
+				   size_t nRow,
+				   bool descending) {
+  vector<size_t> rleHeight = cresc.getHeight();
+  size_t nRun = rleHeight.back();
+  vector<size_t> runVal(nRun), runLength(nRun), runRow(nRun);
+  cresc.dump(runVal, runLength, runRow);
+  for (size_t predIdx = 0, runStart = 0; descending && predIdx < rleHeight.size(); runStart = rleHeight[predIdx++]) {
+    reverse(runVal.begin() + runStart, runVal.begin() + rleHeight[predIdx]);
+    reverse(runLength.begin() + runStart, runLength.begin() + rleHeight[predIdx]);
+    reverse(runRow.begin() + runStart, runRow.begin() + rleHeight[predIdx]);
+  }
+
+  vector<double> numVal;
+  vector<size_t> numHeight;
+  for (const vector<double>& val : cresc.getValNum()) {
+    numVal.insert(numVal.end(), val.begin(), val.end());
+    numHeight.push_back(numVal.size());
+  }
+  vector<unsigned int> facVal;
+  vector<size_t> facHeight;
+  for (const vector<unsigned int>& val : cresc.getValFac()) {
+    facVal.insert(facVal.end(), val.begin(), val.end());
+    facHeight.push_back(facVal.size());
+  }
+
+  return make_unique<RLEFrame>(nRow, cresc.dumpTopIdx(), runVal, runLength, runRow, rleHeight, numVal, numHeight, facVal, facHeight);
+}
+
+
+int main() {
+  OmpThread::init(4);
+  mt19937 rng(50);
+  const size_t nRow = 100000;
+  const vector<unsigned int> factorTop{0, 0, 0, 3};
+  const vector<unsigned int> widthExpected{1, 2, 4, 1};
+  vector<vector<double>> num(3, vector<double>(nRow));
+  vector<unsigned int> fac(nRow);
+  for (size_t row = 0; row < nRow; row++) {
+    num[0][row] = rng() % 0x100;
+    num[1][row] = row % 97 == 0 ? nan("") : rng() % 300;
+    num[2][row] = rng();
+    fac[row] = 1 + rng() % 3;
+  }
+  RLECresc cresc(nRow, factorTop.size());
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++)
+    cresc.setFactor(predIdx, factorTop[predIdx]);
+  cresc.encodeFrame({num[0].data(), num[1].data(), num[2].data(), fac.data()});
+
+  // Missing data rank last, beyond the values.
+  const vector<IndexT> missingExpected{0, 300, 0, 0};
+  size_t nBad = 0, nCheck = 0;
+  for (bool descending : {false, true}) {
+    vector<string> diag;
+    PredictorFrame frame(unpack(cresc, nRow, descending), 0.25, false, diag);
+    for (PredictorT predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+      const RankMap& rankMap = frame.getRanks(predIdx);
+      nBad += rankMap.getWidth() != widthExpected[predIdx];
+      nBad += frame.getMissingRank(predIdx) != (missingExpected[predIdx] == 0 ? frame.getNoRank() : missingExpected[predIdx]);
+      vector<IndexT> scanned(nRow);
+      rankMap.visit([&](const auto* rank) {
+	for (size_t row = 0; row < nRow; row++)
+	  scanned[row] = rank[row];
+      });
+      for (const RLEVal<szType>& rle : frame.getRLE(predIdx)) {
+	for (size_t row = rle.row; row < rle.row + rle.extent; row++) {
+	  nBad += rankMap[row] != rle.val || scanned[row] != rle.val;
+	  nCheck++;
+	}
+      }
+    }
+  }
+
+  printf("rank map:  %zu of %zu ranks disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
@@ -0,0 +1,108 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testrowscorer.cc
+
+   @brief Checks single-row scores, under each scorer, against those
+   accumulated from the node-by-node walk.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "rowscorer.h"
+
+#include <cstdio>
+
+
+/**
+   @brief Reference score of a row, as the prediction scorers compute it.
+ */
+static double expected(const vector<DecTree>& decTree,
+		       const PredictFrame& frame,
+		       size_t row,
+		       const string& scorer,
+		       double nu,
+		       double baseScore,
+		       CtgT nCtg) {
+  if (scorer == "plurality") {
+    vector<double> census(nCtg);
+    for (const DecTree& tree : decTree) {
+      double score = tree.getScore(Fixture::walk(tree, frame, row));
+      CtgT ctg = floor(score);
+      census[ctg] += 1.0 + (score - ctg) / (2 * decTree.size());
+    }
+    CtgT argMax = 0;
+    for (CtgT ctg = 1; ctg < nCtg; ctg++) {
+      if (census[ctg] > census[argMax])
+	argMax = ctg;
+    }
+    return argMax;
+  }
+
+  double sum = scorer == "mean" ? 0.0 : baseScore;
+  for (const DecTree& tree : decTree) {
+    double score = tree.getScore(Fixture::walk(tree, frame, row));
+    sum += scorer == "mean" ? score : nu * score;
+  }
+  if (scorer == "mean")
+    return sum / decTree.size();
+  else if (scorer == "logistic")
+    return 1.0 / (1.0 + exp(-sum));
+  else
+    return sum;
+}
+
+
+int main() {
+  Fixture fixture(37);
+  DecNode::initTrap(false);
+  const size_t nRow = 500;
+  const CtgT nCtg = 3;
+  const double nu = 0.1;
+  const double baseScore = 0.25;
+  size_t nBad = 0, nCheck = 0;
+  // Numeric forests shallow enough for bitvector walks; mixed forests flat.
+  for (bool withFac : {false, true}) {
+    for (string scorer : {"mean", "sum", "logistic", "plurality"}) {
+      vector<DecTree> decTree;
+      for (unsigned int tIdx = 0; tIdx < 25; tIdx++) {
+	DecTree tree = fixture.tree(withFac ? Fixture::nPredNum + Fixture::nPredFac : Fixture::nPredNum, withFac ? 8 : 6);
+	if (scorer != "plurality") {
+	  decTree.push_back(tree);
+	  continue;
+	}
+	// Plurality scores are jittered categories.
+	vector<double> score(tree.nodeCount());
+	for (auto & sc : score)
+	  sc = fixture.rng() % nCtg + 0.5 * (1.0 + fixture.unif()) * 0.99;
+	decTree.emplace_back(tree.getNode(), tree.getFacSplit(), tree.getFacObserved(), score);
+      }
+      PredictFrame frame = fixture.frame(nRow, withFac, decTree);
+
+      vector<DecTree> forestTree(decTree);
+      Forest forest(std::move(forestTree), make_tuple(nu, baseScore, scorer), Leaf());
+      forest.initWalkers(PredictFrame(Fixture::nPredNum, withFac ? Fixture::nPredFac : 0));
+      if ((forest.getQuickScorer() == nullptr) != withFac) {
+	printf("row scorer:  unexpected walker\n");
+	return 1;
+      }
+      RowScorer rowScorer(&forest, scorer == "plurality" ? nCtg : 0);
+      for (size_t row = 0; row < nRow; row++) {
+	double score = rowScorer.score(frame.baseNum(row), frame.baseFac(row));
+	nBad += fabs(score - expected(decTree, frame, row, scorer, nu, baseScore, nCtg)) > 1e-12;
+	nCheck++;
+      }
+    }
+  }
+
+  printf("row scorer:  %zu of %zu rows disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
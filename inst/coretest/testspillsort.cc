@@ -0,0 +1,115 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testspillsort.cc
+
+   @brief Checks frames presorted from a column file, within varying
+   memory budgets, against those presorted in memory, and that
+   malformed files are rejected.
+
+   @author Mark Seligman
+ */
+
+#include "rlecresc.h"
+#include "columnfile.h"
+#include "fixture.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+
+/**
+   @return true iff the numeric values agree bitwise, as to sign and NaN.
+ */
+static bool sameNum(const vector<vector<double>>& a,
+		    const vector<vector<double>>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t predIdx = 0; predIdx < a.size(); predIdx++) {
+    if (a[predIdx].size() != b[predIdx].size())
+      return false;
+    for (size_t idx = 0; idx < a[predIdx].size(); idx++) {
+      double x = a[predIdx][idx];
+      double y = b[predIdx][idx];
+      if (!(x == y || (isnan(x) && isnan(y))) || signbit(x) != signbit(y))
+	return false;
+    }
+  }
+  return true;
+}
+
+
+int main() {
+  OmpThread::init(4);
+  mt19937 rng(48);
+  const size_t nRow = 100003;
+  const vector<unsigned int> factorTop{0, 5, 0, 0, 2};
+  vector<vector<double>> num(3, vector<double>(nRow));
+  vector<vector<unsigned int>> fac(2, vector<unsigned int>(nRow));
+  uniform_int_distribution<int> draw(0, 50);
+  for (size_t row = 0; row < nRow; row++) {
+    int x = draw(rng);
+    num[0][row] = x == 0 ? nan("") : x == 1 ? -0.0 : x == 2 ? 0.0 : (x - 25) * 0.5;
+    num[1][row] = normal_distribution<double>()(rng);
+    num[2][row] = (row / 1000) % 7; // Long runs.
+    fac[0][row] = 1 + draw(rng) % 5;
+    fac[1][row] = row < nRow / 2 ? 1 : 2;
+  }
+  vector<void*> colBase{num[0].data(), fac[0].data(), num[1].data(), num[2].data(), fac[1].data()};
+  const vector<string> colNames{"n0", "f0", "n1", "n2", "f1"};
+  const vector<vector<string>> levels{{}, {"a", "b", "c", "dd", ""}, {}, {}, {"no", "yes"}};
+  ColumnFile::write("spill.col", nRow, factorTop, colNames, levels, vector<const void*>(colBase.begin(), colBase.end()));
+
+  RLECresc inMemory(nRow, factorTop.size());
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++)
+    inMemory.setFactor(predIdx, factorTop[predIdx]);
+  inMemory.encodeFrame(colBase);
+  vector<size_t> height = inMemory.getHeight();
+  size_t nRun = height.back();
+  vector<size_t> val(nRun), length(nRun), runRow(nRun);
+  inMemory.dump(val, length, runRow);
+
+  // Budgets below the minimum take it, spilling several runs per column.
+  size_t nBad = 0, nCheck = 0;
+  for (size_t budget : {size_t(0), size_t(1) << 20, size_t(1) << 30}) {
+    ColumnFile colFile("spill.col");
+    nBad += colFile.getColNames() != colNames || colFile.getLevels() != levels;
+    RLECresc spilled(colFile.getNRow(), colFile.getNPred());
+    spilled.encodeFile(colFile, budget);
+    nCheck++;
+    if (spilled.getHeight() != height) {
+      nBad++;
+      continue;
+    }
+    vector<size_t> valS(nRun), lengthS(nRun), runRowS(nRun);
+    spilled.dump(valS, lengthS, runRowS);
+    nBad += valS != val || lengthS != length || runRowS != runRow;
+    nBad += spilled.getValFac() != inMemory.getValFac();
+    nBad += !sameNum(spilled.getValNum(), inMemory.getValNum());
+  }
+
+  // A predictor count overrunning the file is rejected before allocation.
+  {
+    fstream file("spill.col", ios::binary | ios::in | ios::out);
+    const uint32_t nPred = 0xffffffff;
+    file.seekp(offsetof(ColumnFile::Header, nPred));
+    file.write(reinterpret_cast<const char*>(&nPred), sizeof(nPred));
+  }
+  try {
+    ColumnFile colFile("spill.col");
+    nBad++;
+  }
+  catch (const runtime_error&) {
+  }
+  nCheck++;
+  remove("spill.col");
+
+  printf("spill sort:  %zu of %zu frames disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
@@ -0,0 +1,81 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file teststage.cc
+
+   @brief Checks scores staged at tree-count checkpoints against those
+   of truncated forests, walked node by node.
+
+   @author Mark Seligman
+ */
+
+#include "fixture.h"
+#include "forest.h"
+#include "leaf.h"
+#include "sampler.h"
+#include "rleframe.h"
+#include "predict.h"
+#include "predictbridge.h"
+#include "quant.h"
+#include "response.h"
+
+#include <cstdio>
+
+
+int main() {
+  Fixture fixture(41);
+  const size_t nRow = 1500;
+  const double nu = 0.1;
+  const double baseScore = 0.25;
+  const vector<unsigned int> stage{1, 5, 17, 40};
+  PredictBridge::initPredict(false, false, 0, false);
+  PredictBridge::initQuant({});
+  PredictBridge::initCtgProb(false);
+  PredictBridge::initStage(stage);
+  PredictBridge::initShap(false);
+  PredictBridge::initOmp(2);
+
+  size_t nBad = 0, nCheck = 0;
+  // Deep trees exceed the node count at which blocks walk tree-major.
+  for (unsigned int maxDepth : {6, 13}) {
+    vector<DecTree> decTree;
+    for (unsigned int tIdx = 0; tIdx < 40; tIdx++)
+      decTree.push_back(fixture.tree(Fixture::nPredNum, maxDepth, maxDepth > 6));
+    PredictFrame frame = fixture.frame(nRow, false, decTree);
+    vector<double> dense(nRow * Fixture::nPredNum);
+    for (size_t row = 0; row < nRow; row++) {
+      for (PredictorT predIdx = 0; predIdx < Fixture::nPredNum; predIdx++)
+	dense[predIdx * nRow + row] = frame.baseNum(row)[predIdx];
+    }
+
+    vector<DecTree> forestTree(decTree);
+    Forest forest(std::move(forestTree), make_tuple(nu, baseScore, string("sum")), Leaf());
+    Sampler sampler(vector<double>(nRow), vector<vector<SamplerNux>>(decTree.size()), nRow, make_unique<RLEFrame>(nRow, Fixture::nPredNum, dense.data()));
+    unique_ptr<SummaryReg> summary = sampler.predictReg(&forest, {});
+
+    const vector<double>& staged = summary->getStaged();
+    const vector<double>& yPred = summary->getYPred();
+    for (size_t row = 0; row < nRow; row++) {
+      double expected = baseScore;
+      unsigned int stageIdx = 0;
+      for (unsigned int tIdx = 0; tIdx < decTree.size(); tIdx++) {
+	expected += nu * decTree[tIdx].getScore(Fixture::walk(decTree[tIdx], frame, row));
+	if (stageIdx < stage.size() && stage[stageIdx] == tIdx + 1) {
+	  nBad += fabs(staged[row * stage.size() + stageIdx] - expected) > 1e-12;
+	  nCheck++;
+	  stageIdx++;
+	}
+      }
+      nBad += fabs(yPred[row] - expected) > 1e-12;
+      nCheck++;
+    }
+  }
+
+  printf("stage:  %zu of %zu scores disagree\n", nBad, nCheck);
+  return nBad != 0;
+}
@@ -0,0 +1,83 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file testtreeshap.cc
+
+   @brief Checks that contributions and bias sum to the walked score,
+   and that predictors absent from the forest contribute nothing.
+
+   Rows are explained concurrently, each thread with its own scratch.
+
+   @author Mark Seligman
+ */
+
+#include "treeshap.h"
+#include "forest.h"
+#include "leaf.h"
+#include "sampler.h"
+#include "rleframe.h"
+#include "scoredesc.h"
+#include "fixture.h"
+
+#include <omp.h>
+#include <cstdio>
+
+
+int main() {
+  Fixture fixture(43);
+  DecNode::initTrap(false);
+  const size_t nRow = 200;
+  const double nu = 0.1;
+  const double baseScore = 0.5;
+
+  // The final numeric predictor never splits.
+  const PredictorT nPredSplit = Fixture::nPredNum - 1;
+  vector<DecTree> decTree;
+  for (unsigned int tIdx = 0; tIdx < 12; tIdx++)
+    decTree.push_back(fixture.tree(nPredSplit, tIdx % 2 == 0 ? 7 : 4));
+  PredictFrame frame = fixture.frame(nRow, false, decTree);
+
+  // Leaves hold arbitrary sample counts, each sample of unit weight.
+  Sampler sampler(nRow, nRow, vector<vector<SamplerNux>>());
+  vector<size_t> treeHeight, leafHeight;
+  vector<IndexT> sampleIdx;
+  for (const DecTree& tree : decTree) {
+    for (const DecNode& node : tree.getNode()) {
+      if (node.isTerminal()) {
+	sampleIdx.insert(sampleIdx.end(), 1 + fixture.rng() % 5, 0);
+	leafHeight.push_back(sampleIdx.size());
+      }
+    }
+    treeHeight.push_back(leafHeight.size());
+  }
+  vector<DecTree> forestTree(decTree);
+  ScoreDesc scoreDesc(make_tuple(nu, baseScore, string("sum")));
+  Forest forest(std::move(forestTree), scoreDesc.getTuple(), Leaf(&sampler, treeHeight, leafHeight, sampleIdx));
+
+  vector<double> dense(nRow * Fixture::nPredNum);
+  RLEFrame rleFrame(nRow, Fixture::nPredNum, dense.data());
+  TreeShap treeShap(&forest, &sampler, &rleFrame, &scoreDesc);
+
+  size_t nBad = 0;
+#pragma omp parallel for reduction(+:nBad) schedule(dynamic, 1) num_threads(4)
+  for (size_t row = 0; row < nRow; row++) {
+    vector<double> phi(Fixture::nPredNum + 1);
+    treeShap.explainRow(frame.baseNum(row), frame.baseFac(row), phi.data());
+    double expected = baseScore;
+    for (const DecTree& tree : decTree) {
+      expected += nu * tree.getScore(Fixture::walk(tree, frame, row));
+    }
+    double total = 0.0;
+    for (double contrib : phi)
+      total += contrib;
+    nBad += fabs(total - expected) > 1.0e-9 || phi[nPredSplit] != 0.0;
+  }
+
+  printf("treeshap:  %zu of %zu rows disagree\n", nBad, nRow);
+  return nBad != 0;
+}
@@ -0,0 +1,186 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file sgbpredict.cc
+
+   @brief Implements the C interface to the standalone prediction library.
+
+   @author Mark Seligman
+ */
+
+#include "sgbpredict.h"
+
+#include "forestfile.h"
+#include "rowscorer.h"
+#include "ompthread.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/**
+   @brief Read-only, private mapping of a file, unmapped on destruction.
+ */
+class Mapping {
+  void* base;
+  size_t length;
+
+public:
+  Mapping(const char* path) :
+    base(MAP_FAILED),
+    length(0) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      throw runtime_error(string("Cannot open forest file ") + path);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      length = st.st_size;
+      base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED)
+      throw runtime_error(string("Cannot map forest file ") + path);
+  }
+
+
+  ~Mapping() {
+    munmap(base, length);
+  }
+
+
+  const void* getBase() const {
+    return base;
+  }
+
+
+  size_t getLength() const {
+    return length;
+  }
+};
+
+
+/**
+   @brief Opaque handle:  a mapped forest image, viewed in place.
+ */
+struct sgb_model {
+  const Mapping mapping;
+  const ForestFile forestFile;
+
+  sgb_model(const char* path) :
+    mapping(path),
+    forestFile(mapping.getBase(), mapping.getLength()) {
+  }
+};
+
+
+static thread_local string lastError;
+
+
+sgb_model* sgb_model_load(const char* path) {
+  try {
+    return new sgb_model(path);
+  }
+  catch (const exception& e) {
+    lastError = e.what();
+    return nullptr;
+  }
+}
+
+
+void sgb_model_free(sgb_model* model) {
+  delete model;
+}
+
+
+unsigned int sgb_model_n_pred_num(const sgb_model* model) {
+  return model->forestFile.getNPredNum();
+}
+
+
+unsigned int sgb_model_n_pred_fac(const sgb_model* model) {
+  return model->forestFile.getNPredFac();
+}
+
+
+unsigned int sgb_model_n_tree(const sgb_model* model) {
+  return model->forestFile.getFlatForest()->getNTree();
+}
+
+
+int sgb_model_predict(const sgb_model* model,
+		      const double* num,
+		      const unsigned int* fac,
+		      size_t nRow,
+		      unsigned int nThread,
+		      double** out) {
+  try {
+    const ForestFile& file = model->forestFile;
+    PredictorT nPredNum = file.getNPredNum();
+    PredictorT nPredFac = file.getNPredFac();
+    if ((nPredNum > 0 && num == nullptr) || (nPredFac > 0 && fac == nullptr))
+      throw invalid_argument("Missing predictor values");
+
+    // Each thread scores a contiguous span of rows with private scratch.
+    unsigned int nSpan = nThread > 0 ? nThread : max(thread::hardware_concurrency(), 1u);
+    nSpan = static_cast<unsigned int>(max<size_t>(min<size_t>(nSpan, nRow), 1));
+    vector<unique_ptr<RowScorer>> scorer;
+    for (unsigned int span = 0; span < nSpan; span++) {
+      scorer.push_back(make_unique<RowScorer>(file.getFlatForest(), file.getScoreDesc(), file.getNCtg()));
+    }
+
+    // Levels beyond the training cardinality map to the proxy, which
+    // no split observed.
+    vector<PredictorT> facCard = file.getFacCard();
+    vector<vector<CtgT>> facRow(nSpan, vector<CtgT>(nPredFac));
+
+    double* score = static_cast<double*>(malloc(max<size_t>(nRow, 1) * sizeof(double)));
+    if (score == nullptr)
+      throw bad_alloc();
+
+    size_t spanRows = (nRow + nSpan - 1) / nSpan;
+#pragma omp parallel default(shared) num_threads(nSpan)
+    {
+#pragma omp for schedule(dynamic, 1)
+      for (OMPBound span = 0; span < nSpan; span++) {
+	size_t rowEnd = min(nRow, (span + 1) * spanRows);
+	for (size_t row = span * spanRows; row < rowEnd; row++) {
+	  const unsigned int* rowFac = fac + row * nPredFac;
+	  for (PredictorT facIdx = 0; facIdx < nPredFac; facIdx++) {
+	    facRow[span][facIdx] = min(rowFac[facIdx], facCard[facIdx]);
+	  }
+	  score[row] = scorer[span]->score(num + row * nPredNum, facRow[span].data());
+	}
+      }
+    }
+
+    *out = score;
+    return 0;
+  }
+  catch (const exception& e) {
+    lastError = e.what();
+    return 1;
+  }
+}
+
+
+void sgb_result_free(double* result) {
+  free(result);
+}
+
+
+const char* sgb_last_error(void) {
+  return lastError.c_str();
+}
@@ -0,0 +1,102 @@
+/* This file is part of ArboristCore.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file sgbpredict.h
+
+   @brief C interface to the standalone prediction library.
+
+   Models are written from R by exportModel().  Rows are laid out
+   contiguously, with numeric and factor predictors in the column order
+   reported by exportModel() and factor levels zero-based.
+
+   Functions returning int yield zero on success.  On failure, a
+   description of the most recent error on the calling thread is
+   available from sgb_last_error().
+
+   A model file is mapped read-only and walked in place, so processes
+   loading the same file share a single copy through the page cache.
+   A loaded model is immutable, so that concurrent calls to
+   sgb_model_predict() on the same model are safe.
+
+   @author Mark Seligman
+ */
+
+#ifndef SGBPREDICT_H
+#define SGBPREDICT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sgb_model sgb_model;
+
+
+/**
+   @brief Maps a model file.
+
+   @return new model, or NULL on failure.
+ */
+sgb_model* sgb_model_load(const char* path);
+
+
+/**
+   @brief Unmaps a model returned by sgb_model_load().
+ */
+void sgb_model_free(sgb_model* model);
+
+
+unsigned int sgb_model_n_pred_num(const sgb_model* model);
+
+
+unsigned int sgb_model_n_pred_fac(const sgb_model* model);
+
+
+unsigned int sgb_model_n_tree(const sgb_model* model);
+
+
+/**
+   @brief Scores a batch of rows.
+
+   @param num holds nRow rows of numeric values; may be NULL if none.
+
+   @param fac holds nRow rows of factor levels; may be NULL if none.
+   Levels at or beyond a factor's training cardinality are treated as
+   unobserved.
+
+   @param nThread is the number of threads requested; zero for default.
+
+   @param[out] out outputs nRow scores, to be released by sgb_result_free():
+   regression values, category-one probabilities under logistic scoring,
+   or zero-based categories under plurality scoring.
+ */
+int sgb_model_predict(const sgb_model* model,
+		      const double* num,
+		      const unsigned int* fac,
+		      size_t nRow,
+		      unsigned int nThread,
+		      double** out);
+
+
+/**
+   @brief Releases scores output by sgb_model_predict().
+ */
+void sgb_result_free(double* result);
+
+
+/**
+   @return description of the calling thread's most recent failure.
+ */
+const char* sgb_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
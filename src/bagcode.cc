@@ -0,0 +1,73 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file bagcode.cc
+
+   @brief Encoding and decoding of compressed bags.
+
+   @author Mark Seligman
+ */
+
+#include "bagcode.h"
+#include "sampler.h"
+#include "bv.h"
+#include "ompthread.h"
+
+
+BagCode::BagCode(const Sampler* sampler,
+		 bool bagging) :
+  nTree(bagging ? sampler->getNRep() : 0),
+  nObs(sampler->getNObs()),
+  treeOffset(vector<size_t>(1)) {
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    const vector<SamplerNux>& samples = sampler->getSamples(tIdx);
+    IndexT bagCount = samples.empty() ? nObs : samples.size();
+    for (IndexT sIdx = 0; sIdx != bagCount; sIdx++) {
+      // Trivial sampling bags every row.
+      appendDelta(samples.empty() ? (sIdx == 0 ? 0 : 1) : samples[sIdx].getDelRow());
+    }
+    treeOffset.push_back(code.size());
+  }
+  code.shrink_to_fit();
+}
+
+
+void BagCode::appendDelta(IndexT delRow) {
+  while (delRow >= 0x80) {
+    code.push_back(static_cast<unsigned char>(delRow & 0x7f) | 0x80);
+    delRow >>= 7;
+  }
+  code.push_back(static_cast<unsigned char>(delRow));
+}
+
+
+BagCursor BagCode::begin(unsigned int tIdx) const {
+  BagCursor cursor{treeOffset[tIdx], 0};
+  advance(tIdx, cursor);
+  return cursor;
+}
+
+
+void BagCode::decodeBlock(vector<BagCursor>& cursor,
+			  size_t rowStart,
+			  size_t span,
+			  BitMatrix* window) const {
+  window->clear();
+  size_t rowEnd = rowStart + span;
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+#pragma omp for schedule(dynamic, 1)
+    for (OMPBound tIdx = 0; tIdx < nTree; tIdx++) {
+      BagCursor& tc = cursor[tIdx];
+      while (tc.row < rowEnd) {
+	window->setBit(tIdx, tc.row - rowStart);
+	advance(tIdx, tc);
+      }
+    }
+  }
+}
@@ -0,0 +1,122 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file bagcode.h
+
+   @brief Compressed per-tree encoding of bagged rows.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_BAGCODE_H
+#define FOREST_BAGCODE_H
+
+#include "typeparam.h"
+
+#include <vector>
+
+
+/**
+   @brief Position within a tree's encoding.
+ */
+struct BagCursor {
+  size_t offset; ///< Byte offset of the next delta.
+  IndexT row; ///< Current bagged row; nObs iff exhausted.
+};
+
+
+/**
+   @brief Bagged rows, per tree, as varint-coded row deltas.
+
+   Row deltas are those of the SamplerNux packing, which are typically
+   small enough to fit a single byte.  Streams are decoded sequentially,
+   a block of rows at a time.
+ */
+class BagCode {
+  const unsigned int nTree;
+  const IndexT nObs;
+  vector<unsigned char> code; ///< Concatenated per-tree delta streams.
+  vector<size_t> treeOffset; ///< Per-tree stream starts, plus terminal.
+
+
+  /**
+     @brief Appends a delta in varint form.
+   */
+  void appendDelta(IndexT delRow);
+
+
+  /**
+     @brief Reads the varint at the cursor and advances the cursor.
+   */
+  inline void advance(unsigned int tIdx,
+		      BagCursor& cursor) const {
+    if (cursor.offset == treeOffset[tIdx + 1]) {
+      cursor.row = nObs;
+      return;
+    }
+    IndexT delRow = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do {
+      byte = code[cursor.offset++];
+      delRow |= static_cast<IndexT>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    cursor.row += delRow;
+  }
+
+public:
+
+  /**
+     @brief Encodes the sampler's bag, if requested.
+
+     @param bagging is true iff bagged rows are to be encoded.
+   */
+  BagCode(const class Sampler* sampler,
+	  bool bagging);
+
+
+  /**
+     @return true iff no bag has been encoded.
+   */
+  bool isEmpty() const {
+    return nTree == 0;
+  }
+
+
+  /**
+     @return size of the encoding, in bytes.
+   */
+  size_t getBytes() const {
+    return code.size();
+  }
+
+
+  /**
+     @return cursor positioned at the tree's first bagged row.
+   */
+  BagCursor begin(unsigned int tIdx) const;
+
+
+  /**
+     @brief Decodes bagged rows within a block of observations into a
+     tree-by-row window, advancing the per-tree cursors.
+
+     Blocks must be presented in increasing row order.
+
+     @param[in, out] cursor holds the per-tree decoding state.
+
+     @param[out] window is cleared and set at bagged positions.
+   */
+  void decodeBlock(vector<BagCursor>& cursor,
+		   size_t rowStart,
+		   size_t span,
+		   class BitMatrix* window) const;
+};
+
+#endif
@@ -0,0 +1,130 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file binnedforest.cc
+
+   @brief Builds the quantized forest and bins rows against it.
+
+   @author Mark Seligman
+ */
+
+#include "binnedforest.h"
+#include "dectree.h"
+#include "predictframe.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+vector<vector<double>> BinnedForest::collectCuts(const vector<DecTree>& decTree,
+						 PredictorT nPredNum) {
+  vector<vector<double>> cuts(nPredNum);
+  for (const DecTree& tree : decTree) {
+    for (const DecNode& node : tree.getNode()) {
+      if (!node.isTerminal()) {
+	cuts[node.getPredIdx()].push_back(node.getSplitNum());
+      }
+    }
+  }
+  for (vector<double>& predCuts : cuts) {
+    sort(predCuts.begin(), predCuts.end());
+    predCuts.erase(unique(predCuts.begin(), predCuts.end()), predCuts.end());
+  }
+
+  return cuts;
+}
+
+
+bool BinnedForest::eligible(const vector<DecTree>& decTree,
+			    const PredictFrame& frame) {
+  if (frame.getNPredFac() != 0 || frame.getNPredNum() > predMask)
+    return false;
+  if (decTree.size() < treesPerPred * static_cast<size_t>(frame.getNPredNum()))
+    return false;
+
+  for (const vector<double>& predCuts : collectCuts(decTree, frame.getNPredNum())) {
+    if (predCuts.size() >= binNaN)
+      return false;
+  }
+  return true;
+}
+
+
+BinnedForest::BinnedForest(const vector<DecTree>& decTree,
+			   PredictorT nPredNum_) :
+  trapUnobserved(DecNode::trapAndBail()),
+  nPredNum(nPredNum_),
+  cutOffset(vector<size_t>(1)),
+  treeOffset(vector<size_t>(1)) {
+  for (const vector<double>& predCuts : collectCuts(decTree, nPredNum)) {
+    cutVal.insert(cutVal.end(), predCuts.begin(), predCuts.end());
+    cutOffset.push_back(cutVal.size());
+  }
+
+  for (const DecTree& tree : decTree) {
+    appendTree(tree);
+    treeOffset.push_back(binNode.size());
+  }
+}
+
+
+void BinnedForest::appendTree(const DecTree& tree) {
+  const vector<DecNode>& decNode = tree.getNode();
+
+  // Preorder:  true branch visited, and hence placed, first.
+  vector<IndexT> nodeStack;
+  vector<size_t> binParent; // Position awaiting false offset.
+  nodeStack.push_back(0);
+  binParent.push_back(0);
+  while (!nodeStack.empty()) {
+    IndexT idx = nodeStack.back();
+    size_t parent = binParent.back();
+    nodeStack.pop_back();
+    binParent.pop_back();
+
+    size_t binIdx = binNode.size();
+    if (parent != 0) { // Only false branches are deferred.
+      binNode[parent - 1].delFalse = binIdx - (parent - 1);
+    }
+
+    const DecNode& node = decNode[idx];
+    nodeIdx.push_back(idx);
+    if (node.isTerminal()) {
+      binNode.push_back(BinNode{0, 0, 0});
+      continue;
+    }
+
+    PredictorT predIdx = node.getPredIdx();
+    auto cutBegin = cutVal.begin() + cutOffset[predIdx];
+    BinT cut = lower_bound(cutBegin, cutVal.begin() + cutOffset[predIdx + 1], node.getSplitNum()) - cutBegin;
+    // NaN fails both the <= test and its inverted counterpart.
+    uint16_t predFlagged = predIdx | (node.delInvert(false) == node.getDelIdx() ? nanTrueBit : 0);
+    binNode.push_back(BinNode{predFlagged, cut, 1}); // Placeholder:  nonzero.
+
+    IndexT idxTrue = idx + node.getDelIdx();
+    nodeStack.push_back(idxTrue + 1);
+    binParent.push_back(binIdx + 1);
+    nodeStack.push_back(idxTrue);
+    binParent.push_back(0);
+  }
+}
+
+
+void BinnedForest::binRow(const double rowNum[],
+			  BinT rowBin[]) const {
+  for (PredictorT predIdx = 0; predIdx < nPredNum; predIdx++) {
+    double numVal = rowNum[predIdx];
+    if (std::isnan(numVal)) {
+      rowBin[predIdx] = binNaN;
+    }
+    else {
+      auto cutBegin = cutVal.begin() + cutOffset[predIdx];
+      rowBin[predIdx] = lower_bound(cutBegin, cutVal.begin() + cutOffset[predIdx + 1], numVal) - cutBegin;
+    }
+  }
+}
@@ -0,0 +1,137 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file binnedforest.h
+
+   @brief Quantized forest layout, walked over pre-binned rows.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_BINNEDFOREST_H
+#define FOREST_BINNEDFOREST_H
+
+#include "typeparam.h"
+
+#include <vector>
+#include <cstdint>
+
+
+/**
+   @brief Numeric forest with thresholds replaced by their rank among
+   the distinct cuts of the splitting predictor.
+
+   Rows are binned once, per predictor, by the number of cuts lying
+   strictly below the value.  A value then lies at or below a cut
+   precisely when its bin does not exceed the cut's rank, so traversal
+   reduces to small-integer compares without loss of exactness.
+ */
+class BinnedForest {
+public:
+  typedef uint16_t BinT; ///< Bin and cut-rank width.
+
+private:
+  static constexpr BinT binNaN = 0xffff; ///< Bin of missing values.
+  static constexpr uint16_t nanTrueBit = 0x8000; ///< NaN takes true branch.
+  static constexpr uint16_t predMask = nanTrueBit - 1; ///< Predictor index.
+  static constexpr unsigned int treesPerPred = 2; ///< Walks amortizing a predictor's binning.
+
+  /**
+     @brief Compact node:  terminal iff delFalse is zero.
+   */
+  struct BinNode {
+    uint16_t predIdx; ///< Splitting predictor, with missing-data sense.
+    BinT cut; ///< Rank of threshold among predictor's cuts.
+    IndexT delFalse; ///< Offset to false branch.
+  };
+
+  const bool trapUnobserved; ///< Caches the training-time setting.
+  const PredictorT nPredNum; ///< Row stride of the binned block.
+  vector<size_t> cutOffset; ///< Per-predictor cut start, plus terminal.
+  vector<double> cutVal; ///< Distinct thresholds, ascending by predictor.
+  vector<size_t> treeOffset; ///< Per-tree starting node, plus terminal.
+  vector<BinNode> binNode; ///< Nodes of every tree, depth-first.
+  vector<IndexT> nodeIdx; ///< Originating index within tree.
+
+
+  /**
+     @brief Collects the distinct thresholds of each predictor.
+
+     @return per-predictor ascending cuts.
+   */
+  static vector<vector<double>> collectCuts(const vector<class DecTree>& decTree,
+					    PredictorT nPredNum);
+
+
+  /**
+     @brief Appends the nodes of a tree in depth-first order.
+   */
+  void appendTree(const class DecTree& tree);
+
+public:
+
+  /**
+     @brief Determines whether the forest can be quantized profitably.
+
+     Binning a row costs a binary search per predictor, recouped only
+     over enough trees.  Smaller forests are left to the flat walks.
+
+     @return true iff frame is numeric, the forest has at least
+     treesPerPred trees per predictor and every predictor's cuts are
+     representable in BinT.
+   */
+  static bool eligible(const vector<class DecTree>& decTree,
+		       const class PredictFrame& frame);
+
+
+  BinnedForest(const vector<class DecTree>& decTree,
+	       PredictorT nPredNum_);
+
+
+  /**
+     @brief Bins the numeric values of a single row.
+
+     @param[out] rowBin outputs the per-predictor bins.
+   */
+  void binRow(const double rowNum[],
+	      BinT rowBin[]) const;
+
+
+  /**
+     @brief Walks a binned row through a tree.
+
+     @return tree-relative index of the final node, typically terminal.
+   */
+  inline IndexT walkBinned(const BinT rowBin[],
+			   unsigned int tIdx) const {
+    size_t idx = treeOffset[tIdx];
+    while (binNode[idx].delFalse != 0) {
+      const BinNode& node = binNode[idx];
+      BinT bin = rowBin[node.predIdx & predMask];
+      bool sense;
+      if (bin == binNaN) {
+	if (trapUnobserved)
+	  break;
+	sense = (node.predIdx & nanTrueBit) != 0;
+      }
+      else {
+	sense = bin <= node.cut;
+      }
+      idx += sense ? 1 : node.delFalse;
+    }
+
+    return nodeIdx[idx];
+  }
+
+
+  PredictorT getNPredNum() const {
+    return nPredNum;
+  }
+};
+
+#endif
@@ -0,0 +1,198 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file codegen.cc
+
+   @brief Emits C++ source for a trained forest.
+
+   @author Mark Seligman
+ */
+
+#include "codegen.h"
+#include "forest.h"
+
+#include <cmath>
+
+
+CodeGen::CodeGen(const Forest* forest_,
+		 PredictorT nPredNum_,
+		 const vector<PredictorT>& facCard_) :
+  forest(forest_),
+  nPredNum(nPredNum_),
+  facCard(facCard_),
+  nPredFac(facCard.size()) {
+  packFactors();
+}
+
+
+void CodeGen::packFactors() {
+  size_t bitTot = 0;
+  for (unsigned int tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
+    facBase.push_back(bitTot);
+    const BV& facSplit = forest->getTree(tIdx).getFacSplit();
+    size_t treeBits = facSplit.getNSlot() * BV::slotElts;
+    facWord.resize((bitTot + treeBits + 63) / 64);
+    for (size_t bit = 0; bit < treeBits; bit++) {
+      if (facSplit.testBit(bit)) {
+	size_t pos = bitTot + bit;
+	facWord[pos / 64] |= 1ull << (pos % 64);
+      }
+    }
+    bitTot += treeBits;
+  }
+}
+
+
+string CodeGen::emit() const {
+  ostringstream out;
+  // Hexadecimal floats reproduce cuts and scores exactly.
+  out << hexfloat;
+  out << "// Generated from a trained forest:  do not edit.\n\n"
+      << "#include <cmath>\n"
+      << "#include <cstddef>\n"
+      << "#include <cstdint>\n\n";
+  emitTrees(out);
+  emitScorer(out);
+
+  return out.str();
+}
+
+
+void CodeGen::emitTrees(ostringstream& out) const {
+  out << "namespace {\n\n";
+  if (!facWord.empty()) {
+    out << "const uint64_t facSplit[] = {";
+    for (size_t idx = 0; idx < facWord.size(); idx++) {
+      out << (idx % 4 == 0 ? "\n  " : " ") << "0x" << std::hex << facWord[idx] << std::dec << "ull,";
+    }
+    out << "\n};\n\n"
+	<< "inline bool facBit(size_t pos) {\n"
+	<< "  return ((facSplit[pos >> 6] >> (pos & 63)) & 1) != 0;\n"
+	<< "}\n\n";
+  }
+
+  for (unsigned int tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
+    out << "double tree" << tIdx << "(const double* num, const unsigned int* fac) {\n";
+    emitNode(out, tIdx, 0, 1);
+    out << "}\n\n";
+  }
+}
+
+
+void CodeGen::emitNode(ostringstream& out,
+		       unsigned int tIdx,
+		       IndexT nodeIdx,
+		       unsigned int depth) const {
+  string indent(2 * depth, ' ');
+  const DecNode& node = forest->getNode(tIdx)[nodeIdx];
+  if (node.isTerminal()) {
+    out << indent << "return " << forest->getScore(tIdx, nodeIdx) << ";\n";
+    return;
+  }
+
+  PredictorT predIdx = node.getPredIdx();
+  out << indent << "if (";
+  if (predIdx >= nPredNum) {
+    out << "facBit(" << facBase[tIdx] + node.getBitOffset()
+	<< "u + fac[" << predIdx - nPredNum << "])";
+  }
+  else {
+    out << "num[" << predIdx << "] <= " << node.getSplitNum();
+    // NaN fails both the <= test and its inverted counterpart.
+    if (node.delInvert(false) == node.getDelIdx()) {
+      out << " || std::isnan(num[" << predIdx << "])";
+    }
+  }
+  out << ") {\n";
+  IndexT idxTrue = nodeIdx + node.getDelIdx();
+  emitNode(out, tIdx, idxTrue, depth + 1);
+  out << indent << "}\n" << indent << "else {\n";
+  emitNode(out, tIdx, idxTrue + 1, depth + 1);
+  out << indent << "}\n";
+}
+
+
+void CodeGen::emitScorer(ostringstream& out) const {
+  const ScoreDesc& scoreDesc = forest->getScoreDesc();
+  unsigned int nTree = forest->getNTree();
+  out << "const double baseScore = " << scoreDesc.baseScore << ";\n"
+      << "const double nu = " << scoreDesc.nu << ";\n\n";
+  if (nPredFac > 0) {
+    out << "const unsigned int facCard[] = {";
+    for (PredictorT facIdx = 0; facIdx < nPredFac; facIdx++) {
+      out << (facIdx % 8 == 0 ? "\n  " : " ") << facCard[facIdx] << "u,";
+    }
+    out << "\n};\n\n";
+  }
+  out << "double scoreRow(const double* num, const unsigned int* facRow) {\n";
+  if (nPredFac > 0) {
+    // Proxy level's split bit is unset, as under prediction.
+    out << "  unsigned int fac[" << nPredFac << "];\n"
+	<< "  for (unsigned int idx = 0; idx < " << nPredFac << "; idx++) {\n"
+	<< "    fac[idx] = facRow[idx] < facCard[idx] ? facRow[idx] : facCard[idx];\n"
+	<< "  }\n";
+  }
+  else {
+    out << "  const unsigned int* fac = facRow;\n";
+  }
+
+  if (scoreDesc.scorer == "plurality") {
+    // Jittered scores truncate to the category.
+    CtgT nCtg = 1;
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      for (IndexT nodeIdx = 0; nodeIdx < forest->getNode(tIdx).size(); nodeIdx++) {
+	nCtg = max(nCtg, static_cast<CtgT>(floor(forest->getScore(tIdx, nodeIdx))) + 1);
+      }
+    }
+    out << "  double census[" << nCtg << "] = {};\n"
+	<< "  double jitter[" << nCtg << "] = {};\n"
+	<< "  double score;\n"
+	<< "  unsigned int ctg;\n";
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      out << "  score = tree" << tIdx << "(num, fac);\n"
+	  << "  ctg = static_cast<unsigned int>(std::floor(score));\n"
+	  << "  census[ctg] += 1.0;\n"
+	  << "  jitter[ctg] += score - ctg;\n";
+    }
+    out << "  unsigned int argMax = 0;\n"
+	<< "  double valMax = 0.0;\n"
+	<< "  for (unsigned int idx = 0; idx < " << nCtg << "; idx++) {\n"
+	<< "    double numVal = census[idx] + jitter[idx] * " << 1.0 / (2 * nTree) << ";\n"
+	<< "    if (numVal > valMax) {\n"
+	<< "      valMax = numVal;\n"
+	<< "      argMax = idx;\n"
+	<< "    }\n"
+	<< "  }\n"
+	<< "  return argMax;\n";
+  }
+  else {
+    bool isMean = scoreDesc.scorer == "mean";
+    out << "  double sumScore = " << (isMean ? "0.0" : "baseScore") << ";\n";
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      out << "  sumScore += " << (isMean ? "" : "nu * ") << "tree" << tIdx << "(num, fac);\n";
+    }
+    if (isMean)
+      out << "  return sumScore / " << nTree << ";\n";
+    else if (scoreDesc.scorer == "logistic")
+      out << "  return 1.0 / (1.0 + std::exp(-sumScore));\n";
+    else
+      out << "  return sumScore;\n";
+  }
+  out << "}\n\n} // namespace\n\n";
+
+  out << "extern \"C\" {\n\n"
+      << "unsigned int sgb_n_pred_num(void) {\n  return " << nPredNum << ";\n}\n\n"
+      << "unsigned int sgb_n_pred_fac(void) {\n  return " << nPredFac << ";\n}\n\n"
+      << "unsigned int sgb_n_tree(void) {\n  return " << nTree << ";\n}\n\n"
+      << "void sgb_predict(const double* num, const unsigned int* fac, size_t nRow, double* out) {\n"
+      << "  for (size_t row = 0; row < nRow; row++) {\n"
+      << "    out[row] = scoreRow(num + row * " << nPredNum << ", fac + row * " << nPredFac << ");\n"
+      << "  }\n"
+      << "}\n\n"
+      << "} // extern \"C\"\n";
+}
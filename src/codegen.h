@@ -0,0 +1,95 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file codegen.h
+
+   @brief Emits a trained forest as a self-contained C++ translation unit.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_CODEGEN_H
+#define FOREST_CODEGEN_H
+
+#include "typeparam.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+   @brief Renders each tree as nested branches over a row of numeric
+   and factor values, together with the forest's scorer.
+
+   The emitted unit depends only upon the C++ standard library and
+   exposes a C entry point:
+
+     void sgb_predict(const double* num, const unsigned int* fac,
+                      size_t nRow, double* out);
+
+   Rows are laid out contiguously, with numeric and factor predictors
+   in core order and factor levels zero-based.  Missing and unobserved
+   values are routed as under prediction without trapping:  levels
+   absent from training, including out-of-range codes, take the proxy
+   level one beyond the training cardinality.
+ */
+class CodeGen {
+  const class Forest* forest;
+  const PredictorT nPredNum; ///< # numeric predictors.
+  const vector<PredictorT> facCard; ///< Training cardinality, per factor.
+  const PredictorT nPredFac; ///< # factor-valued predictors.
+  vector<size_t> facBase; ///< Per-tree offset into emitted factor bits.
+  vector<uint64_t> facWord; ///< Forest-wide factor bits, repacked.
+
+
+  /**
+     @brief Repacks the per-tree factor bits into a flat table.
+   */
+  void packFactors();
+
+
+  /**
+     @brief Emits the tables, helpers and per-tree functions.
+   */
+  void emitTrees(ostringstream& out) const;
+
+
+  /**
+     @brief Emits the subtree rooted at a node as nested branches.
+   */
+  void emitNode(ostringstream& out,
+		unsigned int tIdx,
+		IndexT nodeIdx,
+		unsigned int depth) const;
+
+
+  /**
+     @brief Emits the row scorer and the C entry points.
+   */
+  void emitScorer(ostringstream& out) const;
+
+public:
+
+  /**
+     @param facCard_ holds the training cardinality of each factor, in
+     core order.
+   */
+  CodeGen(const class Forest* forest_,
+	  PredictorT nPredNum_,
+	  const vector<PredictorT>& facCard_);
+
+
+  /**
+     @return text of the translation unit.
+   */
+  string emit() const;
+};
+
+#endif
@@ -0,0 +1,48 @@
+// Copyright (C)  2012-2023  Mark Seligman
+//
+// This file is part of RboristBase.
+//
+// RboristBase is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// RboristBase is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RboristBase.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+   @file codegenR.cc
+
+   @brief C++ interface to R entry for forest code generation.
+
+   @author Mark Seligman
+ */
+
+#include "codegenR.h"
+#include "forestR.h"
+#include "forestbridge.h"
+#include "trainR.h"
+#include "signatureR.h"
+
+
+RcppExport SEXP forestCpp(SEXP sTrain,
+			  SEXP sCategorical) {
+  BEGIN_RCPP
+
+  List lTrain(sTrain);
+  IntegerVector predMap(as<IntegerVector>(lTrain[TrainR::strPredMap]));
+  vector<unsigned int> facCard(SignatureR::getCardinality(lTrain));
+  ForestBridge::init(predMap.length());
+  ForestBridge forestBridge(ForestR::unwrap(lTrain, as<bool>(sCategorical)));
+  string source = forestBridge.codeGen(predMap.length() - facCard.size(), facCard);
+  ForestBridge::deInit();
+
+  return wrap(source);
+
+  END_RCPP
+}
@@ -0,0 +1,188 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file columnfile.cc
+
+   @brief Methods for reading and writing binary columnar frames.
+
+   @author Mark Seligman
+ */
+
+#include "columnfile.h"
+
+#include <cstring>
+
+
+static_assert(sizeof(ColumnFile::Header) % 8 == 0, "Column file header must pad to whole words");
+
+
+static constexpr char fileMagic[4] = {'S', 'G', 'B', 'C'};
+
+
+/**
+   @return true iff the host stores integers least-significant byte first.
+ */
+static bool littleEndian() {
+  uint32_t probe = ColumnFile::byteOrder;
+  unsigned char low;
+  memcpy(&low, &probe, 1);
+  return low == 0x04;
+}
+
+
+/**
+   @brief Lays out the columns following the header and labels.
+
+   @param labelEnd is the byte offset just past the labels.
+
+   @return byte offset of each column, plus that of the file end.
+ */
+static vector<uint64_t> columnOffsets(uint64_t nRow,
+				      const vector<unsigned int>& factorTop,
+				      uint64_t labelEnd) {
+  vector<uint64_t> offset;
+  uint64_t pos = (labelEnd + 7) & ~uint64_t(7);
+  for (unsigned int top : factorTop) {
+    offset.push_back(pos);
+    pos += nRow * (top == 0 ? sizeof(double) : sizeof(uint32_t));
+  }
+  offset.push_back(pos);
+  return offset;
+}
+
+
+/**
+   @brief Writes a table of byte lengths followed by the labels.
+ */
+static void writeLabels(ofstream& out,
+			const vector<string>& label) {
+  vector<uint32_t> labelLength;
+  for (const string& lab : label) {
+    labelLength.push_back(lab.size());
+  }
+  out.write(reinterpret_cast<const char*>(labelLength.data()), labelLength.size() * sizeof(uint32_t));
+  for (const string& lab : label) {
+    out.write(lab.data(), lab.size());
+  }
+}
+
+
+ColumnFile::ColumnFile(const string& path_) :
+  path(path_),
+  in(path, ios::binary) {
+  if (!littleEndian())
+    throw runtime_error("Column files require a little-endian host");
+  if (!in)
+    throw runtime_error("Cannot open column file " + path);
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+    throw runtime_error("Column file truncated:  " + path);
+  if (memcmp(header.magic, fileMagic, 4) != 0)
+    throw runtime_error("Not a column file:  " + path);
+  if (header.version != version)
+    throw runtime_error("Unsupported column file version:  " + path);
+  if (header.byteOrder != byteOrder)
+    throw runtime_error("Column file written under foreign byte order:  " + path);
+
+  // Bounds the per-predictor tables before allocating them.
+  in.seekg(0, ios::end);
+  uint64_t length = in.tellg();
+  if (sizeof(Header) + 2 * uint64_t(header.nPred) * sizeof(uint32_t) > length)
+    throw runtime_error("Column file truncated:  " + path);
+  in.seekg(sizeof(Header));
+  vector<uint32_t> top(header.nPred);
+  if (!in.read(reinterpret_cast<char*>(top.data()), top.size() * sizeof(uint32_t)))
+    throw runtime_error("Column file truncated:  " + path);
+  factorTop = vector<unsigned int>(top.begin(), top.end());
+
+  colNames = readLabels(header.nPred, length);
+  uint64_t nLevel = 0;
+  for (unsigned int facTop : factorTop) {
+    nLevel += facTop;
+  }
+  vector<string> level = readLabels(nLevel, length);
+  auto levelStart = level.begin();
+  for (unsigned int facTop : factorTop) {
+    levels.emplace_back(levelStart, levelStart + facTop);
+    levelStart += facTop;
+  }
+
+  colOffset = columnOffsets(header.nRow, factorTop, in.tellg());
+  if (length < colOffset.back())
+    throw runtime_error("Column file truncated:  " + path);
+  colOffset.pop_back();
+}
+
+
+vector<string> ColumnFile::readLabels(uint64_t nLabel,
+				      uint64_t length) {
+  uint64_t pos = in.tellg();
+  if (nLabel > (length - pos) / sizeof(uint32_t))
+    throw runtime_error("Column file truncated:  " + path);
+  vector<uint32_t> labelLength(nLabel);
+  if (!in.read(reinterpret_cast<char*>(labelLength.data()), labelLength.size() * sizeof(uint32_t)))
+    throw runtime_error("Column file truncated:  " + path);
+  uint64_t labelBytes = 0;
+  for (uint32_t labelLen : labelLength) {
+    labelBytes += labelLen;
+  }
+  if (labelBytes > length - (pos + nLabel * sizeof(uint32_t)))
+    throw runtime_error("Column file truncated:  " + path);
+  vector<string> label;
+  for (uint32_t labelLen : labelLength) {
+    string lab(labelLen, '\0');
+    if (!in.read(&lab[0], labelLen))
+      throw runtime_error("Column file truncated:  " + path);
+    label.push_back(std::move(lab));
+  }
+  return label;
+}
+
+
+void ColumnFile::write(const string& path,
+		       size_t nRow,
+		       const vector<unsigned int>& factorTop,
+		       const vector<string>& colNames,
+		       const vector<vector<string>>& levels,
+		       const vector<const void*>& colBase) {
+  if (!littleEndian())
+    throw runtime_error("Column files require a little-endian host");
+  if (colNames.size() != factorTop.size() || levels.size() != factorTop.size() || colBase.size() != factorTop.size())
+    throw runtime_error("Column names and data do not conform with predictors");
+  vector<string> level;
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+    if (levels[predIdx].size() != factorTop[predIdx])
+      throw runtime_error("Level labels do not conform with level counts");
+    level.insert(level.end(), levels[predIdx].begin(), levels[predIdx].end());
+  }
+  Header header{};
+  memcpy(header.magic, fileMagic, 4);
+  header.version = version;
+  header.byteOrder = byteOrder;
+  header.nPred = factorTop.size();
+  header.nRow = nRow;
+
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out)
+    throw runtime_error("Cannot open column file " + path);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  vector<uint32_t> top(factorTop.begin(), factorTop.end());
+  out.write(reinterpret_cast<const char*>(top.data()), top.size() * sizeof(uint32_t));
+  writeLabels(out, colNames);
+  writeLabels(out, level);
+
+  uint64_t labelEnd = out.tellp();
+  vector<uint64_t> offset = columnOffsets(nRow, factorTop, labelEnd);
+  const char pad[8] = {};
+  out.write(pad, offset[0] - labelEnd);
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+    out.write(static_cast<const char*>(colBase[predIdx]), offset[predIdx + 1] - offset[predIdx]);
+  }
+
+  if (!out.flush())
+    throw runtime_error("Error writing column file " + path);
+}
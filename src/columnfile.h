@@ -0,0 +1,152 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file columnfile.h
+
+   @brief Binary columnar representation of an observation frame.
+
+   @author Mark Seligman
+ */
+
+#ifndef DEFRAME_COLUMNFILE_H
+#define DEFRAME_COLUMNFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Reads an on-disk frame one column slice at a time.
+
+   The file is little-endian and consists of a fixed-size header, the
+   highest level of each predictor, or zero if numeric, the byte length
+   of each predictor's name, the names themselves, unterminated, the
+   byte length of each factor level's label, in predictor order, the
+   labels themselves, unterminated, and then the columns in predictor
+   order, starting on an eight-byte boundary.
+   Numeric columns hold doubles and factor columns hold 32-bit codes,
+   nRow per column.  Codes follow the front end's convention, as with
+   in-memory frames.
+ */
+class ColumnFile {
+public:
+  static constexpr uint32_t version = 3;
+  static constexpr uint32_t byteOrder = 0x01020304; ///< Endianness check.
+
+  /**
+     @brief Fixed-width preamble, at offset zero.
+   */
+  struct Header {
+    char magic[4]; ///< "SGBC".
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nPred;
+    uint64_t nRow;
+  };
+
+private:
+  const string path;
+  ifstream in;
+  Header header;
+  vector<unsigned int> factorTop; ///< Highest level, else zero if numeric.
+  vector<string> colNames; ///< Predictor names.
+  vector<vector<string>> levels; ///< Level labels, per predictor.
+  vector<uint64_t> colOffset; ///< Byte offset of each column.
+
+
+  /**
+     @brief Reads a table of byte lengths followed by the labels.
+
+     @param length is the file length, bounding the table.
+
+     @throw runtime_error if the table overruns the file.
+   */
+  vector<string> readLabels(uint64_t nLabel,
+			    uint64_t length);
+
+public:
+
+  /**
+     @throw runtime_error if the file cannot be read or is malformed.
+   */
+  ColumnFile(const string& path_);
+
+
+  size_t getNRow() const {
+    return header.nRow;
+  }
+
+
+  unsigned int getNPred() const {
+    return header.nPred;
+  }
+
+
+  const vector<unsigned int>& getFactorTop() const {
+    return factorTop;
+  }
+
+
+  const vector<string>& getColNames() const {
+    return colNames;
+  }
+
+
+  /**
+     @return level labels, per predictor, empty if numeric.
+   */
+  const vector<vector<string>>& getLevels() const {
+    return levels;
+  }
+
+
+  /**
+     @brief Reads a contiguous slice of a column.
+
+     @param valOut outputs extent values beginning at rowStart.
+
+     @throw runtime_error if the read falls short.
+   */
+  template<typename valType>
+  void read(unsigned int predIdx,
+	    size_t rowStart,
+	    size_t extent,
+	    valType valOut[]) {
+    in.seekg(colOffset[predIdx] + rowStart * sizeof(valType));
+    if (!in.read(reinterpret_cast<char*>(valOut), extent * sizeof(valType)))
+      throw runtime_error("Column file truncated:  " + path);
+  }
+
+
+  /**
+     @brief Writes a frame held in memory.
+
+     @param factorTop is the highest level, per predictor, else zero.
+
+     @param colNames are the predictor names.
+
+     @param levels are the level labels, per predictor.
+
+     @param colBase is the base address of each column.
+
+     @throw runtime_error if the file cannot be written.
+   */
+  static void write(const string& path,
+		    size_t nRow,
+		    const vector<unsigned int>& factorTop,
+		    const vector<string>& colNames,
+		    const vector<vector<string>>& levels,
+		    const vector<const void*>& colBase);
+};
+
+#endif
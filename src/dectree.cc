@@ -15,7 +15,6 @@
 
 
 #include "dectree.h"
-#include "predictframe.h"
 
 
 DecTree::DecTree(const vector<DecNode>& decNode_,
@@ -29,54 +28,4 @@ DecTree::DecTree(const vector<DecNode>& decNode_,
 }
 
 
-void DecTree::setObsWalker(PredictorT nPredNum) {
-  if (facSplit.isEmpty())
-    obsWalker = &DecTree::obsNum;
-  else if (nPredNum == 0)
-    obsWalker = &DecTree::obsFac;
-  else
-    obsWalker = &DecTree::obsMixed;
-}
-
-
 DecTree::~DecTree() = default;
-
-
-IndexT DecTree::obsNum(const PredictFrame& frame,
-		       size_t obsIdx) const {
-  IndexT idx = 0;
-  IndexT delIdx = 0;
-  do {
-    delIdx = decNode[idx].advance(frame.baseNum(obsIdx));
-    idx += delIdx;
-  } while (delIdx != 0);
-
-  return idx;
-}
-
-
-IndexT DecTree::obsFac(const PredictFrame& frame,
-		       size_t obsIdx) const {
-  IndexT idx = 0;
-  IndexT delIdx = 0;
-  do {
-    delIdx = decNode[idx].advance(facSplit, facObserved, frame.baseFac(obsIdx));
-    idx += delIdx;
-  } while (delIdx != 0);
-
-  return idx;
-}
-
-
-IndexT DecTree::obsMixed(const PredictFrame& frame,
-			 size_t obsIdx) const {
-  IndexT idx = 0;
-  IndexT delIdx = 0;
-  do {
-    delIdx = decNode[idx].advance(frame, facSplit, facObserved, frame.baseFac(obsIdx), frame.baseNum(obsIdx));
-    idx += delIdx;
-  } while (delIdx != 0);
-
-  return idx;
-}
-
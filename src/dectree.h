@@ -36,38 +36,24 @@ public:
 
   ~DecTree();
 
-  
-  IndexT (DecTree::* obsWalker)(const class PredictFrame&, size_t) const;
-  
-
-  void setObsWalker(PredictorT nPredNum);
 
-  
-  IndexT walkObs(const class PredictFrame& frame,
-		 size_t obsIdx) const {
-    return (this->*DecTree::obsWalker)(frame, obsIdx);
+  size_t nodeCount() const {
+    return decNode.size();
   }
 
-  
-  IndexT obsNum(const class PredictFrame& frame,
-		size_t obsIdx) const;
-
-
-  IndexT obsFac(const class PredictFrame& frame,
-		size_t obsIdx) const;
 
-
-  IndexT obsMixed(const class PredictFrame& frame,
-		  size_t obsIdx) const;
+  const vector<DecNode>& getNode() const {
+    return decNode;
+  }
 
 
-  size_t nodeCount() const {
-    return decNode.size();
+  const BV& getFacSplit() const {
+    return facSplit;
   }
 
 
-  const vector<DecNode>& getNode() const {
-    return decNode;
+  const BV& getFacObserved() const {
+    return facObserved;
   }
 
 
@@ -27,6 +27,8 @@
 #include "deframe.h"
 #include "block.h"
 #include "rleframeR.h"
+#include "columnfile.h"
+#include "framefile.h"
 
 #include<memory>
 
@@ -79,6 +81,19 @@ RcppExport SEXP deframeNum(SEXP sX) {
 }
 
 
+RcppExport SEXP deframeDense(SEXP sX) {
+  NumericMatrix blockNum(sX);
+  List deframe = List::create(
+			      _["denseNum"] = blockNum,
+			      _["nRow"] = blockNum.nrow(),
+			      _["signature"] = SignatureR::wrapNumeric(blockNum)
+			      );
+
+  deframe.attr("class") = "Deframe";
+  return deframe;
+}
+
+
 /**
    @brief Reads an S4 object containing (sparse) dgCMatrix.
  */
@@ -154,3 +169,77 @@ RcppExport SEXP deframeIP(SEXP sX) {
 
   END_RCPP
 }
+
+
+RcppExport SEXP deframeFile(SEXP sPath,
+			    SEXP sMemBudget) {
+  BEGIN_RCPP
+
+  ColumnFile colFile(as<string>(sPath));
+  List deframe = List::create(
+			      _["rleFrame"] = RLEFrameR::presortFile(colFile, as<double>(sMemBudget)),
+			      _["nRow"] = colFile.getNRow(),
+			      _["signature"] = SignatureR::wrapTop(colFile.getFactorTop(), colFile.getColNames(), colFile.getLevels()));
+  deframe.attr("class") = "Deframe";
+  return deframe;
+
+  END_RCPP
+}
+
+
+RcppExport SEXP writeColumns(SEXP sCols,
+			     SEXP sFactorTop,
+			     SEXP sColNames,
+			     SEXP sLevels,
+			     SEXP sPath) {
+  BEGIN_RCPP
+
+  List lCols(sCols);
+  vector<unsigned int> factorTop(as<vector<unsigned int>>(sFactorTop));
+  if (factorTop.size() != static_cast<size_t>(lCols.length()))
+    stop("Level counts do not conform with columns");
+  size_t nRow = lCols.length() == 0 ? 0 : Rf_xlength(lCols[0]);
+  vector<const void*> colBase;
+  for (R_xlen_t predIdx = 0; predIdx < lCols.length(); predIdx++) {
+    SEXP col = lCols[predIdx];
+    if (TYPEOF(col) != (factorTop[predIdx] == 0 ? REALSXP : INTSXP) || static_cast<size_t>(Rf_xlength(col)) != nRow)
+      stop("Columns must be conforming double or factor code vectors");
+    colBase.push_back(factorTop[predIdx] == 0 ? static_cast<const void*>(REAL(col)) : static_cast<const void*>(INTEGER(col)));
+  }
+  List lLevels(sLevels);
+  vector<vector<string>> levels;
+  for (R_xlen_t predIdx = 0; predIdx < lLevels.length(); predIdx++) {
+    levels.push_back(as<vector<string>>(lLevels[predIdx]));
+  }
+  ColumnFile::write(as<string>(sPath), nRow, factorTop, as<vector<string>>(sColNames), levels, colBase);
+  return R_NilValue;
+
+  END_RCPP
+}
+
+
+RcppExport SEXP writeFrameFile(SEXP sDeframe,
+			       SEXP sFrontEnd,
+			       SEXP sPath) {
+  BEGIN_RCPP
+
+  RawVector frontEnd(sFrontEnd);
+  FrameFile::write(RLEFrameR::unwrap(List(sDeframe)).get(),
+		   vector<unsigned char>(frontEnd.begin(), frontEnd.end()),
+		   as<string>(sPath));
+  return R_NilValue;
+
+  END_RCPP
+}
+
+
+RcppExport SEXP readFrameFile(SEXP sPath) {
+  BEGIN_RCPP
+
+  FrameFile frameFile(as<string>(sPath));
+  vector<unsigned char> frontEnd(frameFile.getFrontEnd());
+  return List::create(_["frontEnd"] = RawVector(frontEnd.begin(), frontEnd.end()),
+		      _["nRow"] = frameFile.getNObs());
+
+  END_RCPP
+}
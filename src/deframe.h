@@ -69,9 +69,73 @@ RcppExport SEXP deframeFac(SEXP sX);
 RcppExport SEXP deframeNum(SEXP sX);
 
 
+/**
+   @brief Wraps a numeric-valued matrix for prediction, without encoding.
+
+   @param sX is the matrix, read in place.
+ */
+RcppExport SEXP deframeDense(SEXP sX);
+
+
 /**
    @brief Encodes a sparse matrix compressed using 'I', 'P' indices.
  */
 RcppExport SEXP deframeIP(SEXP sX);
 
+
+/**
+   @brief Encodes a binary columnar file, sorting out of core.
+
+   @param sPath is the file path.
+
+   @param sMemBudget is the number of bytes available to sorting.
+ */
+RcppExport SEXP deframeFile(SEXP sPath,
+			    SEXP sMemBudget);
+
+
+/**
+   @brief Writes a frame as a binary columnar file.
+
+   @param sCols holds the columns:  doubles if numeric, else one-based
+   integer codes.
+
+   @param sFactorTop is the highest level, per predictor, else zero.
+
+   @param sColNames are the predictor names.
+
+   @param sLevels are the level labels, per predictor.
+
+   @param sPath is the output file path.
+ */
+RcppExport SEXP writeColumns(SEXP sCols,
+			     SEXP sFactorTop,
+			     SEXP sColNames,
+			     SEXP sLevels,
+			     SEXP sPath);
+
+
+/**
+   @brief Writes a presorted frame as a mappable image.
+
+   @param sDeframe is the presorted frame.
+
+   @param sFrontEnd is the serialized front-end state.
+
+   @param sPath is the output file path.
+ */
+RcppExport SEXP writeFrameFile(SEXP sDeframe,
+			       SEXP sFrontEnd,
+			       SEXP sPath);
+
+
+/**
+   @brief Validates a frame image and recovers its front-end state.
+
+   @param sPath is the image path.
+
+   @return list of serialized front-end state and row count.
+ */
+RcppExport SEXP readFrameFile(SEXP sPath);
+
 #endif
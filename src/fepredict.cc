@@ -40,6 +40,16 @@ void FEPredict::initCtgProb(bool doProb) {
 }
 
 
+void FEPredict::initStage(vector<unsigned int> stage) {
+  ForestPrediction::initStage(std::move(stage));
+}
+
+
+void FEPredict::initShap(bool doShap) {
+  ForestPrediction::initShap(doShap);
+}
+
+
 void FEPredict::initOmp(unsigned int nThread) {
   OmpThread::init(nThread);
 }
@@ -49,6 +49,18 @@ struct FEPredict {
   static void initCtgProb(bool doProb);
 
 
+  /**
+     @brief Sets tree-count checkpoints for staged prediction.
+   */
+  static void initStage(vector<unsigned int> stage);
+
+
+  /**
+     @brief Enables per-row feature contributions.
+   */
+  static void initShap(bool doShap);
+
+
   static void initOmp(unsigned int nThread);
   
 
@@ -71,8 +71,8 @@ void FETrain::initNodeScorer(const string& scorer) {
 }
 
 
-void FETrain::initGrove(bool thinLeaves, unsigned int trainBlock) {
-  Grove::init(thinLeaves, trainBlock);
+void FETrain::initGrove(bool thinLeaves, unsigned int trainBlock, size_t memCap) {
+  Grove::init(thinLeaves, trainBlock, memCap);
 }
 
 
@@ -93,7 +93,8 @@ struct FETrain {
 
 
   static void initGrove(bool thinLeaves,
-			unsigned int trainBlock);
+			unsigned int trainBlock,
+			size_t memCap);
 
 \
   /**
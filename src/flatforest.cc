@@ -0,0 +1,187 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file flatforest.cc
+
+   @brief Builds the flattened forest from its decision trees.
+
+   @author Mark Seligman
+ */
+
+#include "flatforest.h"
+#include "dectree.h"
+
+
+FlatForest::FlatForest(const vector<DecTree>& decTree,
+		       PredictorT nPredNum_) :
+  trapUnobserved(DecNode::trapAndBail()),
+  nPredNum(nPredNum_),
+  treeOffsetV(vector<uint64_t>(1)) {
+  for (const DecTree& tree : decTree) {
+    size_t bitBase = facSplitV.size() * BV::slotElts;
+    const BV& treeSplit = tree.getFacSplit();
+    const BV& treeObserved = tree.getFacObserved();
+    (void) treeSplit.appendSlots(facSplitV, treeSplit.getNSlot() * BV::slotElts);
+    (void) treeObserved.appendSlots(facObservedV, treeObserved.getNSlot() * BV::slotElts);
+    facObservedV.resize(facSplitV.size()); // Keeps bases aligned.
+    appendTree(tree, nPredNum, bitBase);
+    treeOffsetV.push_back(delFalseV.size());
+    // Terminal lanes read position zero, so some numeric column must exist.
+    bool numeric = nPredNum > 0;
+    for (size_t flatIdx = treeOffsetV[treeOffsetV.size() - 2]; flatIdx < delFalseV.size(); flatIdx++) {
+      numeric = numeric && (predPosV[flatIdx] & facBit) == 0;
+    }
+    treeNumericV.push_back(numeric ? 1 : 0);
+  }
+
+  nTree = decTree.size();
+  nNode = delFalseV.size();
+  nSlot = facSplitV.size();
+  treeOffset = treeOffsetV.data();
+  treeNumeric = treeNumericV.data();
+  predPos = predPosV.data();
+  split = splitV.data();
+  delFalse = delFalseV.data();
+  score = scoreV.data();
+  nodeIdx = nodeIdxV.data();
+  facSplit = facSplitV.data();
+  facObserved = facObservedV.data();
+  compactify();
+}
+
+
+FlatForest::FlatForest(const Arrays& arrays,
+		       PredictorT nPredNum_) :
+  trapUnobserved(DecNode::trapAndBail()),
+  nPredNum(nPredNum_),
+  nTree(arrays.nTree),
+  nNode(arrays.nNode),
+  nSlot(arrays.nSlot),
+  treeOffset(arrays.treeOffset),
+  treeNumeric(arrays.treeNumeric),
+  predPos(arrays.predPos),
+  split(arrays.split),
+  delFalse(arrays.delFalse),
+  score(arrays.score),
+  nodeIdx(arrays.nodeIdx),
+  facSplit(arrays.facSplit),
+  facObserved(arrays.facObserved),
+  compact(arrays.compact),
+  nCut(arrays.nCut),
+  cutVal(arrays.cutVal) {
+}
+
+
+FlatForest::Arrays FlatForest::getArrays() const {
+  return Arrays{nTree, nNode, nSlot, treeOffset, treeNumeric, predPos, split, delFalse, score, nodeIdx, facSplit, facObserved, compact, nCut, cutVal};
+}
+
+
+void FlatForest::compactify() {
+  compact = nullptr;
+  nCut = 0;
+  cutVal = nullptr;
+  if (nSlot * BV::slotElts > UINT32_MAX)
+    return;
+
+  // Distinct cuts, clustered by predictor.
+  vector<pair<PredictorT, double>> predCut;
+  for (size_t flatIdx = 0; flatIdx < nNode; flatIdx++) {
+    if (delFalse[flatIdx] == 0)
+      continue;
+    if (delFalse[flatIdx] > UINT16_MAX || (predPos[flatIdx] & posMask) > compactPosMask)
+      return;
+    if ((predPos[flatIdx] & facBit) == 0)
+      predCut.emplace_back(predPos[flatIdx] & posMask, split[flatIdx]);
+  }
+  sort(predCut.begin(), predCut.end());
+  predCut.erase(unique(predCut.begin(), predCut.end()), predCut.end());
+  if (predCut.size() > UINT32_MAX)
+    return;
+  for (const auto& pc : predCut)
+    cutV.push_back(pc.second);
+  if (cutV.empty()) // Terminal lanes of a batch read a cut.
+    cutV.push_back(0.0);
+
+  compactV.reserve(nNode);
+  for (size_t flatIdx = 0; flatIdx < nNode; flatIdx++) {
+    PredictorT pred = predPos[flatIdx];
+    uint16_t packedPos = (pred & posMask) | ((pred & facBit) ? compactFac : 0) | ((pred & nanTrueBit) ? compactNaNTrue : 0);
+    uint32_t thresh;
+    if (delFalse[flatIdx] == 0)
+      thresh = 0;
+    else if (pred & facBit)
+      thresh = static_cast<uint32_t>(split[flatIdx]);
+    else
+      thresh = lower_bound(predCut.begin(), predCut.end(), make_pair(pred & posMask, split[flatIdx])) - predCut.begin();
+    compactV.push_back(CompactNode{packedPos, static_cast<uint16_t>(delFalse[flatIdx]), thresh});
+  }
+  compact = compactV.data();
+  nCut = cutV.size();
+  cutVal = cutV.data();
+
+  // Packed nodes supersede the wide arrays.
+  vector<PredictorT>().swap(predPosV);
+  vector<double>().swap(splitV);
+  vector<IndexT>().swap(delFalseV);
+  predPos = nullptr;
+  split = nullptr;
+  delFalse = nullptr;
+}
+
+
+void FlatForest::appendTree(const DecTree& tree,
+			    PredictorT nPredNum,
+			    size_t bitBase) {
+  const vector<DecNode>& decNode = tree.getNode();
+
+  // Preorder:  true branch visited, and hence placed, first.
+  vector<IndexT> nodeStack;
+  vector<size_t> flatParent; // Flattened position awaiting false offset.
+  nodeStack.push_back(0);
+  flatParent.push_back(0);
+  while (!nodeStack.empty()) {
+    IndexT idx = nodeStack.back();
+    size_t parent = flatParent.back();
+    nodeStack.pop_back();
+    flatParent.pop_back();
+
+    size_t flatIdx = delFalseV.size();
+    if (parent != 0) { // Only false branches are deferred.
+      delFalseV[parent - 1] = flatIdx - (parent - 1);
+    }
+
+    const DecNode& node = decNode[idx];
+    nodeIdxV.push_back(idx);
+    scoreV.push_back(tree.getScore(idx));
+    if (node.isTerminal()) {
+      predPosV.push_back(0);
+      splitV.push_back(0.0);
+      delFalseV.push_back(0);
+      continue;
+    }
+
+    PredictorT predIdx = node.getPredIdx();
+    if (predIdx >= nPredNum) {
+      predPosV.push_back((predIdx - nPredNum) | facBit);
+      splitV.push_back(bitBase + node.getBitOffset());
+    }
+    else {
+      // NaN fails both the <= test and its inverted counterpart.
+      predPosV.push_back(predIdx | (node.delInvert(false) == node.getDelIdx() ? nanTrueBit : 0));
+      splitV.push_back(node.getSplitNum());
+    }
+    delFalseV.push_back(1); // Placeholder:  nonzero.
+
+    IndexT idxTrue = idx + node.getDelIdx();
+    nodeStack.push_back(idxTrue + 1);
+    flatParent.push_back(flatIdx + 1);
+    nodeStack.push_back(idxTrue);
+    flatParent.push_back(0);
+  }
+}
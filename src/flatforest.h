@@ -0,0 +1,355 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file flatforest.h
+
+   @brief Flattened, structure-of-arrays forest layout for prediction.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_FLATFOREST_H
+#define FOREST_FLATFOREST_H
+
+#include "predictframe.h"
+#include "bv.h"
+#include "typeparam.h"
+
+#include <cstdint>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+
+/**
+   @brief Nodes of every tree, in depth-first order, as parallel arrays.
+
+   The true branch of a nonterminal immediately follows it, so only the
+   offset to the false branch need be recorded.  Predictor positions are
+   resolved against the prediction frame, with the factor and missing-data
+   senses folded into the high bits.
+
+   Where every field fits, the nodes are instead packed into eight bytes
+   apiece, and the wide node arrays released.  Numeric thresholds are
+   then replaced by their index into a table of the forest's distinct
+   cuts, so that comparisons remain exact.
+ */
+class FlatForest {
+public:
+  static constexpr PredictorT facBit = 1u << 31; ///< Factor split.
+  static constexpr PredictorT nanTrueBit = 1u << 30; ///< NaN takes true branch.
+  static constexpr PredictorT posMask = nanTrueBit - 1; ///< Frame position.
+
+  /**
+     @brief Packed node:  terminal iff delFalse is zero.
+   */
+  struct CompactNode {
+    uint16_t predPos; ///< Frame position, with flag bits.
+    uint16_t delFalse; ///< Offset to false branch.
+    uint32_t thresh; ///< Index of numeric cut, or forest-wide bit offset.
+  };
+  static constexpr uint16_t compactFac = 0x8000; ///< Factor split.
+  static constexpr uint16_t compactNaNTrue = 0x4000; ///< NaN takes true branch.
+  static constexpr uint16_t compactPosMask = compactNaNTrue - 1; ///< Frame position.
+
+private:
+  const bool trapUnobserved; ///< Caches the training-time setting.
+  const PredictorT nPredNum; ///< Row stride of the numeric frame.
+
+  // Backing store, populated only when built from decision trees:
+  vector<uint64_t> treeOffsetV;
+  vector<unsigned char> treeNumericV;
+  vector<PredictorT> predPosV;
+  vector<double> splitV;
+  vector<IndexT> delFalseV;
+  vector<double> scoreV;
+  vector<IndexT> nodeIdxV;
+  vector<BVSlotT> facSplitV;
+  vector<BVSlotT> facObservedV;
+  vector<CompactNode> compactV;
+  vector<double> cutV;
+
+  // Views, either of the backing store or of an external image:
+  unsigned int nTree;
+  size_t nNode;
+  size_t nSlot; ///< # factor bit slots.
+  const uint64_t* treeOffset; ///< Per-tree starting node, plus terminal.
+  const unsigned char* treeNumeric; ///< Per-tree:  true iff no factor splits.
+  const PredictorT* predPos; ///< Frame position, with flag bits; null if packed.
+  const double* split; ///< Numeric cut or forest-wide bit offset; " "
+  const IndexT* delFalse; ///< Offset to false branch; zero iff terminal; " "
+  const double* score; ///< Per-node score, including leaf values.
+  const IndexT* nodeIdx; ///< Originating index within tree.
+  const BVSlotT* facSplit; ///< Forest-wide factor split bits.
+  const BVSlotT* facObserved; ///< Forest-wide factor observation bits.
+  const CompactNode* compact; ///< Packed nodes, if eligible, else null.
+  size_t nCut; ///< # distinct numeric cuts, if packed.
+  const double* cutVal; ///< Distinct numeric cuts, indexed by packed nodes.
+
+
+  /**
+     @brief Tests a bit of a forest-wide factor vector, as does BV.
+   */
+  static inline bool testBit(const BVSlotT slots[],
+			     size_t pos) {
+    return ((slots[pos / BV::slotElts] >> (pos % BV::slotElts)) & 1) != 0;
+  }
+
+
+  /**
+     @brief Appends the nodes of a tree in depth-first order.
+
+     @param bitBase is the tree's starting position within the factor bits.
+   */
+  void appendTree(const class DecTree& tree,
+		  PredictorT nPredNum,
+		  size_t bitBase);
+
+
+  /**
+     @brief Packs the parallel arrays into compact nodes, if every field
+     fits, releasing the wide node arrays.
+   */
+  void compactify();
+
+
+  /**
+     @brief Scalar walk over the packed nodes.
+   */
+  inline size_t walkCompact(const double rowNum[],
+			    const CtgT rowFac[],
+			    unsigned int tIdx) const {
+    size_t idx = treeOffset[tIdx];
+    CompactNode node = compact[idx];
+    while (node.delFalse != 0) {
+      bool sense;
+      if (node.predPos & compactFac) {
+	size_t bitOffset = node.thresh + rowFac[node.predPos & compactPosMask];
+	if (trapUnobserved && !testBit(facObserved, bitOffset))
+	  break;
+	sense = testBit(facSplit, bitOffset);
+      }
+      else {
+	double numVal = rowNum[node.predPos & compactPosMask];
+	if (std::isnan(numVal)) {
+	  if (trapUnobserved)
+	    break;
+	  sense = (node.predPos & compactNaNTrue) != 0;
+	}
+	else {
+	  sense = numVal <= cutVal[node.thresh];
+	}
+      }
+      idx += sense ? 1 : node.delFalse;
+      node = compact[idx];
+    }
+
+    return idx;
+  }
+
+public:
+  static constexpr unsigned int batchRows = 8; ///< Lanes per batch.
+
+
+  /**
+     @brief The flattened arrays as bare, read-only extents.
+   */
+  struct Arrays {
+    unsigned int nTree;
+    size_t nNode;
+    size_t nSlot;
+    const uint64_t* treeOffset;
+    const unsigned char* treeNumeric;
+    const PredictorT* predPos;
+    const double* split;
+    const IndexT* delFalse;
+    const double* score;
+    const IndexT* nodeIdx;
+    const BVSlotT* facSplit;
+    const BVSlotT* facObserved;
+    const CompactNode* compact; ///< Null unless packed, else wide arrays null.
+    size_t nCut;
+    const double* cutVal;
+  };
+
+
+  /**
+     @param nPredNum is the number of numeric predictors in the frame.
+   */
+  FlatForest(const vector<class DecTree>& decTree,
+	     PredictorT nPredNum_);
+
+
+  /**
+     @brief Views arrays held elsewhere, such as in a mapped file, without
+     copying.  Caller must keep the arrays live.
+   */
+  FlatForest(const Arrays& arrays,
+	     PredictorT nPredNum_);
+
+
+  FlatForest(const FlatForest&) = delete;
+
+
+  /**
+     @return views of the flattened arrays.
+   */
+  Arrays getArrays() const;
+
+
+  /**
+     @brief Walks a single observation through a tree.
+
+     @return flattened index of the final node, typically terminal.
+   */
+  inline size_t walkFlat(const PredictFrame& frame,
+			 size_t obsIdx,
+			 unsigned int tIdx) const {
+    return walkFlat(frame.baseNum(obsIdx), frame.baseFac(obsIdx), tIdx);
+  }
+
+
+  /**
+     @brief As above, but over bare row buffers.
+   */
+  inline size_t walkFlat(const double rowNum[],
+			 const CtgT rowFac[],
+			 unsigned int tIdx) const {
+    if (compact != nullptr)
+      return walkCompact(rowNum, rowFac, tIdx);
+
+    size_t idx = treeOffset[tIdx];
+    while (delFalse[idx] != 0) {
+      PredictorT pred = predPos[idx];
+      bool sense;
+      if (pred & facBit) {
+	size_t bitOffset = static_cast<size_t>(split[idx]) + rowFac[pred & posMask];
+	if (trapUnobserved && !testBit(facObserved, bitOffset))
+	  break;
+	sense = testBit(facSplit, bitOffset);
+      }
+      else {
+	double numVal = rowNum[pred & posMask];
+	if (std::isnan(numVal)) {
+	  if (trapUnobserved)
+	    break;
+	  sense = (pred & nanTrueBit) != 0;
+	}
+	else {
+	  sense = numVal <= split[idx];
+	}
+      }
+      idx += sense ? 1 : delFalse[idx];
+    }
+
+    return idx;
+  }
+
+
+  /**
+     @brief Walks a batch of consecutive observations through a tree in
+     lockstep.  Lanes reaching a terminal idle until all have done so.
+
+     Tree must be numeric-only.
+
+     @param[out] idxOut outputs the tree-relative final node, per lane.
+   */
+  inline void walkBatch(const PredictFrame& frame,
+			size_t obsStart,
+			unsigned int tIdx,
+			IndexT idxOut[]) const {
+    const double* rowNum = frame.baseNum(obsStart);
+    size_t idx[batchRows];
+    fill(idx, idx + batchRows, treeOffset[tIdx]);
+    bool live;
+    if (compact != nullptr) {
+      do {
+	live = false;
+#pragma omp simd reduction(|:live)
+	for (unsigned int lane = 0; lane < batchRows; lane++) {
+	  size_t nodeFlat = idx[lane];
+	  CompactNode node = compact[nodeFlat];
+	  double numVal = rowNum[lane * nPredNum + (node.predPos & compactPosMask)];
+	  bool isNaN = numVal != numVal;
+	  bool sense = numVal <= cutVal[node.thresh] || (isNaN && (node.predPos & compactNaNTrue) != 0);
+	  bool advance = node.delFalse != 0 && !(isNaN && trapUnobserved);
+	  idx[lane] = advance ? nodeFlat + (sense ? 1 : node.delFalse) : nodeFlat;
+	  live |= advance;
+	}
+      } while (live);
+    }
+    else {
+      do {
+	live = false;
+#pragma omp simd reduction(|:live)
+	for (unsigned int lane = 0; lane < batchRows; lane++) {
+	  size_t nodeFlat = idx[lane];
+	  PredictorT pred = predPos[nodeFlat];
+	  double numVal = rowNum[lane * nPredNum + (pred & posMask)];
+	  bool isNaN = numVal != numVal;
+	  bool sense = numVal <= split[nodeFlat] || (isNaN && (pred & nanTrueBit) != 0);
+	  bool advance = delFalse[nodeFlat] != 0 && !(isNaN && trapUnobserved);
+	  idx[lane] = advance ? nodeFlat + (sense ? 1 : delFalse[nodeFlat]) : nodeFlat;
+	  live |= advance;
+	}
+      } while (live);
+    }
+
+    for (unsigned int lane = 0; lane < batchRows; lane++) {
+      idxOut[lane] = nodeIdx[idx[lane]];
+    }
+  }
+
+
+  /**
+     @return true iff the tree can be walked in batches.
+   */
+  inline bool isBatchable(unsigned int tIdx) const {
+    return treeNumeric[tIdx] != 0;
+  }
+
+
+  /**
+     @return tree-relative index of the final node, typically terminal.
+   */
+  inline IndexT walkObs(const PredictFrame& frame,
+			size_t obsIdx,
+			unsigned int tIdx) const {
+    return nodeIdx[walkFlat(frame, obsIdx, tIdx)];
+  }
+
+
+  inline IndexT walkObs(const double rowNum[],
+			const CtgT rowFac[],
+			unsigned int tIdx) const {
+    return nodeIdx[walkFlat(rowNum, rowFac, tIdx)];
+  }
+
+
+  /**
+     @return score at flattened node index.
+   */
+  inline double getScore(size_t flatIdx) const {
+    return score[flatIdx];
+  }
+
+
+  /**
+     @return number of nodes over all trees.
+   */
+  size_t getNodeCount() const {
+    return nNode;
+  }
+
+
+  unsigned int getNTree() const {
+    return nTree;
+  }
+};
+
+#endif
@@ -57,10 +57,14 @@ unique_ptr<ForestPredictionCtg> Forest::makePredictionCtg(const Sampler* sampler
 }
 						   
 
-// Should happen either internally or at construction.
 void Forest::initWalkers(const PredictFrame& trFrame) {
-  for (DecTree& tree : decTree)
-    tree.setObsWalker(trFrame.getNPredNum());
+  if (flatForest == nullptr) {
+    flatForest = make_unique<FlatForest>(decTree, trFrame.getNPredNum());
+    if (QuickScorer::eligible(decTree, trFrame))
+      quickScorer = make_unique<QuickScorer>(decTree, trFrame.getNPredNum());
+    else if (BinnedForest::eligible(decTree, trFrame))
+      binnedForest = make_unique<BinnedForest>(decTree, trFrame.getNPredNum());
+  }
 }
 
 
@@ -106,6 +110,12 @@ vector<IndexT> Forest::getLeafNodes(unsigned int tIdx,
 }
 
 
+void Forest::initWeight(const Sampler* sampler) {
+  if (forestWeight == nullptr)
+    forestWeight = make_unique<ForestWeight>(this, sampler);
+}
+
+
 vector<vector<IndexRange>> Forest::leafDominators() const {
   vector<vector<IndexRange>> leafDom(nTree);
   
@@ -18,7 +18,11 @@
 #define FOREST_FOREST_H
 
 #include "dectree.h"
+#include "flatforest.h"
+#include "quickscorer.h"
+#include "binnedforest.h"
 #include "leaf.h"
+#include "forestweight.h"
 #include "typeparam.h"
 #include "scoredesc.h"
 
@@ -31,6 +35,10 @@
 */
 class Forest {
   vector<DecTree> decTree; ///< New representation; ultimately constant.
+  unique_ptr<FlatForest> flatForest; ///< Prediction layout, built on demand.
+  unique_ptr<QuickScorer> quickScorer; ///< Nonnull iff bitvector-eligible.
+  unique_ptr<BinnedForest> binnedForest; ///< Nonnull iff quantized.
+  unique_ptr<ForestWeight> forestWeight; ///< Weighting cache, built on demand.
   const ScoreDesc scoreDesc;
   const Leaf leaf;  //  const unique_ptr<class Leaf> leaf;
   const size_t noNode; ///< Inattainable node index.
@@ -66,15 +74,47 @@ class Forest {
 
 
   /**
-     @brief Initializes walker state.  Ultimately deprecated.
+     @brief Builds the flattened layout against the frame's predictor types.
    */
   void initWalkers(const class PredictFrame& trFrame);
 
 
+  /**
+     @brief Caches the per-node sample lists for weighting, if not already.
+   */
+  void initWeight(const class Sampler* sampler);
+
+
+  const ForestWeight* getForestWeight() const {
+    return forestWeight.get();
+  }
+
+
   IndexT walkObs(const class PredictFrame& frame,
 		 size_t obsIdx,
 		 unsigned int tIdx) const {
-    return decTree[tIdx].walkObs(frame, obsIdx);
+    return flatForest->walkObs(frame, obsIdx, tIdx);
+  }
+
+
+  const FlatForest* getFlatForest() const {
+    return flatForest.get();
+  }
+
+
+  /**
+     @return bitvector traversal engine, if eligible, else null.
+   */
+  const QuickScorer* getQuickScorer() const {
+    return quickScorer.get();
+  }
+
+
+  /**
+     @return quantized layout, if eligible and not bitvector-walked, else null.
+   */
+  const BinnedForest* getBinnedForest() const {
+    return binnedForest.get();
   }
 
   
@@ -99,6 +139,16 @@ class Forest {
     return decTree[tIdx].getNode();
   }
 
+
+  const DecTree& getTree(unsigned int tIdx) const {
+    return decTree[tIdx];
+  }
+
+
+  const ScoreDesc& getScoreDesc() const {
+    return scoreDesc;
+  }
+
   
   size_t getNoNode() const {
     return noNode;
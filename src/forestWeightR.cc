@@ -48,7 +48,7 @@ RcppExport SEXP forestWeightRcpp(const SEXP sTrain,
     Rcout << "Entering weighting" << endl;
 
   List lPredict(sPredict);
-  NumericMatrix summary(ForestWeightR::forestWeight(List(sTrain), List(sSampler), as<NumericMatrix>(lPredict["indices"]), List(sArgs)));
+  List summary(ForestWeightR::forestWeight(List(sTrain), List(sSampler), as<NumericMatrix>(lPredict["indices"]), List(sArgs)));
 
   if (verbose)
     Rcout << "Weighting completed" << endl;
@@ -58,22 +58,79 @@ RcppExport SEXP forestWeightRcpp(const SEXP sTrain,
 }
 
 
-NumericMatrix ForestWeightR::forestWeight(const List& lTrain,
-					  const List& lSampler,
-					  const NumericMatrix& indices,
-					  const List& lArgs) {
+RcppExport SEXP weightHandleRcpp(const SEXP sTrain,
+				 const SEXP sSampler) {
   BEGIN_RCPP
 
+  return XPtr<WeightHandle>(new WeightHandle(List(sTrain), List(sSampler)), true);
+
+  END_RCPP
+}
+
+
+RcppExport SEXP weightRowsRcpp(const SEXP sHandle,
+			       const SEXP sPredict,
+			       const SEXP sArgs) {
+  BEGIN_RCPP
+
+  XPtr<WeightHandle> handle(sHandle);
+  List lPredict(sPredict);
+  return handle->weigh(as<NumericMatrix>(lPredict["indices"]), List(sArgs));
+
+  END_RCPP
+}
+
+
+WeightHandle::WeightHandle(const List& lTrain_,
+			   const List& lSampler_) :
+  lTrain(lTrain_),
+  lSampler(lSampler_),
+  samplerBridge(make_unique<SamplerBridge>(SamplerR::unwrapGeneric(lSampler))) {
+  ForestBridge::init(as<IntegerVector>(lTrain[TrainR::strPredMap]).length());
+  forestBridge = make_unique<ForestBridge>(ForestR::unwrap(lTrain, *samplerBridge));
+  ForestBridge::deInit();
+}
+
+
+WeightHandle::~WeightHandle() = default;
+
+
+List WeightHandle::weigh(const NumericMatrix& indices,
+			 const List& lArgs) {
   PredictBridge::initOmp(as<unsigned>(lArgs[PredictR::strNThread]));
   ForestBridge::init(as<IntegerVector>(lTrain[TrainR::strPredMap]).length());
-  SamplerBridge samplerBridge(SamplerR::unwrapGeneric(lSampler));
-  return transpose(NumericMatrix(SamplerR::countObservations(lSampler),
-				 indices.nrow(),
-				 PredictBridge::forestWeight(ForestR::unwrap(lTrain, samplerBridge),
-							     samplerBridge,
-							     indices.begin(),
-							     indices.nrow()).begin()));
+  vector<size_t> rowHeight;
+  vector<size_t> obsIdx;
+  vector<double> weight;
+  PredictBridge::forestWeight(*forestBridge,
+			      *samplerBridge,
+			      indices.begin(),
+			      indices.nrow(),
+			      rowHeight,
+			      obsIdx,
+			      weight);
   ForestBridge::deInit();
-  
+
+  // Zero-based, compressed-row form:  row pointers lead with zero.
+  NumericVector rowPtr(rowHeight.size() + 1);
+  copy(rowHeight.begin(), rowHeight.end(), rowPtr.begin() + 1);
+  List forestWeight = List::create(_["rowPtr"] = rowPtr,
+				   _["obsIdx"] = NumericVector(obsIdx.begin(), obsIdx.end()),
+				   _["weight"] = NumericVector(weight.begin(), weight.end()),
+				   _["dim"] = NumericVector::create(indices.nrow(), SamplerR::countObservations(lSampler))
+				   );
+  forestWeight.attr("class") = "ForestWeight";
+  return forestWeight;
+}
+
+
+List ForestWeightR::forestWeight(const List& lTrain,
+				 const List& lSampler,
+				 const NumericMatrix& indices,
+				 const List& lArgs) {
+  BEGIN_RCPP
+
+  return WeightHandle(lTrain, lSampler).weigh(indices, lArgs);
+
   END_RCPP
 }
@@ -29,6 +29,9 @@
 #include <Rcpp.h>
 using namespace Rcpp;
 
+#include <memory>
+using namespace std;
+
 /**
    @brief Entry from R.
  */
@@ -38,16 +41,72 @@ RcppExport SEXP forestWeightRcpp(const SEXP sTrain,
 				 const SEXP sArgs);
 
 
+/**
+   @brief Prepares a trained forest for repeated weighting.
+
+   @param sTrain contains the trained object.
+
+   @param sSampler contains the sampler.
+
+   @return external pointer to prepared handle.
+ */
+RcppExport SEXP weightHandleRcpp(const SEXP sTrain,
+				 const SEXP sSampler);
+
+
+/**
+   @brief Weighs prediction indices against a prepared handle.
+
+   @param sHandle is the prepared handle.
+
+   @param sPredict contains the final indices of prediction.
+
+   @return weights, as returned by forestWeightRcpp.
+ */
+RcppExport SEXP weightRowsRcpp(const SEXP sHandle,
+			       const SEXP sPredict,
+			       const SEXP sArgs);
+
+
+/**
+   @brief Retains an unwrapped forest and sampler, so that the per-node
+   sample lists cached by the first weighting are reused by subsequent
+   ones.
+ */
+struct WeightHandle {
+  const List lTrain; ///< Protects the state viewed by the bridges.
+  const List lSampler; ///< "
+  unique_ptr<struct SamplerBridge> samplerBridge;
+  unique_ptr<struct ForestBridge> forestBridge;
+
+  WeightHandle(const List& lTrain_,
+	       const List& lSampler_);
+
+
+  ~WeightHandle();
+
+
+  /**
+     @return forest weights of the prediction indices.
+   */
+  List weigh(const NumericMatrix& indices,
+	     const List& lArgs);
+};
+
+
 struct ForestWeightR {
   /**
      @brief Meinshausen's forest weights for multiple predictions.
 
-     @return matrix with rows of per-observation weights.
+     Weights are mostly zero, so are returned in compressed sparse-row
+     form.
+
+     @return list of row pointers, observation indices and weights.
    */
-  static NumericMatrix forestWeight(const List& lTrain,
-				    const List& lSampler,
-				    const NumericMatrix& indices,
-				    const List& lArgs);
+  static List forestWeight(const List& lTrain,
+			   const List& lSampler,
+			   const NumericMatrix& indices,
+			   const List& lArgs);
 };
 
 #endif
@@ -17,6 +17,8 @@
 #include "dectree.h"
 #include "forestbridge.h"
 #include "forestrw.h"
+#include "codegen.h"
+#include "forestfile.h"
 #include "typeparam.h"
 #include "bv.h"
 
@@ -82,6 +84,21 @@ Forest* ForestBridge::getForest() const {
 }
 
 
+string ForestBridge::codeGen(unsigned int nPredNum,
+			     const vector<unsigned int>& facCard) const {
+  return CodeGen(forest.get(), nPredNum, facCard).emit();
+}
+
+
+void ForestBridge::writeFile(const string& path,
+			     unsigned int nPredNum,
+			     const vector<unsigned int>& facCard,
+			     unsigned int nCtg) const {
+  forest->initWalkers(PredictFrame(nPredNum, facCard.size()));
+  ForestFile::write(forest->getFlatForest(), forest->getScoreDesc(), path, nPredNum, facCard, nCtg);
+}
+
+
 void ForestBridge::dump(vector<vector<unsigned int> >& predTree,
                         vector<vector<double> >& splitTree,
                         vector<vector<size_t> >& lhDelTree,
@@ -20,6 +20,7 @@
 #include <vector>
 #include <memory>
 #include <complex>
+#include <string>
 
 using namespace std;
 
@@ -108,6 +109,32 @@ struct ForestBridge {
   const vector<size_t>& getFacExtents() const;
 
 
+  /**
+     @brief Emits the forest as a standalone C++ translation unit.
+
+     @param nPredNum is the number of numeric predictors.
+
+     @param facCard holds the training cardinality of each factor.
+
+     @return text of the translation unit.
+   */
+  string codeGen(unsigned int nPredNum,
+		 const vector<unsigned int>& facCard) const;
+
+
+  /**
+     @brief Writes the forest's scoring state as a front end-neutral file.
+
+     @param facCard are the training cardinalities of the factors.
+
+     @param nCtg is the response cardinality, if categorical, else zero.
+   */
+  void writeFile(const string& path,
+		 unsigned int nPredNum,
+		 const vector<unsigned int>& facCard,
+		 unsigned int nCtg) const;
+
+
   /**
      @brief Dumps the forest into per-tree vectors.
    */
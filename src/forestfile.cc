@@ -0,0 +1,263 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file forestfile.cc
+
+   @brief Methods for writing and viewing forest images.
+
+   @author Mark Seligman
+ */
+
+#include "forestfile.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+
+static_assert(sizeof(ForestFile::Header) % 8 == 0, "Forest file header must pad to whole words");
+
+
+static constexpr char fileMagic[4] = {'S', 'G', 'B', 'F'};
+
+
+/**
+   @return true iff the host stores integers least-significant byte first.
+ */
+static bool littleEndian() {
+  uint32_t probe = ForestFile::byteOrder;
+  unsigned char low;
+  memcpy(&low, &probe, 1);
+  return low == 0x04;
+}
+
+
+/**
+   @brief Computes the size of each section, in bytes.
+ */
+static void sectionBytes(const ForestFile::Header& header,
+			 uint64_t bytes[]) {
+  uint64_t nTree = header.nTree;
+  uint64_t nNode = header.nNode;
+  uint64_t nSlot = header.nSlot;
+  uint64_t nWide = header.nCut == 0 ? nNode : 0;
+  bytes[ForestFile::treeOffset] = (nTree + 1) * sizeof(uint64_t);
+  bytes[ForestFile::treeNumeric] = nTree * sizeof(unsigned char);
+  bytes[ForestFile::predPos] = nWide * sizeof(PredictorT);
+  bytes[ForestFile::split] = nWide * sizeof(double);
+  bytes[ForestFile::delFalse] = nWide * sizeof(IndexT);
+  bytes[ForestFile::score] = nNode * sizeof(double);
+  bytes[ForestFile::nodeIdx] = nNode * sizeof(IndexT);
+  bytes[ForestFile::facSplit] = nSlot * sizeof(BVSlotT);
+  bytes[ForestFile::facObserved] = nSlot * sizeof(BVSlotT);
+  bytes[ForestFile::facCard] = header.nPredFac * sizeof(uint32_t);
+  bytes[ForestFile::compact] = (nNode - nWide) * sizeof(FlatForest::CompactNode);
+  bytes[ForestFile::cutVal] = header.nCut * sizeof(double);
+}
+
+
+static uint64_t alignUp(uint64_t offset) {
+  return (offset + ForestFile::align - 1) & ~(ForestFile::align - 1);
+}
+
+
+const ForestFile::Header* ForestFile::checkHeader(const void* base,
+						 size_t length) {
+  if (!littleEndian())
+    throw runtime_error("Forest images require a little-endian host");
+  if (reinterpret_cast<uintptr_t>(base) % align != 0)
+    throw runtime_error("Forest image misaligned in memory");
+  if (length < sizeof(Header))
+    throw runtime_error("Forest image truncated");
+
+  const Header* header = static_cast<const Header*>(base);
+  if (memcmp(header->magic, fileMagic, 4) != 0)
+    throw runtime_error("Not a forest image");
+  if (header->version != version)
+    throw runtime_error("Unsupported forest image version");
+  if (header->byteOrder != byteOrder)
+    throw runtime_error("Forest image written under foreign byte order");
+  if (header->length != length)
+    throw runtime_error("Forest image truncated");
+  if (memchr(header->scorer, 0, sizeof(header->scorer)) == nullptr)
+    throw runtime_error("Forest image scorer unterminated");
+
+  // Guards the section sizes against overflow.
+  if (header->nTree == 0 || header->nTree > length || header->nNode > length || header->nSlot > length || header->nCut > length)
+    throw runtime_error("Forest image counts inconsistent");
+
+  uint64_t bytes[nSection];
+  sectionBytes(*header, bytes);
+  for (unsigned int section = 0; section < nSection; section++) {
+    uint64_t offset = header->offset[section];
+    if (offset % align != 0 || offset < sizeof(Header) || offset > length || bytes[section] > length - offset)
+      throw runtime_error("Forest image section out of bounds");
+  }
+
+  return header;
+}
+
+
+void ForestFile::checkNodes(const FlatForest::Arrays& arrays,
+			    PredictorT nPredNum,
+			    PredictorT nPredFac,
+			    const uint32_t facCard[],
+			    CtgT nCtg) {
+  uint64_t nBit = arrays.nSlot * BV::slotElts;
+  if (arrays.treeOffset[0] != 0 || arrays.treeOffset[arrays.nTree] != arrays.nNode)
+    throw runtime_error("Forest image node count inconsistent");
+
+  for (unsigned int tIdx = 0; tIdx < arrays.nTree; tIdx++) {
+    uint64_t treeStart = arrays.treeOffset[tIdx];
+    uint64_t treeEnd = arrays.treeOffset[tIdx + 1];
+    if (treeEnd <= treeStart || treeEnd > arrays.nNode)
+      throw runtime_error("Forest image tree extents inconsistent");
+    bool numeric = arrays.treeNumeric[tIdx] != 0;
+    for (uint64_t flatIdx = treeStart; flatIdx < treeEnd; flatIdx++) {
+      IndexT delFalse;
+      bool isFactor;
+      PredictorT pos;
+      double thresh; // Bit offset, if factor, else cut index if packed.
+      if (arrays.compact != nullptr) {
+	const FlatForest::CompactNode& node = arrays.compact[flatIdx];
+	delFalse = node.delFalse;
+	isFactor = (node.predPos & FlatForest::compactFac) != 0;
+	pos = node.predPos & FlatForest::compactPosMask;
+	thresh = node.thresh;
+      }
+      else {
+	delFalse = arrays.delFalse[flatIdx];
+	isFactor = (arrays.predPos[flatIdx] & FlatForest::facBit) != 0;
+	pos = arrays.predPos[flatIdx] & FlatForest::posMask;
+	thresh = isFactor ? arrays.split[flatIdx] : 0;
+      }
+      // Batched walks read the predictor and cut of terminals, as well.
+      if (numeric && (isFactor || pos >= nPredNum))
+	throw runtime_error("Forest image numeric tree malformed");
+      if (arrays.compact != nullptr && !isFactor && thresh >= arrays.nCut)
+	throw runtime_error("Forest image cut out of bounds");
+      if (delFalse == 0) {
+	// Truncated plurality scores index the census.
+	if (nCtg > 0 && !(arrays.score[flatIdx] >= 0 && arrays.score[flatIdx] < nCtg))
+	  throw runtime_error("Forest image category out of bounds");
+	continue;
+      }
+      // Both branches must lie strictly ahead, within the tree.
+      if (delFalse < 2 || delFalse >= treeEnd - flatIdx)
+	throw runtime_error("Forest image branch out of bounds");
+      if (isFactor) {
+	// Levels range over the cardinality, plus the proxy.
+	if (pos >= nPredFac || !(thresh >= 0) || thresh != floor(thresh) || thresh + facCard[pos] >= nBit)
+	  throw runtime_error("Forest image factor split out of bounds");
+      }
+      else if (pos >= nPredNum) {
+	throw runtime_error("Forest image predictor out of bounds");
+      }
+    }
+  }
+}
+
+
+ForestFile::ForestFile(const void* base,
+		       size_t length) :
+  header(checkHeader(base, length)),
+  scoreDesc(make_tuple(header->nu, header->baseScore, string(header->scorer))) {
+  const unsigned char* image = static_cast<const unsigned char*>(base);
+  auto at = [&](Section section) {
+    return image + header->offset[section];
+  };
+  FlatForest::Arrays arrays;
+  arrays.nTree = header->nTree;
+  arrays.nNode = header->nNode;
+  arrays.nSlot = header->nSlot;
+  arrays.treeOffset = reinterpret_cast<const uint64_t*>(at(treeOffset));
+  arrays.treeNumeric = at(treeNumeric);
+  bool packed = header->nCut > 0;
+  arrays.predPos = packed ? nullptr : reinterpret_cast<const PredictorT*>(at(predPos));
+  arrays.split = packed ? nullptr : reinterpret_cast<const double*>(at(split));
+  arrays.delFalse = packed ? nullptr : reinterpret_cast<const IndexT*>(at(delFalse));
+  arrays.score = reinterpret_cast<const double*>(at(score));
+  arrays.nodeIdx = reinterpret_cast<const IndexT*>(at(nodeIdx));
+  arrays.facSplit = reinterpret_cast<const BVSlotT*>(at(facSplit));
+  arrays.facObserved = reinterpret_cast<const BVSlotT*>(at(facObserved));
+  arrays.compact = packed ? reinterpret_cast<const FlatForest::CompactNode*>(at(compact)) : nullptr;
+  arrays.nCut = header->nCut;
+  arrays.cutVal = packed ? reinterpret_cast<const double*>(at(cutVal)) : nullptr;
+  bool plurality = scoreDesc.scorer == "plurality";
+  if (plurality && header->nCtg == 0)
+    throw runtime_error("Forest image plurality scorer lacks categories");
+  checkNodes(arrays, header->nPredNum, header->nPredFac, reinterpret_cast<const uint32_t*>(at(facCard)), plurality ? header->nCtg : 0);
+
+  flatForest = make_unique<FlatForest>(arrays, header->nPredNum);
+}
+
+
+ForestFile::~ForestFile() = default;
+
+
+vector<PredictorT> ForestFile::getFacCard() const {
+  const uint32_t* card = reinterpret_cast<const uint32_t*>(reinterpret_cast<const unsigned char*>(header) + header->offset[facCard]);
+  return vector<PredictorT>(card, card + header->nPredFac);
+}
+
+
+void ForestFile::write(const FlatForest* flatForest,
+		       const ScoreDesc& scoreDesc,
+		       const string& path,
+		       PredictorT nPredNum,
+		       const vector<PredictorT>& facCard,
+		       CtgT nCtg) {
+  if (!littleEndian())
+    throw runtime_error("Forest images require a little-endian host");
+  Header header{};
+  if (scoreDesc.scorer.size() >= sizeof(header.scorer))
+    throw runtime_error("Scorer name too long for forest image");
+
+  FlatForest::Arrays arrays = flatForest->getArrays();
+  vector<uint32_t> card(facCard.begin(), facCard.end());
+  memcpy(header.magic, fileMagic, 4);
+  header.version = version;
+  header.byteOrder = byteOrder;
+  header.nPredNum = nPredNum;
+  header.nPredFac = card.size();
+  header.nCtg = nCtg;
+  header.nTree = arrays.nTree;
+  header.nNode = arrays.nNode;
+  header.nSlot = arrays.nSlot;
+  header.nCut = arrays.compact != nullptr ? arrays.nCut : 0;
+  header.nu = scoreDesc.nu;
+  header.baseScore = scoreDesc.baseScore;
+  memcpy(header.scorer, scoreDesc.scorer.data(), scoreDesc.scorer.size());
+
+  const void* data[nSection] = {arrays.treeOffset, arrays.treeNumeric, arrays.predPos, arrays.split, arrays.delFalse, arrays.score, arrays.nodeIdx, arrays.facSplit, arrays.facObserved, card.data(), arrays.compact, arrays.cutVal};
+  uint64_t bytes[nSection];
+  sectionBytes(header, bytes);
+  uint64_t offset = alignUp(sizeof(Header));
+  for (unsigned int section = 0; section < nSection; section++) {
+    header.offset[section] = offset;
+    offset = alignUp(offset + bytes[section]);
+  }
+  header.length = offset;
+
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out)
+    throw runtime_error("Cannot open forest file " + path);
+  const char pad[align] = {};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  uint64_t pos = sizeof(Header);
+  for (unsigned int section = 0; section < nSection; section++) {
+    out.write(pad, header.offset[section] - pos);
+    out.write(static_cast<const char*>(data[section]), bytes[section]);
+    pos = header.offset[section] + bytes[section];
+  }
+  out.write(pad, header.length - pos);
+
+  if (!out.flush())
+    throw runtime_error("Error writing forest file " + path);
+}
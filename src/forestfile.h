@@ -0,0 +1,178 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file forestfile.h
+
+   @brief Front end-neutral, memory-mappable image of a trained forest.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_FORESTFILE_H
+#define FOREST_FORESTFILE_H
+
+#include "flatforest.h"
+#include "scoredesc.h"
+#include "typeparam.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+/**
+   @brief Writes the flattened prediction layout of a forest as a single
+   binary image, and views such an image in place.
+
+   The image is little-endian and consists of a fixed-size header
+   followed by the flattened arrays, each starting on a 64-byte
+   boundary at the offset recorded in the header.  As the arrays are
+   stored in the form walked by FlatForest, an image mapped into memory
+   is used directly, with neither parsing nor copying, and may be shared
+   among processes through the page cache.  Packed nodes are stored in
+   place of the wide node arrays, whose sections are then empty.  The
+   training cardinality of each factor is recorded, so that unseen
+   levels can be bounded.
+
+   Node contents are validated when an image is viewed, so that a
+   malformed image is rejected rather than walked out of bounds.
+   Under plurality scoring, terminal scores index the categories, so
+   must lie within the recorded cardinality.
+ */
+class ForestFile {
+public:
+  static constexpr uint32_t version = 3;
+  static constexpr uint32_t byteOrder = 0x01020304; ///< Endianness check.
+  static constexpr size_t align = 64; ///< Section alignment.
+
+  /**
+     @brief Arrays of the flattened layout, in file order.
+   */
+  enum Section { treeOffset, treeNumeric, predPos, split, delFalse, score, nodeIdx, facSplit, facObserved, facCard, compact, cutVal, nSection };
+
+
+  /**
+     @brief Fixed-width preamble, at offset zero.
+   */
+  struct Header {
+    char magic[4]; ///< "SGBF".
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nPredNum; ///< # numeric predictors.
+    uint32_t nPredFac; ///< # factor-valued predictors.
+    uint32_t nCtg; ///< Response cardinality, if categorical, else zero.
+    uint32_t nTree;
+    uint32_t reserved;
+    uint64_t nNode; ///< # nodes over all trees.
+    uint64_t nSlot; ///< # factor bit slots.
+    uint64_t nCut; ///< # distinct numeric cuts if nodes packed, else zero.
+    double nu;
+    double baseScore;
+    char scorer[16]; ///< Null-padded scorer name.
+    uint64_t offset[nSection]; ///< Byte offset of each array.
+    uint64_t length; ///< Total image size, in bytes.
+  };
+
+private:
+  const Header* header;
+  unique_ptr<FlatForest> flatForest; ///< Views the image's arrays.
+  const ScoreDesc scoreDesc;
+
+
+  /**
+     @brief Validates the header against the extent of the image.
+
+     @return header, if valid.
+
+     @throw runtime_error if malformed.
+   */
+  static const Header* checkHeader(const void* base,
+				   size_t length);
+
+
+  /**
+     @brief Validates tree extents, branch offsets, predictor positions,
+     cut indices and factor bit ranges, so that any walk remains within
+     the image.
+
+     @param facCard is the training cardinality of each factor.
+
+     @param nCtg is the response cardinality if scoring by plurality,
+     else zero.
+
+     @throw runtime_error if any node is malformed.
+   */
+  static void checkNodes(const FlatForest::Arrays& arrays,
+			 PredictorT nPredNum,
+			 PredictorT nPredFac,
+			 const uint32_t facCard[],
+			 CtgT nCtg);
+
+public:
+
+  /**
+     @brief Views an image held in memory, typically by mapping.
+
+     Caller must keep the image live for the lifetime of this object.
+
+     @throw runtime_error if the image is malformed.
+   */
+  ForestFile(const void* base,
+	     size_t length);
+
+
+  ~ForestFile();
+
+
+  const FlatForest* getFlatForest() const {
+    return flatForest.get();
+  }
+
+
+  const ScoreDesc& getScoreDesc() const {
+    return scoreDesc;
+  }
+
+
+  PredictorT getNPredNum() const {
+    return header->nPredNum;
+  }
+
+
+  PredictorT getNPredFac() const {
+    return header->nPredFac;
+  }
+
+
+  CtgT getNCtg() const {
+    return header->nCtg;
+  }
+
+
+  /**
+     @return training cardinality of each factor, in core order.
+   */
+  vector<PredictorT> getFacCard() const;
+
+
+  /**
+     @brief Writes the image of a flattened forest.
+
+     @param facCard holds the training cardinality of each factor.
+
+     @throw runtime_error if the file cannot be written.
+   */
+  static void write(const FlatForest* flatForest,
+		    const ScoreDesc& scoreDesc,
+		    const string& path,
+		    PredictorT nPredNum,
+		    const vector<PredictorT>& facCard,
+		    CtgT nCtg);
+};
+
+#endif
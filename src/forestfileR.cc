@@ -0,0 +1,50 @@
+// Copyright (C)  2012-2023  Mark Seligman
+//
+// This file is part of RboristBase.
+//
+// RboristBase is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// RboristBase is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with RboristBase.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+   @file forestfileR.cc
+
+   @brief C++ interface to R entry for writing forest files.
+
+   @author Mark Seligman
+ */
+
+#include "forestfileR.h"
+#include "forestR.h"
+#include "forestbridge.h"
+#include "trainR.h"
+#include "signatureR.h"
+
+
+RcppExport SEXP writeForestFile(SEXP sTrain,
+				SEXP sNCtg,
+				SEXP sPath) {
+  BEGIN_RCPP
+
+  List lTrain(sTrain);
+  IntegerVector predMap(as<IntegerVector>(lTrain[TrainR::strPredMap]));
+  vector<unsigned int> facCard = SignatureR::getCardinality(lTrain);
+  unsigned int nCtg = as<unsigned int>(sNCtg);
+  ForestBridge::init(predMap.length());
+  ForestBridge forestBridge(ForestR::unwrap(lTrain, nCtg > 0));
+  forestBridge.writeFile(as<string>(sPath), predMap.length() - facCard.size(), facCard, nCtg);
+  ForestBridge::deInit();
+
+  return R_NilValue;
+
+  END_RCPP
+}
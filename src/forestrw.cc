@@ -85,59 +85,30 @@ void ForestRW::dump(const Forest* forest,
 
 
 Leaf ForestRW::unpackLeaf(const SamplerBridge& samplerBridge,
-			   const double extent_[],
-			   const double index_[]) {
-  vector<vector<size_t>> extent = unpackExtent(samplerBridge, extent_);
-  vector<vector<vector<size_t>>> index = unpackIndex(samplerBridge, extent, index_);
-  return Leaf(samplerBridge.getSampler(), std::move(extent), std::move(index));
-}
-
-
-vector<vector<size_t>> ForestRW::unpackExtent(const SamplerBridge& samplerBridge,
-					      const double extentNum[]) {
-  if (extentNum == nullptr) {
-    return vector<vector<size_t>>(0);
-  }
-
-  Sampler* sampler = samplerBridge.getSampler();
-  unsigned int nTree = sampler->getNRep();
-  vector<vector<size_t>> unpacked(nTree);
-  size_t idx = 0;
-  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
-    size_t extentTree = 0;
-    while (extentTree < sampler->getBagCount(tIdx)) {
-      size_t extentLeaf = extentNum[idx++];
-      unpacked[tIdx].push_back(extentLeaf);
-      extentTree += extentLeaf;
-    }
-  }
-  return unpacked;
-}
-
-
-vector<vector<vector<size_t>>> ForestRW::unpackIndex(const SamplerBridge& samplerBridge,
-						     const vector<vector<size_t>>& extent,
-						     const double numVal[]) {
-  if (extent.empty() || numVal == nullptr)
-    return vector<vector<vector<size_t>>>(0);
-
+			   const double extent[],
+			   const double index[]) {
+  vector<size_t> treeHeight;
+  vector<size_t> leafHeight;
+  vector<IndexT> sampleIdx;
   const Sampler* sampler = samplerBridge.getSampler();
-  unsigned int nTree = sampler->getNRep();
-  vector<vector<vector<size_t>>> unpacked(nTree);
-
-  size_t idx = 0;
-  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
-    unpacked[tIdx] = vector<vector<size_t>>(extent[tIdx].size());
-    for (size_t leafIdx = 0; leafIdx < unpacked[tIdx].size(); leafIdx++) {
-      vector<size_t> unpackedLeaf(extent[tIdx][leafIdx]);
-      for (size_t slot = 0; slot < unpackedLeaf.size(); slot++) {
-	unpackedLeaf[slot] = numVal[idx];
-	idx++;
+  if (extent != nullptr && index != nullptr) {
+    // Extents partition each tree's bag, delimiting its leaves.
+    size_t idx = 0;
+    size_t height = 0;
+    for (unsigned int tIdx = 0; tIdx < sampler->getNRep(); tIdx++) {
+      size_t extentTree = 0;
+      while (extentTree < sampler->getBagCount(tIdx)) {
+	size_t extentLeaf = extent[idx++];
+	extentTree += extentLeaf;
+	height += extentLeaf;
+	leafHeight.push_back(height);
       }
-      unpacked[tIdx][leafIdx] = unpackedLeaf;
+      treeHeight.push_back(leafHeight.size());
     }
+    sampleIdx = vector<IndexT>(index, index + height);
   }
-  return unpacked;
+
+  return Leaf(sampler, std::move(treeHeight), std::move(leafHeight), std::move(sampleIdx));
 }
 
 
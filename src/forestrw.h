@@ -47,18 +47,16 @@ struct ForestRW {
   static vector<DecNode> unpackNodes(const complex<double> nodes[],
 				     size_t extent);
 
-  static class Leaf unpackLeaf(const struct SamplerBridge& samplerBridge,
-			       const double extent_[],
-			       const double index_[]);
-
+  /**
+     @brief Builds the flat leaf maps directly from front-end vectors.
 
-  static vector<vector<size_t>> unpackExtent(const struct SamplerBridge& samplerBridge,
-				      const double extentNum[]);
+     @param extent gives the sample count of each leaf, forest-wide.
 
-
-  static vector<vector<vector<size_t>>> unpackIndex(const struct SamplerBridge& samplerBridge,
-					     const vector<vector<size_t>>& extent,
-					     const double numVal[]);
+     @param index gives the sample indices, leaf-contiguous.
+   */
+  static class Leaf unpackLeaf(const struct SamplerBridge& samplerBridge,
+			       const double extent[],
+			       const double index[]);
 
 
   static void dump(const class Forest* forest,
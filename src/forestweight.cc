@@ -0,0 +1,129 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file forestweight.cc
+
+   @brief Methods computing sparse forest weights.
+
+   @author Mark Seligman
+ */
+
+#include "forestweight.h"
+#include "forest.h"
+#include "sampler.h"
+#include "ompthread.h"
+
+#include <algorithm>
+
+
+ForestWeight::ForestWeight(const Forest* forest,
+			   const Sampler* sampler) :
+  nObs(sampler->getNObs()),
+  sampleIdc(vector<vector<IdCount>>(forest->getNTree())),
+  nodeRange(vector<vector<IndexRange>>(forest->getNTree())),
+  nodeRecip(vector<vector<double>>(forest->getNTree())) {
+  const Leaf& leaf = forest->getLeaf();
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+#pragma omp for schedule(dynamic, 1)
+    for (OMPBound tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
+      const vector<DecNode>& decNode = forest->getNode(tIdx);
+      const vector<IdCount> idCount = sampler->unpack(tIdx);
+      vector<IndexT> leafHeight; // Accumulated sample count, per leaf.
+      vector<IndexT> sCountHeight; // Accumulated multiplicity, per leaf.
+      IndexT sCountTot = 0;
+      for (IndexT leafIdx = 0; leafIdx != leaf.getLeafCount(tIdx); leafIdx++) {
+	for (size_t pos = leaf.getLeafStart(tIdx, leafIdx); pos != leaf.getLeafEnd(tIdx, leafIdx); pos++) {
+	  const IdCount& idc = idCount[leaf.getSampleIdx(pos)];
+	  sampleIdc[tIdx].emplace_back(idc);
+	  sCountTot += idc.sCount;
+	}
+	leafHeight.push_back(sampleIdc[tIdx].size());
+	sCountHeight.push_back(sCountTot);
+      }
+
+      vector<IndexRange> leafDom = Forest::leafDominators(decNode);
+      nodeRange[tIdx] = vector<IndexRange>(decNode.size());
+      nodeRecip[tIdx] = vector<double>(decNode.size());
+      for (IndexT nodeIdx = 0; nodeIdx != decNode.size(); nodeIdx++) {
+	IndexRange leafRange = leafDom[nodeIdx];
+	IndexT leafIdx;
+	if (decNode[nodeIdx].getLeafIdx(leafIdx)) // Terminal root dominates itself.
+	  leafRange = IndexRange(leafIdx, 1);
+	if (leafRange.empty())
+	  continue;
+	IndexT leafStart = leafRange.getStart();
+	IndexT leafEnd = leafRange.getEnd();
+	IndexT idcStart = leafStart == 0 ? 0 : leafHeight[leafStart - 1];
+	nodeRange[tIdx][nodeIdx] = IndexRange(idcStart, leafHeight[leafEnd - 1] - idcStart);
+	IndexT sCount = sCountHeight[leafEnd - 1] - (leafStart == 0 ? 0 : sCountHeight[leafStart - 1]);
+	nodeRecip[tIdx][nodeIdx] = sCount == 0 ? 0.0 : 1.0 / sCount;
+      }
+    }
+  }
+}
+
+
+SparseWeight ForestWeight::weigh(IndexT noNode,
+				 size_t nPredict,
+				 const double finalIdx[]) const {
+  unsigned int nTree = sampleIdc.size();
+  vector<vector<pair<size_t, double>>> rowWeight(nPredict);
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+    vector<double> accum(nObs); // Per-thread, cleared after each row.
+    vector<size_t> touched;
+#pragma omp for schedule(dynamic, 1)
+    for (OMPBound row = 0; row < nPredict; row++) {
+      for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+	IndexT nodeIdx = finalIdx[row * nTree + tIdx];
+	if (nodeIdx == noNode) // Bagged observation.
+	  continue;
+	IndexRange range = nodeRange[tIdx][nodeIdx];
+	double recip = nodeRecip[tIdx][nodeIdx];
+	for (IndexT idx = range.getStart(); idx != range.getEnd(); idx++) {
+	  const IdCount& idc = sampleIdc[tIdx][idx];
+	  if (accum[idc.id] == 0.0)
+	    touched.push_back(idc.id);
+	  accum[idc.id] += idc.sCount * recip;
+	}
+      }
+
+      sort(touched.begin(), touched.end());
+      double weightTot = 0.0;
+      for (size_t obsIdx : touched) {
+	weightTot += accum[obsIdx];
+      }
+      double weightRecip = 1.0 / weightTot;
+      rowWeight[row].reserve(touched.size());
+      for (size_t obsIdx : touched) {
+	rowWeight[row].emplace_back(obsIdx, accum[obsIdx] * weightRecip);
+	accum[obsIdx] = 0.0;
+      }
+      touched.clear();
+    }
+  }
+
+  SparseWeight sparse;
+  size_t height = 0;
+  for (const vector<pair<size_t, double>>& rw : rowWeight) {
+    height += rw.size();
+    sparse.rowHeight.push_back(height);
+  }
+  sparse.obsIdx.reserve(height);
+  sparse.weight.reserve(height);
+  for (vector<pair<size_t, double>>& rw : rowWeight) {
+    for (const pair<size_t, double>& obsWeight : rw) {
+      sparse.obsIdx.push_back(obsWeight.first);
+      sparse.weight.push_back(obsWeight.second);
+    }
+    rw = vector<pair<size_t, double>>();
+  }
+
+  return sparse;
+}
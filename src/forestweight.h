@@ -0,0 +1,72 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file forestweight.h
+
+   @brief Sparse Meinshausen forest weights.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_FORESTWEIGHT_H
+#define FOREST_FORESTWEIGHT_H
+
+#include "typeparam.h"
+#include "idcount.h"
+
+#include <vector>
+
+
+/**
+   @brief Compressed sparse rows of per-observation weights.
+ */
+struct SparseWeight {
+  vector<size_t> rowHeight; ///< Accumulated nonzero count, per prediction.
+  vector<size_t> obsIdx; ///< Training observation, ascending within row.
+  vector<double> weight; ///< Normalized weight, parallel to obsIdx.
+};
+
+
+/**
+   @brief Caches the samples reached through each node of the forest.
+
+   The leaves dominated by a node are contiguous, so listing each tree's
+   samples in leaf order allows every node's samples to be represented
+   as a range over that list.  The cache is therefore linear in the
+   bag size.
+ */
+class ForestWeight {
+  const size_t nObs; ///< # training observations.
+  vector<vector<IdCount>> sampleIdc; ///< Samples in leaf order, per tree.
+  vector<vector<IndexRange>> nodeRange; ///< Range of samples, per node.
+  vector<vector<double>> nodeRecip; ///< Reciprocal sample count, per node.
+
+public:
+
+  /**
+     @param forest has a populated leaf.
+
+     @param sampler supplies the bagged samples.
+   */
+  ForestWeight(const class Forest* forest,
+	       const class Sampler* sampler);
+
+
+  /**
+     @brief Weighs a block of predictions, in parallel.
+
+     @param finalIdx is a block of nPredict x nTree prediction indices.
+
+     @return sparse weights, normalized by row.
+   */
+  SparseWeight weigh(IndexT noNode,
+		     size_t nPredict,
+		     const double finalIdx[]) const;
+};
+
+#endif
@@ -0,0 +1,264 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file framefile.cc
+
+   @brief Methods for writing and mapping presorted frame images.
+
+   @author Mark Seligman
+ */
+
+#include "framefile.h"
+#include "rleframe.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+static_assert(sizeof(FrameFile::Header) % 8 == 0, "Frame file header must pad to whole words");
+
+
+static constexpr char fileMagic[4] = {'S', 'G', 'B', 'R'};
+
+
+/**
+   @return true iff the host stores integers least-significant byte first.
+ */
+static bool littleEndian() {
+  uint32_t probe = FrameFile::byteOrder;
+  unsigned char low;
+  memcpy(&low, &probe, 1);
+  return low == 0x04;
+}
+
+
+/**
+   @brief Computes the size of each section, in bytes.
+ */
+static void sectionBytes(const FrameFile::Header& header,
+			 uint64_t bytes[]) {
+  bytes[FrameFile::factorTop] = header.nPred * sizeof(uint32_t);
+  bytes[FrameFile::rleHeight] = header.nPred * sizeof(uint64_t);
+  bytes[FrameFile::numHeight] = header.nPredNum * sizeof(uint64_t);
+  bytes[FrameFile::facHeight] = header.nPredFac * sizeof(uint64_t);
+  bytes[FrameFile::rle] = header.nRun * sizeof(RLEVal<szType>);
+  bytes[FrameFile::numVal] = header.nNumVal * sizeof(double);
+  bytes[FrameFile::facVal] = header.nFacVal * sizeof(uint32_t);
+  bytes[FrameFile::frontEnd] = header.nFrontEnd;
+}
+
+
+static uint64_t alignUp(uint64_t offset) {
+  return (offset + FrameFile::align - 1) & ~(FrameFile::align - 1);
+}
+
+
+FrameFile::FrameFile(const string& path_) :
+  path(path_),
+  base(nullptr),
+  length(0) {
+  if (!littleEndian())
+    throw runtime_error("Frame images require a little-endian host");
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw runtime_error("Cannot open frame file " + path);
+  struct stat st;
+  void* mapped = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    length = st.st_size;
+    mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapped == MAP_FAILED)
+    throw runtime_error("Cannot map frame file " + path);
+  base = mapped;
+#else
+  ifstream in(path, ios::binary | ios::ate);
+  if (!in)
+    throw runtime_error("Cannot open frame file " + path);
+  length = in.tellg();
+  image = vector<uint64_t>((length + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char*>(image.data()), length))
+    throw runtime_error("Cannot read frame file " + path);
+  base = image.data();
+#endif
+  header = static_cast<const Header*>(base);
+  try {
+    checkHeader();
+  }
+  catch (...) {
+#ifndef _WIN32
+    munmap(const_cast<void*>(base), length);
+#endif
+    throw;
+  }
+}
+
+
+FrameFile::~FrameFile() {
+#ifndef _WIN32
+  munmap(const_cast<void*>(base), length);
+#endif
+}
+
+
+void FrameFile::checkHeader() const {
+  if (length < sizeof(Header))
+    throw runtime_error("Frame image truncated:  " + path);
+  if (memcmp(header->magic, fileMagic, 4) != 0)
+    throw runtime_error("Not a frame image:  " + path);
+  if (header->version != version)
+    throw runtime_error("Unsupported frame image version:  " + path);
+  if (header->byteOrder != byteOrder)
+    throw runtime_error("Frame image written under foreign byte order:  " + path);
+  if (header->unitSize != sizeof(RLEVal<szType>))
+    throw runtime_error("Frame image packing unit mismatch:  " + path);
+  if (header->nPred == 0 || header->nPredNum + header->nPredFac != header->nPred)
+    throw runtime_error("Frame image predictor counts inconsistent:  " + path);
+  if (header->length > length)
+    throw runtime_error("Frame image truncated:  " + path);
+
+  uint64_t bytes[nSection];
+  sectionBytes(*header, bytes);
+  for (unsigned int section = 0; section < nSection; section++) {
+    if (header->offset[section] % align != 0 || header->offset[section] + bytes[section] > header->length)
+      throw runtime_error("Frame image section out of bounds:  " + path);
+  }
+
+  const uint32_t* top = at<uint32_t>(factorTop);
+  if (static_cast<uint32_t>(count(top, top + header->nPred, 0)) != header->nPredNum)
+    throw runtime_error("Frame image predictor types inconsistent:  " + path);
+
+  // Heights must be monotone and bounded by their arrays.
+  auto checkHeight = [&](Section section, size_t count, uint64_t bound) {
+    const uint64_t* height = at<uint64_t>(section);
+    uint64_t prev = 0;
+    for (size_t idx = 0; idx < count; idx++) {
+      if (height[idx] < prev || height[idx] > bound)
+	throw runtime_error("Frame image heights inconsistent:  " + path);
+      prev = height[idx];
+    }
+  };
+  checkHeight(rleHeight, header->nPred, header->nRun);
+  checkHeight(numHeight, header->nPredNum, header->nNumVal);
+  checkHeight(facHeight, header->nPredFac, header->nFacVal);
+
+  // Runs must lie within the rows, together spanning them, and must
+  // index their own predictor's ranked values.
+  const uint64_t* runHeight = at<uint64_t>(rleHeight);
+  const uint64_t* numTop = at<uint64_t>(numHeight);
+  const uint64_t* facTop = at<uint64_t>(facHeight);
+  const RLEVal<szType>* run = getRLE();
+  uint64_t runStart = 0;
+  uint64_t numStart = 0;
+  uint64_t facStart = 0;
+  unsigned int numIdx = 0;
+  unsigned int facIdx = 0;
+  for (unsigned int predIdx = 0; predIdx < header->nPred; predIdx++) {
+    uint64_t nRanked;
+    if (top[predIdx] == 0) {
+      nRanked = numTop[numIdx] - numStart;
+      numStart = numTop[numIdx++];
+    }
+    else {
+      nRanked = facTop[facIdx] - facStart;
+      facStart = facTop[facIdx++];
+    }
+    uint64_t rowCount = 0;
+    for (uint64_t runIdx = runStart; runIdx < runHeight[predIdx]; runIdx++) {
+      const RLEVal<szType>& rle = run[runIdx];
+      if (rle.extent == 0 || rle.extent > header->nObs || rle.row > header->nObs - rle.extent || rle.val >= nRanked)
+	throw runtime_error("Frame image runs out of bounds:  " + path);
+      rowCount += rle.extent;
+      if (rowCount > header->nObs)
+	break;
+    }
+    if (rowCount != header->nObs)
+      throw runtime_error("Frame image runs do not span the rows:  " + path);
+    runStart = runHeight[predIdx];
+  }
+}
+
+
+void FrameFile::write(const RLEFrame* rleFrame,
+		      const vector<unsigned char>& frontEnd,
+		      const string& path) {
+  if (!littleEndian())
+    throw runtime_error("Frame images require a little-endian host");
+  if (rleFrame->denseNum != nullptr)
+    throw runtime_error("Dense frames are not presorted");
+
+  vector<uint32_t> top(rleFrame->factorTop.begin(), rleFrame->factorTop.end());
+  vector<uint64_t> rleTot, numTot, facTot;
+  vector<RLEVal<szType>> rleOut;
+  vector<double> numOut;
+  vector<uint32_t> facOut;
+  for (auto rlePred : rleFrame->rlePred) {
+    rleOut.insert(rleOut.end(), rlePred.begin(), rlePred.end());
+    rleTot.push_back(rleOut.size());
+  }
+  for (auto numPred : rleFrame->numRanked) {
+    numOut.insert(numOut.end(), numPred.begin(), numPred.end());
+    numTot.push_back(numOut.size());
+  }
+  for (auto facPred : rleFrame->facRanked) {
+    facOut.insert(facOut.end(), facPred.begin(), facPred.end());
+    facTot.push_back(facOut.size());
+  }
+
+  Header header{};
+  memcpy(header.magic, fileMagic, 4);
+  header.version = version;
+  header.byteOrder = byteOrder;
+  header.unitSize = sizeof(RLEVal<szType>);
+  header.nPred = top.size();
+  header.nPredNum = numTot.size();
+  header.nPredFac = facTot.size();
+  header.nObs = rleFrame->nObs;
+  header.nRun = rleOut.size();
+  header.nNumVal = numOut.size();
+  header.nFacVal = facOut.size();
+  header.nFrontEnd = frontEnd.size();
+
+  const void* data[nSection] = {top.data(), rleTot.data(), numTot.data(), facTot.data(), rleOut.data(), numOut.data(), facOut.data(), frontEnd.data()};
+  uint64_t bytes[nSection];
+  sectionBytes(header, bytes);
+  uint64_t offset = alignUp(sizeof(Header));
+  for (unsigned int section = 0; section < nSection; section++) {
+    header.offset[section] = offset;
+    offset = alignUp(offset + bytes[section]);
+  }
+  header.length = offset;
+
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out)
+    throw runtime_error("Cannot open frame file " + path);
+  const char pad[align] = {};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  uint64_t pos = sizeof(Header);
+  for (unsigned int section = 0; section < nSection; section++) {
+    out.write(pad, header.offset[section] - pos);
+    out.write(static_cast<const char*>(data[section]), bytes[section]);
+    pos = header.offset[section] + bytes[section];
+  }
+  out.write(pad, header.length - pos);
+
+  if (!out.flush())
+    throw runtime_error("Error writing frame file " + path);
+}
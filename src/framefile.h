@@ -0,0 +1,180 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file framefile.h
+
+   @brief Memory-mappable image of a presorted frame.
+
+   @author Mark Seligman
+ */
+
+#ifndef DEFRAME_FRAMEFILE_H
+#define DEFRAME_FRAMEFILE_H
+
+#include "rlecresc.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Writes a presorted frame as a single binary image, and maps
+   such an image for viewing in place.
+
+   The image is little-endian and consists of a fixed-size header
+   followed by the frame's arrays, each starting on a 64-byte boundary
+   at the offset recorded in the header.  Runs are stored in the packed
+   form read by RLEFrame, so that a mapped image is trained upon
+   without copying and is shared among processes through the page
+   cache.  An opaque block of front-end state, such as the signature,
+   is carried alongside.
+ */
+class FrameFile {
+public:
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byteOrder = 0x01020304; ///< Endianness check.
+  static constexpr size_t align = 64; ///< Section alignment.
+
+  /**
+     @brief Arrays of the image, in file order.
+   */
+  enum Section { factorTop, rleHeight, numHeight, facHeight, rle, numVal, facVal, frontEnd, nSection };
+
+
+  /**
+     @brief Fixed-width preamble, at offset zero.
+   */
+  struct Header {
+    char magic[4]; ///< "SGBR".
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t unitSize; ///< Size of a packed run.
+    uint32_t nPred;
+    uint32_t nPredNum; ///< # numeric predictors.
+    uint32_t nPredFac; ///< # factor-valued predictors.
+    uint32_t reserved;
+    uint64_t nObs;
+    uint64_t nRun; ///< # runs over all predictors.
+    uint64_t nNumVal; ///< # distinct numeric values over all predictors.
+    uint64_t nFacVal; ///< # distinct factor values over all predictors.
+    uint64_t nFrontEnd; ///< # bytes of front-end state.
+    uint64_t offset[nSection]; ///< Byte offset of each array.
+    uint64_t length; ///< Total image size, in bytes.
+  };
+
+private:
+  const string path;
+  const void* base; ///< Mapped image.
+  size_t length;
+  vector<uint64_t> image; ///< Image read in full, where mapping unavailable.
+  const Header* header;
+
+
+  /**
+     @brief Validates the header against the extent of the image.
+
+     @throw runtime_error if malformed.
+   */
+  void checkHeader() const;
+
+
+  template<typename eltType>
+  const eltType* at(Section section) const {
+    return reinterpret_cast<const eltType*>(static_cast<const unsigned char*>(base) + header->offset[section]);
+  }
+
+
+  /**
+     @return cumulative heights of a section, as read by RLEFrame.
+   */
+  vector<size_t> getHeight(Section section,
+			   size_t count) const {
+    const uint64_t* height = at<uint64_t>(section);
+    return vector<size_t>(height, height + count);
+  }
+
+public:
+
+  /**
+     @brief Maps an image read-only.
+
+     @throw runtime_error if the file cannot be mapped or is malformed.
+   */
+  FrameFile(const string& path_);
+
+
+  ~FrameFile();
+
+
+  size_t getNObs() const {
+    return header->nObs;
+  }
+
+
+  vector<unsigned int> getFactorTop() const {
+    const uint32_t* top = at<uint32_t>(factorTop);
+    return vector<unsigned int>(top, top + header->nPred);
+  }
+
+
+  const RLEVal<szType>* getRLE() const {
+    return at<RLEVal<szType>>(rle);
+  }
+
+
+  vector<size_t> getRLEHeight() const {
+    return getHeight(rleHeight, header->nPred);
+  }
+
+
+  const double* getNumVal() const {
+    return at<double>(numVal);
+  }
+
+
+  vector<size_t> getNumHeight() const {
+    return getHeight(numHeight, header->nPredNum);
+  }
+
+
+  const unsigned int* getFacVal() const {
+    return at<unsigned int>(facVal);
+  }
+
+
+  vector<size_t> getFacHeight() const {
+    return getHeight(facHeight, header->nPredFac);
+  }
+
+
+  /**
+     @return copy of the front-end state.
+   */
+  vector<unsigned char> getFrontEnd() const {
+    const unsigned char* state = at<unsigned char>(frontEnd);
+    return vector<unsigned char>(state, state + header->nFrontEnd);
+  }
+
+
+  /**
+     @brief Writes the image of a frame.
+
+     @param frontEnd is opaque state restored on loading.
+
+     @throw runtime_error if the frame is dense or the file cannot be
+     written.
+   */
+  static void write(const struct RLEFrame* rleFrame,
+		    const vector<unsigned char>& frontEnd,
+		    const string& path);
+};
+
+#endif
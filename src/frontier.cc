@@ -24,7 +24,6 @@
 #include "ompthread.h"
 #include "branchsense.h"
 #include "sampler.h"
-#include "grove.h"
 
 
 unsigned int Frontier::totLevels = 0;
@@ -40,21 +39,33 @@ void Frontier::deInit() {
 
 
 unique_ptr<PreTree> Frontier::oneTree(const PredictorFrame* frame,
-				      const Grove* train,
 				      const Sampler* sampler,
 				      unsigned int tIdx) {
-  Frontier frontier(frame, train, sampler, tIdx);
-  SampleMap smNonTerm = frontier.produceRoot(frame, train);
-  return frontier.splitByLevel(smNonTerm);
+  return prepare(frame, sampler, tIdx, OmpThread::nThread)->train();
+}
+
+
+unique_ptr<Frontier> Frontier::prepare(const PredictorFrame* frame,
+				       const Sampler* sampler,
+				       unsigned int tIdx,
+				       unsigned int nThread) {
+  unique_ptr<Frontier> frontier = make_unique<Frontier>(frame, sampler, tIdx);
+  frontier->sampledObs->prepareRoot(frame, nThread);
+  return frontier;
+}
+
+
+unique_ptr<PreTree> Frontier::train() {
+  SampleMap smNonTerm = produceRoot();
+  return splitByLevel(smNonTerm);
 }
 
 
 Frontier::Frontier(const PredictorFrame* frame_,
-		   const Grove* grove,
 		   const Sampler* sampler,
 		   unsigned int tIdx) :
   frame(frame_),
-  scorer(grove->getNodeScorer()),
+  scorer(NodeScorer::makeScorer()),
   sampledObs(sampler->getObs(tIdx)),
   bagCount(sampledObs->getBagCount()),
   nCtg(sampledObs->getNCtg()),
@@ -64,9 +75,11 @@ Frontier::Frontier(const PredictorFrame* frame_,
 }
 
 
-SampleMap Frontier::produceRoot(const PredictorFrame* frame,
-				const Grove* grove) {
-  sampledObs->sampleRoot(frame, grove->getNodeScorer());
+Frontier::~Frontier() = default;
+
+
+SampleMap Frontier::produceRoot() {
+  sampledObs->updateResidual(scorer.get());
   pretree->offspring(0, true);
   frontierNodes.emplace_back(sampledObs.get());
 
@@ -34,7 +34,7 @@
 class Frontier {
   static unsigned int totLevels;
   const class PredictorFrame* frame;
-  struct NodeScorer* scorer;
+  unique_ptr<struct NodeScorer> scorer; ///< Per-tree:  jitter and gamma.
   unique_ptr<class SampledObs> sampledObs;
   const IndexT bagCount;
   const PredictorT nCtg;
@@ -53,8 +53,7 @@ class Frontier {
      
      @return map of bagged samples.
    */
-  SampleMap produceRoot(const class PredictorFrame* frame,
-			const class Grove* train);
+  SampleMap produceRoot();
 
 
   /**
@@ -117,10 +116,12 @@ public:
      @brief Per-tree constructor.  Sets up root node for level zero.
   */
   Frontier(const class PredictorFrame* frame,
-	   const class Grove* train,
 	   const class Sampler* sampler,
 	   unsigned int tIdx);
 
+
+  ~Frontier();
+
   
   /**
     @brief Groves one tree.
@@ -132,10 +133,31 @@ public:
     @return trained pretree object.
   */
   static unique_ptr<class PreTree> oneTree(const class PredictorFrame* frame,
-					   const class Grove* train,
 					   const class Sampler* sampler,
 					   unsigned int tIdx);
 
+
+  /**
+     @brief Builds the per-tree state not depending on the boosted
+     estimate:  bagging, rank mapping and buffer allocation.
+
+     @param nThread is the number of threads available to preparation.
+
+     @return frontier ready to train, pending residual update.
+   */
+  static unique_ptr<Frontier> prepare(const class PredictorFrame* frame,
+				      const class Sampler* sampler,
+				      unsigned int tIdx,
+				      unsigned int nThread);
+
+
+  /**
+     @brief Updates residuals and trains a prepared frontier.
+
+     @return trained pretree object.
+   */
+  unique_ptr<class PreTree> train();
+
   
   /**
      @brief Drives breadth-first splitting.
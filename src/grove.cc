@@ -20,37 +20,47 @@
 #include "pretree.h"
 #include "leaf.h"
 #include "sampler.h"
-#include "nodescorer.h"
+#include "booster.h"
+#include "obs.h"
+#include "samplenux.h"
+#include "prng.h"
+#include "ompthread.h"
 
 #include <algorithm>
 
 bool Grove::thinLeaves = false;
 unsigned int Grove::trainBlock = 0;
+size_t Grove::memCap = 0;
 
 
 void Grove::init(bool thinLeaves_,
-		 unsigned int trainBlock_) {
+		 unsigned int trainBlock_,
+		 size_t memCap_) {
   thinLeaves = thinLeaves_;
   trainBlock = trainBlock_;
+  memCap = memCap_;
 }
 
 
 void Grove::deInit() {
   trainBlock = 0;
   thinLeaves = false;
+  memCap = 0;
 }
 
 
 Grove::Grove(const PredictorFrame* frame,
 	     const IndexRange& range) :
   forestRange(range),
-  nodeScorer(NodeScorer::makeScorer()),
   predInfo(vector<double>(frame->getNPred())),
   nodeCresc(make_unique<NodeCresc>()),
   fbCresc(make_unique<FBCresc>()) {
 }
 
 
+Grove::~Grove() = default;
+
+
 void Grove::train(const PredictorFrame* frame,
 		  const Sampler * sampler,
 		  Leaf* leaf) {
@@ -75,15 +85,92 @@ vector<unique_ptr<PreTree>> Grove::blockProduce(const PredictorFrame* frame,
 						const Sampler* sampler,
 						unsigned int treeStart,
 						unsigned int treeEnd) {
-  vector<unique_ptr<PreTree>> block;
-  for (unsigned int tIdx = treeStart; tIdx < treeEnd; tIdx++) {
-    block.emplace_back(Frontier::oneTree(frame, this, sampler, tIdx));
+  vector<unique_ptr<PreTree>> block(treeEnd - treeStart);
+
+  // Workers cannot call back into the front end, so per-tree seeds
+  // are drawn here.  Seeding every tree, whether or not trained
+  // concurrently, renders the forest independent of thread count.
+  vector<double> treeSeed = PRNG::rUnif(treeEnd - treeStart);
+  unsigned int nConcurrent = blockConcurrency(frame, sampler, treeEnd - treeStart);
+  if (nConcurrent <= 1) {
+    for (unsigned int tIdx = treeStart; tIdx < treeEnd; tIdx++) {
+      block[tIdx - treeStart] = pipelineTree(frame, sampler, tIdx, treeSeed[tIdx - treeStart]);
+    }
+    return block;
   }
 
+  // Inner regions run serially on their worker.
+  int maxLevels = OmpThread::nestLevels(1);
+#pragma omp parallel default(shared) num_threads(nConcurrent)
+  {
+#pragma omp for schedule(dynamic, 1)
+    for (OMPBound blockIdx = 0; blockIdx < block.size(); blockIdx++) {
+      PRNG::LocalScope prngScope(treeSeed[blockIdx]);
+      block[blockIdx] = Frontier::oneTree(frame, sampler, treeStart + blockIdx);
+    }
+  }
+  OmpThread::restoreNested(maxLevels);
+
   return block;
 }
 
 
+unique_ptr<PreTree> Grove::pipelineTree(const PredictorFrame* frame,
+					const Sampler* sampler,
+					unsigned int tIdx,
+					double treeSeed) {
+  unique_ptr<Frontier> frontier = frontierNext == nullptr ? Frontier::prepare(frame, sampler, tIdx, OmpThread::nThread) : std::move(frontierNext);
+  bool hasNext = tIdx + 1 < forestRange.getEnd();
+  unique_ptr<PreTree> pretree;
+
+  // The master trains, under the tree's own seed.  Any other thread
+  // prepares the successor, on its own, lest the two sides' inner
+  // regions together oversubscribe the cores.
+  int maxLevels = OmpThread::nestLevels(2);
+#pragma omp parallel default(shared) num_threads(hasNext && OmpThread::nThread > 1 ? 2 : 1)
+  {
+#pragma omp master
+    {
+      PRNG::LocalScope prngScope(treeSeed);
+      pretree = frontier->train();
+    }
+#pragma omp single nowait
+    if (hasNext)
+      frontierNext = Frontier::prepare(frame, sampler, tIdx + 1, 1);
+  }
+  OmpThread::restoreNested(maxLevels);
+
+  return pretree;
+}
+
+
+unsigned int Grove::blockConcurrency(const PredictorFrame* frame,
+				     const Sampler* sampler,
+				     unsigned int blockSize) {
+  if (Booster::boosting() || OmpThread::inParallel())
+    return 1;
+
+  unsigned int nConcurrent = min(OmpThread::nThread, blockSize);
+  if (memCap > 0) {
+    size_t memTree = max(treeFootprint(frame, sampler), size_t(1));
+    nConcurrent = min(static_cast<size_t>(nConcurrent), memCap / memTree);
+  }
+
+  return nConcurrent;
+}
+
+
+size_t Grove::treeFootprint(const PredictorFrame* frame,
+			    const Sampler* sampler) {
+  size_t bagCount = sampler->getNSamp(); // Upper bound.
+  size_t bufferSize = frame->getSafeSize(bagCount);
+  return 2 * bufferSize * (sizeof(Obs) + sizeof(IndexT)) // ObsPart.
+    + bagCount * frame->getNPred() * sizeof(IndexT) // Sample ranks.
+    + bagCount * sizeof(SampleNux)
+    + sampler->getNObs() * sizeof(IndexT);
+}
+
+
 void Grove::blockConsume(const vector<unique_ptr<PreTree>>& treeBlock,
 			 Leaf* leaf) {
   for (auto & pretree : treeBlock) {
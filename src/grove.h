@@ -143,13 +143,14 @@ public:
 class Grove {
   static bool thinLeaves; ///< True iff leaves not cached.
   static unsigned int trainBlock; ///< Front-end defined buffer size. Unused.
+  static size_t memCap; ///< Bytes available to concurrent trees; zero iff unbounded.
   const IndexRange forestRange; ///< Coordinates within forest.
-  const unique_ptr<struct NodeScorer> nodeScorer; ///< Belongs elsewhere.
   vector<double> predInfo; ///< E.g., Gini gain:  nPred.
   
   unique_ptr<NodeCresc> nodeCresc; ///< Crescent node block.
   unique_ptr<FBCresc> fbCresc; ///< Crescent factor-summary block.
   vector<double> scoresCresc; ///< Crescent score block.
+  unique_ptr<class Frontier> frontierNext; ///< Successor tree, if prepared.
 
 public:
 
@@ -160,6 +161,9 @@ public:
 	const IndexRange& range);
 
 
+  ~Grove();
+
+
   void train(const class PredictorFrame* frame,
 	     const class Sampler* sampler,
 	     struct Leaf* leaf);
@@ -217,7 +221,8 @@ public:
 
 
   static void init(bool thinLeaves_,
-		   unsigned int trainBlock_);
+		   unsigned int trainBlock_,
+		   size_t memCap_);
 
  
   /**
@@ -245,16 +250,50 @@ public:
 					   unsigned int treeStart,
 					   unsigned int treeEnd);
 
+  /**
+     @brief Trains a tree while preparing its successor.
+
+     Only the residual update of the successor need await completion
+     of the current tree.
+
+     @param treeSeed seeds the variates drawn in training.
+
+     @return trained pretree.
+   */
+  unique_ptr<class PreTree> pipelineTree(const class PredictorFrame* frame,
+					 const class Sampler* sampler,
+					 unsigned int tIdx,
+					 double treeSeed);
+
+
+  /**
+     @brief Determines how many trees of a block to train concurrently.
+
+     Trees are independent only in the absence of boosting.  Concurrency
+     is capped by the thread count, the block size and the memory cap.
+
+     @return number of concurrent trees; <= 1 iff sequential.
+   */
+  static unsigned int blockConcurrency(const class PredictorFrame* frame,
+				       const class Sampler* sampler,
+				       unsigned int blockSize);
+
+
+  /**
+     @brief Estimates the peak footprint of a single tree in training.
+
+     @return upper bound on bytes allocated per tree.
+   */
+  static size_t treeFootprint(const class PredictorFrame* frame,
+			      const class Sampler* sampler);
+
+
   /**
      @brief Accumulates per-predictor information values from trained tree.
    */
   void consumeInfo(const vector<double>& info);
 
 
-  struct NodeScorer* getNodeScorer() const {
-    return nodeScorer.get();
-  }
-  
   /**
      @brief Getter for raw forest pointer.
 
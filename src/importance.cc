@@ -0,0 +1,211 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file importance.cc
+
+   @brief Methods for incremental permutation importance.
+
+   @author Mark Seligman
+ */
+
+#include "importance.h"
+#include "predict.h"
+#include "forest.h"
+#include "flatforest.h"
+#include "predictframe.h"
+#include "rleframe.h"
+#include "sample.h"
+#include "prng.h"
+#include "ompthread.h"
+
+// Type completion only:
+#include "quant.h"
+
+#include <cmath>
+
+
+Importance::Importance(const Predict* predict_,
+		       bool census,
+		       CtgT nCtg) :
+  predict(predict_),
+  forest(predict->forest),
+  flatForest(forest->getFlatForest()),
+  nObs(predict->getNObs()),
+  nTree(predict->getNTree()),
+  noNode(forest->getNoNode()),
+  width(census ? nCtg : 1),
+  predTree(treesByPredictor()),
+  accumBase(vector<double>(nObs * width)),
+  nEst(vector<unsigned int>(nObs)) {
+  const vector<IndexT>& idxCache = predict->getIdxCache();
+  for (size_t row = 0; row < nObs; row++) {
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      if (idxCache[row * nTree + tIdx] != noNode)
+	nEst[row]++;
+    }
+    double scale = nEst[row] == 0 ? 0.0 : 1.0 / (2 * nEst[row]);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      IndexT nodeIdx = idxCache[row * nTree + tIdx];
+      if (nodeIdx != noNode)
+	accumulate(tIdx, nodeIdx, 1.0, scale, &accumBase[row * width]);
+    }
+  }
+}
+
+
+vector<vector<unsigned int>> Importance::treesByPredictor() const {
+  const RLEFrame* rleFrame = predict->getFrame();
+  PredictorT nPred = rleFrame->getNPred();
+  vector<PredictorT> feIdx(nPred);
+  for (PredictorT predIdx = 0; predIdx < nPred; predIdx++) {
+    feIdx[rleFrame->getCoreIdx(predIdx)] = predIdx;
+  }
+
+  vector<vector<unsigned int>> treesPred(nPred);
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    vector<bool> splits(nPred);
+    for (const DecNode& node : forest->getNode(tIdx)) {
+      if (!node.isTerminal())
+	splits[feIdx[node.getPredIdx()]] = true;
+    }
+    for (PredictorT predIdx = 0; predIdx < nPred; predIdx++) {
+      if (splits[predIdx])
+	treesPred[predIdx].push_back(tIdx);
+    }
+  }
+
+  return treesPred;
+}
+
+
+void Importance::accumulate(unsigned int tIdx,
+			    IndexT nodeIdx,
+			    double sign,
+			    double scale,
+			    double accum[]) const {
+  double score = forest->getScore(tIdx, nodeIdx);
+  if (width == 1) {
+    accum[0] += sign * score;
+  }
+  else { // Census:  unit vote, plus jitter.
+    CtgT ctg = floor(score);
+    accum[ctg] += sign * (1.0 + (score - ctg) * scale);
+  }
+}
+
+
+void Importance::permuteAccum(PredictorT predIdx,
+			      const vector<size_t>& idxPerm,
+			      vector<double>& accum) const {
+  const RLEFrame* rleFrame = predict->getFrame();
+  bool isFactor = rleFrame->getFactorTop(predIdx) != 0;
+  unsigned int pos = rleFrame->getBlockIdx(predIdx);
+  PredictorT nPredNum = rleFrame->getNPredNum();
+  PredictorT nPredFac = rleFrame->getNPredFac();
+  const vector<IndexT>& idxCache = predict->getIdxCache();
+  const vector<unsigned int>& trees = predTree[predIdx];
+
+  vector<double> colNum;
+  vector<CtgT> colFac;
+  rleFrame->column(predIdx, colNum, colFac);
+
+  accum = accumBase;
+  vector<double> rowNum(nPredNum);
+  vector<CtgT> rowFac(nPredFac);
+  PredictFrame frame(rleFrame);
+  for (size_t blockStart = 0; blockStart < nObs; blockStart += obsChunk) {
+    size_t blockEnd = min(nObs, blockStart + obsChunk);
+    frame.transpose(rleFrame, blockStart, blockEnd - blockStart);
+    for (size_t row = blockStart; row < blockEnd; row++) {
+      if (nEst[row] == 0)
+	continue;
+      // Rows receiving an identical value reach identical nodes.
+      if (isFactor) {
+	CtgT facPerm = colFac[idxPerm[row]];
+	if (facPerm == colFac[row])
+	  continue;
+	copy(frame.baseFac(row), frame.baseFac(row) + nPredFac, rowFac.begin());
+	copy(frame.baseNum(row), frame.baseNum(row) + nPredNum, rowNum.begin());
+	rowFac[pos] = facPerm;
+      }
+      else {
+	double numPerm = colNum[idxPerm[row]];
+	double numRow = colNum[row];
+	if (numPerm == numRow || (isnan(numPerm) && isnan(numRow)))
+	  continue;
+	copy(frame.baseFac(row), frame.baseFac(row) + nPredFac, rowFac.begin());
+	copy(frame.baseNum(row), frame.baseNum(row) + nPredNum, rowNum.begin());
+	rowNum[pos] = numPerm;
+      }
+
+      double scale = 1.0 / (2 * nEst[row]);
+      double* accumRow = &accum[row * width];
+      for (unsigned int tIdx : trees) {
+	IndexT nodeIdx = idxCache[row * nTree + tIdx];
+	if (nodeIdx != noNode) {
+	  IndexT nodePerm = flatForest->walkObs(rowNum.data(), rowFac.data(), tIdx);
+	  if (nodePerm != nodeIdx) {
+	    accumulate(tIdx, nodeIdx, -1.0, scale, accumRow);
+	    accumulate(tIdx, nodePerm, 1.0, scale, accumRow);
+	  }
+	}
+      }
+    }
+  }
+}
+
+
+template<typename TestType>
+vector<vector<unique_ptr<TestType>>> Importance::permuteAll(const function<unique_ptr<TestType>(const vector<double>&)>& score) const {
+  PredictorT nPred = predTree.size();
+  unsigned int nPermute = Predict::nPermute;
+  vector<vector<unique_ptr<TestType>>> testPermute(nPred);
+  for (auto& testPred : testPermute) {
+    testPred = vector<unique_ptr<TestType>>(nPermute);
+  }
+
+  // Workers cannot call back into the front end, so per-task seeds
+  // are drawn here.
+  vector<double> taskSeed = PRNG::rUnif(nPred * nPermute);
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+#pragma omp for schedule(dynamic, 1)
+    for (OMPBound task = 0; task < taskSeed.size(); task++) {
+      PRNG::LocalScope prngScope(taskSeed[task]);
+      vector<double> accum;
+      permuteAccum(task / nPermute, Sample::permute<size_t>(nObs), accum);
+      testPermute[task / nPermute][task % nPermute] = score(accum);
+    }
+  }
+
+  return testPermute;
+}
+
+
+vector<vector<unique_ptr<TestReg>>> Importance::permuteReg(const ForestPredictionReg* prediction,
+							   const vector<double>& yTest) const {
+  return permuteAll<TestReg>([&](const vector<double>& accum) {
+    vector<double> yPred(nObs);
+    for (size_t row = 0; row < nObs; row++) {
+      yPred[row] = prediction->accumScore(accum[row], nEst[row]);
+    }
+    return prediction->test(yTest, yPred);
+  });
+}
+
+
+vector<vector<unique_ptr<TestCtg>>> Importance::permuteCtg(const ForestPredictionCtg* prediction,
+							   const vector<CtgT>& yTest) const {
+  return permuteAll<TestCtg>([&](const vector<double>& accum) {
+    vector<CtgT> yPred(nObs);
+    for (size_t row = 0; row < nObs; row++) {
+      yPred[row] = prediction->accumCtg(&accum[row * width], nEst[row]);
+    }
+    return prediction->test(yTest, yPred);
+  });
+}
@@ -0,0 +1,126 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file importance.h
+
+   @brief Incremental permutation importance.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_IMPORTANCE_H
+#define FOREST_IMPORTANCE_H
+
+#include "typeparam.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+/**
+   @brief Scores permuted frames by revisiting only those trees which
+   split on the permuted predictor.
+
+   Final indices of the unpermuted walk are cached by Predict.  As
+   permuting a predictor alters no other value in the row, trees not
+   splitting on that predictor reach the same node as before, so the
+   permuted score differs from the cached one only by the contributions
+   of the revisited trees.  Predictors and repetitions are scored
+   concurrently.
+
+   Each task transposes the frame a block of rows at a time, so that
+   memory does not scale with the full frame.  Only the permuted column,
+   whose values may be donated to any row, is decoded in full.
+ */
+class Importance {
+  static constexpr size_t obsChunk = 0x2000; ///< Rows transposed per block.
+
+  const class Predict* predict;
+  const class Forest* forest;
+  const class FlatForest* flatForest;
+  const size_t nObs;
+  const unsigned int nTree;
+  const IndexT noNode;
+  const CtgT width; ///< Accumulator width:  category count iff census.
+  vector<vector<unsigned int>> predTree; ///< Trees splitting on predictor.
+  vector<double> accumBase; ///< Unpermuted accumulation, per row.
+  vector<unsigned int> nEst; ///< # participating trees, per row.
+
+
+  /**
+     @brief Lists the trees splitting on each front-end predictor.
+   */
+  vector<vector<unsigned int>> treesByPredictor() const;
+
+
+  /**
+     @brief Adds or removes a tree's contribution to a row accumulator.
+
+     @param sign is +1 to add, -1 to remove.
+
+     @param scale weights jitter, if taking a census.
+   */
+  void accumulate(unsigned int tIdx,
+		  IndexT nodeIdx,
+		  double sign,
+		  double scale,
+		  double accum[]) const;
+
+
+  /**
+     @brief Accumulates the rows with a single predictor permuted.
+
+     @param predIdx is the front-end index of the permuted predictor.
+
+     @param idxPerm maps each row to the row donating its value.
+
+     @param[out] accum outputs the per-row accumulations.
+   */
+  void permuteAccum(PredictorT predIdx,
+		    const vector<size_t>& idxPerm,
+		    vector<double>& accum) const;
+
+
+  /**
+     @brief Drives accumulation over every predictor and repetition.
+
+     @param score maps accumulations to a test, per task.
+
+     @return tests, indexed by predictor and repetition.
+   */
+  template<typename TestType>
+  vector<vector<unique_ptr<TestType>>> permuteAll(const function<unique_ptr<TestType>(const vector<double>&)>& score) const;
+
+public:
+
+  /**
+     @param predict has walked the full frame, caching final indices.
+
+     @param census is true iff plurality scoring, over nCtg categories.
+   */
+  Importance(const class Predict* predict_,
+	     bool census,
+	     CtgT nCtg);
+
+
+  /**
+     @return per-predictor, per-repetition regression tests.
+   */
+  vector<vector<unique_ptr<struct TestReg>>> permuteReg(const struct ForestPredictionReg* prediction,
+							const vector<double>& yTest) const;
+
+
+  /**
+     @return per-predictor, per-repetition classification tests.
+   */
+  vector<vector<unique_ptr<struct TestCtg>>> permuteCtg(const struct ForestPredictionCtg* prediction,
+							const vector<CtgT>& yTest) const;
+};
+
+#endif
@@ -25,9 +25,10 @@ unique_ptr<Leaf> Leaf::train(IndexT nObs) {
 
 
 unique_ptr<Leaf> Leaf::predict(const Sampler* sampler,
-			       vector<vector<size_t>> extent,
-			       vector<vector<vector<size_t>>> index) {
-  return make_unique<Leaf>(sampler, std::move(extent), std::move(index));
+			       vector<size_t> treeHeight,
+			       vector<size_t> leafHeight,
+			       vector<IndexT> sampleIdx) {
+  return make_unique<Leaf>(sampler, std::move(treeHeight), std::move(leafHeight), std::move(sampleIdx));
 }
 
 
@@ -36,10 +37,12 @@ Leaf::Leaf() {
 
 
 Leaf::Leaf(const Sampler* sampler,
-	   vector<vector<size_t>> extent_,
-	   vector<vector<vector<size_t>>> index_) :
-  extent(std::move(extent_)),
-  index(std::move(index_)) {
+	   vector<size_t> treeHeight_,
+	   vector<size_t> leafHeight_,
+	   vector<IndexT> sampleIdx_) :
+  treeHeight(std::move(treeHeight_)),
+  leafHeight(std::move(leafHeight_)),
+  sampleIdx(std::move(sampleIdx_)) {
   RankCount::setMasks(sampler->getNObs());
 }
 
@@ -101,15 +104,16 @@ vector<vector<vector<size_t>>> Leaf::countLeafCtg(const Sampler* sampler,
       row += sampler->getDelRow(tIdx, sIdx);
       sIdx2Ctg[sIdx] = response->getCtg(row);
     }
-    size_t leafIdx = 0;
     ctgCount[tIdx] = vector<vector<size_t>>(getLeafCount(tIdx));
-    for (vector<size_t> sIdxVec : getIndices(tIdx)) {
-      ctgCount[tIdx][leafIdx] = vector<size_t>(sIdxVec.size() * nCtg);
-      for (size_t sIdx : sIdxVec) {
+    for (IndexT leafIdx = 0; leafIdx != ctgCount[tIdx].size(); leafIdx++) {
+      size_t leafStart = getLeafStart(tIdx, leafIdx);
+      size_t leafEnd = getLeafEnd(tIdx, leafIdx);
+      ctgCount[tIdx][leafIdx] = vector<size_t>((leafEnd - leafStart) * nCtg);
+      for (size_t pos = leafStart; pos != leafEnd; pos++) {
+	IndexT sIdx = sampleIdx[pos];
 	PredictorT ctg = sIdx2Ctg[sIdx];
 	ctgCount[tIdx][leafIdx][ctg] += sampler->getSCount(tIdx, sIdx);
       }
-      leafIdx++;
     }
   }
 
@@ -117,6 +121,22 @@ vector<vector<vector<size_t>>> Leaf::countLeafCtg(const Sampler* sampler,
 }
 
 
+vector<vector<double>> Leaf::cover(const Sampler* sampler) const {
+  unsigned int nTree = getNTree();
+  vector<vector<double>> leafCover(nTree);
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    leafCover[tIdx] = vector<double>(getLeafCount(tIdx));
+    for (IndexT leafIdx = 0; leafIdx != leafCover[tIdx].size(); leafIdx++) {
+      for (size_t pos = getLeafStart(tIdx, leafIdx); pos != getLeafEnd(tIdx, leafIdx); pos++) {
+	leafCover[tIdx][leafIdx] += sampler->hasSamples() ? sampler->getSCount(tIdx, sampleIdx[pos]) : 1;
+      }
+    }
+  }
+
+  return leafCover;
+}
+
+
 vector<vector<vector<RankCount>>> Leaf::alignRanks(const class Sampler* sampler,
 						   const vector<IndexT>& obs2Rank) const {
   unsigned int nTree = sampler->getNRep();
@@ -131,15 +151,15 @@ vector<vector<vector<RankCount>>> Leaf::alignRanks(const class Sampler* sampler,
       obsIdx += sampler->getDelRow(tIdx, sIdx);
       sIdx2Rank[sIdx] = obs2Rank[obsIdx];
     }
-    size_t leafIdx = 0;
     rankCount[tIdx] = vector<vector<RankCount>>(getLeafCount(tIdx));
-    for (vector<size_t> sIdxVec : getIndices(tIdx)) {
-      rankCount[tIdx][leafIdx] = vector<RankCount>(sIdxVec.size());
+    for (IndexT leafIdx = 0; leafIdx != rankCount[tIdx].size(); leafIdx++) {
+      size_t leafStart = getLeafStart(tIdx, leafIdx);
+      rankCount[tIdx][leafIdx] = vector<RankCount>(getLeafEnd(tIdx, leafIdx) - leafStart);
       size_t idx = 0;
-      for (size_t sIdx : sIdxVec) {
-	rankCount[tIdx][leafIdx][idx++].init(sIdx2Rank[sIdx], sampler->getSCount(tIdx, sIdx));
+      for (RankCount& rc : rankCount[tIdx][leafIdx]) {
+	IndexT sIdx = sampleIdx[leafStart + idx++];
+	rc.init(sIdx2Rank[sIdx], sampler->getSCount(tIdx, sIdx));
       }
-      leafIdx++;
     }
   }
 
@@ -89,9 +89,10 @@ struct Leaf {
   vector<IndexT> indexCresc; ///< Sample indices within leaves.
   vector<IndexT> extentCresc; ///< Index extent, per leaf.
   
-  // Post-training only:  extent, index maps fixed.
-  const vector<vector<size_t>> extent; ///< # sample index entries per leaf, per tree.
-  const vector<vector<vector<size_t>>> index; ///< sample indices per leaf, per tree.
+  // Post-training only:  flat, fixed maps.
+  const vector<size_t> treeHeight; ///< Accumulated leaf count, per tree.
+  const vector<size_t> leafHeight; ///< Accumulated sample count, per leaf.
+  const vector<IndexT> sampleIdx; ///< Sample indices, leaf-contiguous.
 
   /**
      @brief Training factory.
@@ -106,13 +107,16 @@ struct Leaf {
 
      @param Sampler guides reading of leaf contents.
 
-     @param extent gives the number of distinct samples, forest-wide.
+     @param treeHeight accumulates the leaf count of each tree.
 
-     @param index gives sample positions.
+     @param leafHeight accumulates the sample count of each leaf.
+
+     @param sampleIdx gives sample positions.
   */
   static unique_ptr<Leaf> predict(const class Sampler* sampler,
-				  vector<vector<size_t>> extent,
-				  vector<vector<vector<size_t>>> index);
+				  vector<size_t> treeHeight,
+				  vector<size_t> leafHeight,
+				  vector<IndexT> sampleIdx);
 
 
   /**
@@ -125,8 +129,9 @@ struct Leaf {
      @brief Post-training constructor:  fixed maps passed in.
    */
   Leaf(const class Sampler* sampler,
-       vector<vector<size_t>> extent_,
-       vector<vector<vector<size_t>>> index_);
+       vector<size_t> treeHeight_,
+       vector<size_t> leafHeight_,
+       vector<IndexT> sampleIdx_);
 
   
   /**
@@ -141,7 +146,7 @@ struct Leaf {
      @return true iff the index vectors are unpopulated.
    */
   bool empty() const {
-    return extent.empty();
+    return leafHeight.empty();
   }
 
   
@@ -165,6 +170,14 @@ struct Leaf {
 					      const class ResponseCtg* response) const;
 
 
+  /**
+     @brief Sums the sample counts at each leaf.
+
+     @return 2-d vector of training cover, indexed by tree/leaf.
+   */
+  vector<vector<double>> cover(const class Sampler* sampler) const;
+
+
   /**
      @brief Count samples at each rank, per leaf, per tree:  regression.
 
@@ -180,7 +193,15 @@ struct Leaf {
      @return # leaves at a given tree index.
    */
   size_t getLeafCount(unsigned int tIdx) const {
-    return extent[tIdx].size();
+    return treeHeight[tIdx] - (tIdx == 0 ? 0 : treeHeight[tIdx - 1]);
+  }
+
+
+  /**
+     @return # trees with recorded leaves.
+   */
+  unsigned int getNTree() const {
+    return treeHeight.size();
   }
 
 
@@ -194,18 +215,29 @@ struct Leaf {
   }
   
   /**
-     @return vector of leaf extents for given tree.
+     @return position of a leaf's first sample index.
+   */
+  size_t getLeafStart(unsigned int tIdx,
+		      IndexT leafIdx) const {
+    size_t leafPos = (tIdx == 0 ? 0 : treeHeight[tIdx - 1]) + leafIdx;
+    return leafPos == 0 ? 0 : leafHeight[leafPos - 1];
+  }
+
+
+  /**
+     @return position following a leaf's last sample index.
    */
-  const vector<size_t>& getExtents(unsigned int tIdx) const {
-    return extent[tIdx];
+  size_t getLeafEnd(unsigned int tIdx,
+		    IndexT leafIdx) const {
+    return leafHeight[(tIdx == 0 ? 0 : treeHeight[tIdx - 1]) + leafIdx];
   }
 
 
   /**
-     @return vector of per-leaf index vectors for a given tree.
+     @return sample index at a given position.
    */
-  const vector<vector<size_t>>& getIndices(unsigned int tIdx) const {
-    return index[tIdx];
+  IndexT getSampleIdx(size_t pos) const {
+    return sampleIdx[pos];
   }
 };
 
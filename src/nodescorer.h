@@ -57,7 +57,7 @@ struct NodeScorer {
   /**
      @brief Makes scorer by keying off static string.
 
-     Currently called once per grove of trained trees.
+     Called once per tree, as jitter and gamma are tree-local.
    */
   static unique_ptr<NodeScorer> makeScorer();
 
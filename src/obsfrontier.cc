@@ -38,7 +38,6 @@ ObsFrontier::ObsFrontier(const Frontier* frontier_,
   runCount(0),
   layerIdx(0), // Not on layer yet, however.
   nodePath(backScale(nSplit)) {
-  NodePath::setNoSplit(frontier->getBagCount());
   // Coprocessor only.
   // LiveBits df;
   //  fill(mrra.begin(), mrra.end(), df);
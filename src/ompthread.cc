@@ -29,6 +29,17 @@ constexpr int omp_get_max_threads() {
 constexpr int omp_get_thread_limit() {
   return 1;
 }
+
+constexpr int omp_in_parallel() {
+  return 0;
+}
+
+constexpr int omp_get_max_active_levels() {
+  return 1;
+}
+
+void omp_set_max_active_levels(int) {
+}
 #endif
 
 unsigned int OmpThread::nThread = OmpThread::nThreadDefault;
@@ -48,3 +59,20 @@ void OmpThread::init(unsigned int nThread_) {
 void OmpThread::deInit() {
   nThread = nThreadDefault;
 }
+
+
+bool OmpThread::inParallel() {
+  return omp_in_parallel() != 0;
+}
+
+
+int OmpThread::nestLevels(int maxLevels) {
+  int levelsPrior = omp_get_max_active_levels();
+  omp_set_max_active_levels(maxLevels);
+  return levelsPrior;
+}
+
+
+void OmpThread::restoreNested(int maxLevels) {
+  omp_set_max_active_levels(maxLevels);
+}
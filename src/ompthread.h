@@ -38,6 +38,28 @@ struct OmpThread {
    */
   static void deInit();
 
+
+  /**
+     @return true iff the caller is already within an active parallel region.
+   */
+  static bool inParallel();
+
+
+  /**
+     @brief Sets the depth to which nested regions may be active.  A
+     depth of one executes inner regions serially on their encountering
+     thread.
+
+     @return prior setting, for restoration.
+   */
+  static int nestLevels(int maxLevels);
+
+
+  /**
+     @brief Restores nesting setting saved by nestLevels().
+   */
+  static void restoreNested(int maxLevels);
+
 private:
   static constexpr unsigned int nThreadDefault = 0; // Static initialization.
   static const unsigned int maxThreads;
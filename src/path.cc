@@ -19,14 +19,6 @@
 #include "frontier.h"
 #include "path.h"
 
-IndexT NodePath::noSplit = 0;
-
-
-void NodePath::setNoSplit(IndexT bagCount) {
-  noSplit = bagCount;
-}
-
-
 IdxPath::IdxPath(IndexT idxLive_) :
   idxLive(idxLive_),
   smIdx(vector<IndexT>(idxLive)),
@@ -31,7 +31,8 @@ class NodePath {
   // Maximal path length is also an inattainable path index.
   static constexpr unsigned int noPath = 1 << logPathMax;
 
-  static IndexT noSplit;
+  // Inattainable split index, shared by concurrently-trained trees.
+  static constexpr IndexT noSplit = ~static_cast<IndexT>(0);
   
   IndexT frontIdx; // < noIndex iff path extinct.
   IndexRange bufRange; // buffer target range for path.
@@ -62,12 +63,6 @@ public:
   }
 
 
-  /**
-     @brief Sets noSplit to inattainable split index.
-   */
-  static void setNoSplit(IndexT bagCount);
-
-  
   /**
      @brief Determines whether a path size is representable within
      container.
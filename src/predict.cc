@@ -23,11 +23,15 @@
 #include "ompthread.h"
 #include "rleframe.h"
 #include "sample.h"
+#include "importance.h"
 
 #include <cmath>
 
 const size_t Predict::obsChunk = 0x2000;
 const unsigned int Predict::seqChunk = 0x20;
+const unsigned int Predict::treeBlock = 0x10;
+const size_t Predict::treeMajorNodes = 0x10000;
+const size_t Predict::treeMajorRows = 0x400;
 
 
 bool Predict::bagging = false;
@@ -52,7 +56,9 @@ Predict::Predict(const Sampler* sampler,
   bag(sampler->bagRows(bagging)),
   rleFrame(std::move(rleFrame_)),
   nObs(rleFrame == nullptr ? 0 : rleFrame->getNRow()),
-  trFrame(PredictFrame(rleFrame.get())) {
+  trFrame(PredictFrame(rleFrame.get())),
+  treeMajor(false),
+  fused(false) {
   if (rleFrame != nullptr) { // TEMPORARY
     rleFrame->reorderRow(); // For now, all frames pre-ranked.
   }
@@ -88,7 +94,7 @@ unique_ptr<SummaryReg> PredictReg::predictReg(const Sampler* sampler,
   this->forest = forest;
   nTree = forest->getNTree();
   unique_ptr<SummaryReg> summary = make_unique<SummaryReg>(sampler, this, forest);
-  summary->build(this, sampler, yTest);
+  summary->build(this, yTest);
   return summary;
 }
 
@@ -99,7 +105,7 @@ unique_ptr<SummaryCtg> PredictCtg::predictCtg(const Sampler* sampler,
   this->forest = forest;
   nTree = forest->getNTree();
   unique_ptr<SummaryCtg> summary = make_unique<SummaryCtg>(sampler, this, forest);
-  summary->build(this, sampler, yTest);
+  summary->build(this, yTest);
   return summary;
 }
 
@@ -113,11 +119,12 @@ SummaryReg::SummaryReg(const Sampler* sampler,
 
 
 void SummaryReg::build(Predict* predictObj,
-		       const Sampler* sampler,
 		       const vector<double>& yTest) {
   predictObj->predict(prediction.get());
   test = prediction->test(yTest);
-  permutationTest = permute(predictObj, sampler, yTest);
+  if (!yTest.empty())
+    stageLoss = prediction->stageLoss(yTest);
+  permutationTest = permute(predictObj, yTest);
 }
 
 
@@ -130,19 +137,46 @@ SummaryCtg::SummaryCtg(const Sampler* sampler,
 
 
 void SummaryCtg::build(Predict* predictObj,
-		       const Sampler* sampler,
 		       const vector<unsigned int>& yTest) {
   predictObj->predict(prediction.get());
   test = prediction->test(yTest);
-  permutationTest = permute(predictObj, sampler, yTest);
+  if (!yTest.empty())
+    stageLoss = prediction->stageLoss(yTest);
+  permutationTest = permute(predictObj, yTest);
 }
 
 
 void Predict::predict(ForestPrediction* prediction) {
   blockStart = 0;
   forest->initWalkers(trFrame);
-  idxFinal = vector<IndexT>(nTree * obsChunk);
   noNode = forest->getNoNode();
+  // Additive scorers need not revisit final indices, unless permuting.
+  fused = prediction->accumulates() && !permutes();
+  idxFinal = vector<IndexT>(fused ? 0 : nTree * obsChunk);
+  idxCache = vector<IndexT>(permutes() ? nTree * nObs : 0);
+  // Forests much larger than cache are better streamed once per block.
+  treeMajor = forest->getQuickScorer() == nullptr
+    && forest->getFlatForest()->getNodeCount() >= treeMajorNodes
+    && nObs >= treeMajorRows;
+  if (treeMajor || fused) {
+    sumAccum = vector<double>(obsChunk);
+    nEstAccum = vector<unsigned int>(obsChunk);
+  }
+  if (treeMajor) {
+    // Partials are allocated once and reused by every row block.
+    size_t nBlock = (nTree + treeBlock - 1) / treeBlock;
+    blockSum = vector<double>(nBlock * obsChunk);
+    blockEst = vector<unsigned int>(nBlock * obsChunk);
+  }
+  const BinnedForest* binnedForest = forest->getBinnedForest();
+  blockBin = vector<BinnedForest::BinT>(binnedForest == nullptr ? 0 : obsChunk * binnedForest->getNPredNum());
+  if (bagging) {
+    bagWindow = make_unique<BitMatrix>(nTree, obsChunk);
+    bagCursor = vector<BagCursor>(nTree);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      bagCursor[tIdx] = bag->begin(tIdx);
+    }
+  }
   
   predictBlock(prediction);
   // Remainder rows handled in custom-fitted block.
@@ -164,41 +198,213 @@ void Predict::predictObs(ForestPrediction* prediction,
 			 size_t span) {
   resetIndices();
   trFrame.transpose(rleFrame.get(), blockStart, span);
+  if (bagging) {
+    bag->decodeBlock(bagCursor, blockStart, span, bagWindow.get());
+  }
+  const BinnedForest* binnedForest = forest->getBinnedForest();
+  if (binnedForest != nullptr) {
+    binBlock(binnedForest, span);
+  }
 
   OMPBound rowEnd = static_cast<OMPBound>(blockStart + span);
   OMPBound rowStart = static_cast<OMPBound>(blockStart);
 
+  if (treeMajor) {
+    walkTreeMajor(trFrame, span);
+  }
 #pragma omp parallel default(shared) num_threads(OmpThread::nThread)
   {
 #pragma omp for schedule(dynamic, 1)
   for (OMPBound row = rowStart; row < rowEnd; row += seqChunk) {
     size_t chunkEnd = min(rowEnd, row + seqChunk);
-    walkTree(trFrame, row, chunkEnd);
+    if (!treeMajor) {
+      walkTree(trFrame, row, chunkEnd);
+    }
     prediction->callScorer(this, row, chunkEnd);
+    prediction->explain(trFrame, row, chunkEnd);
   }
   }
-  prediction->cacheIndices(idxFinal, span * nTree, blockStart * nTree);
+  if (!fused) {
+    prediction->cacheIndices(idxFinal, span * nTree, blockStart * nTree);
+  }
+  if (!idxCache.empty()) {
+    copy(idxFinal.begin(), idxFinal.begin() + span * nTree, idxCache.begin() + blockStart * nTree);
+  }
 }
 
 
 void Predict::resetIndices() {
-  fill(idxFinal.begin(), idxFinal.end(), noNode);
+  if (fused) {
+    fill(sumAccum.begin(), sumAccum.end(), 0.0);
+    fill(nEstAccum.begin(), nEstAccum.end(), 0);
+  }
+  else {
+    fill(idxFinal.begin(), idxFinal.end(), noNode);
+  }
+}
+
+
+void Predict::binBlock(const BinnedForest* binnedForest,
+		       size_t span) {
+  PredictorT nPredNum = binnedForest->getNPredNum();
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+#pragma omp for schedule(dynamic, 1)
+  for (OMPBound row = 0; row < span; row += seqChunk) {
+    size_t chunkEnd = min(span, row + seqChunk);
+    for (size_t rowIdx = row; rowIdx != chunkEnd; rowIdx++) {
+      binnedForest->binRow(trFrame.baseNum(blockStart + rowIdx), &blockBin[rowIdx * nPredNum]);
+    }
+  }
+  }
+}
+
+
+void Predict::recordFinal(size_t obsIdx,
+			  unsigned int tIdx,
+			  IndexT finalIdx) {
+  if (fused) {
+    sumAccum[obsIdx - blockStart] += forest->getScore(tIdx, finalIdx);
+    nEstAccum[obsIdx - blockStart]++;
+  }
+  else {
+    setFinalIdx(obsIdx, tIdx, finalIdx);
+  }
 }
 
 
 void Predict::walkTree(const PredictFrame& frame,
 		       size_t obsStart,
 		       size_t obsEnd) {
-  for (size_t obsIdx = obsStart; obsIdx != obsEnd; obsIdx++) {
+  const QuickScorer* quickScorer = forest->getQuickScorer();
+  if (quickScorer != nullptr) {
+    // Per-thread scratch is reused across chunks and predictions.
+    static thread_local vector<uint64_t> leafBits;
+    static thread_local vector<IndexT> rowIdx;
+    if (leafBits.size() < nTree) {
+      leafBits.resize(nTree);
+      rowIdx.resize(nTree);
+    }
+    for (size_t obsIdx = obsStart; obsIdx != obsEnd; obsIdx++) {
+      quickScorer->walkRow(frame, obsIdx, leafBits.data(), rowIdx.data());
+      for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+	if (!isBagged(tIdx, obsIdx)) {
+	  recordFinal(obsIdx, tIdx, rowIdx[tIdx]);
+	}
+      }
+    }
+    return;
+  }
+
+  const BinnedForest* binnedForest = forest->getBinnedForest();
+  if (binnedForest != nullptr) {
+    PredictorT nPredNum = binnedForest->getNPredNum();
+    for (size_t obsIdx = obsStart; obsIdx != obsEnd; obsIdx++) {
+      const BinnedForest::BinT* rowBin = &blockBin[(obsIdx - blockStart) * nPredNum];
+      for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+	if (!isBagged(tIdx, obsIdx)) {
+	  recordFinal(obsIdx, tIdx, binnedForest->walkBinned(rowBin, tIdx));
+	}
+      }
+    }
+    return;
+  }
+
+  // Full batches walk numeric-only trees in lockstep.
+  const FlatForest* flatForest = forest->getFlatForest();
+  IndexT batchIdx[FlatForest::batchRows];
+  size_t obsIdx = obsStart;
+  for (; obsIdx + FlatForest::batchRows <= obsEnd; obsIdx += FlatForest::batchRows) {
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      if (flatForest->isBatchable(tIdx)) {
+	flatForest->walkBatch(frame, obsIdx, tIdx, batchIdx);
+      }
+      else {
+	for (unsigned int lane = 0; lane < FlatForest::batchRows; lane++) {
+	  batchIdx[lane] = flatForest->walkObs(frame, obsIdx + lane, tIdx);
+	}
+      }
+      for (unsigned int lane = 0; lane < FlatForest::batchRows; lane++) {
+	if (!isBagged(tIdx, obsIdx + lane)) {
+	  recordFinal(obsIdx + lane, tIdx, batchIdx[lane]);
+	}
+      }
+    }
+  }
+
+  for (; obsIdx != obsEnd; obsIdx++) {
     for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
       if (!isBagged(tIdx, obsIdx)) {
-	setFinalIdx(obsIdx, tIdx, forest->walkObs(frame, obsIdx, tIdx));
+	recordFinal(obsIdx, tIdx, forest->walkObs(frame, obsIdx, tIdx));
       }
     }
   }
 }
 
 
+void Predict::walkTreeMajor(const PredictFrame& frame,
+			    size_t span) {
+  const FlatForest* flatForest = forest->getFlatForest();
+  const BinnedForest* binnedForest = forest->getBinnedForest();
+  PredictorT nPredBin = binnedForest == nullptr ? 0 : binnedForest->getNPredNum();
+  OMPBound nBlock = (nTree + treeBlock - 1) / treeBlock;
+  size_t obsEnd = blockStart + span;
+
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+  {
+#pragma omp for schedule(dynamic, 1)
+  for (OMPBound blockIdx = 0; blockIdx < nBlock; blockIdx++) {
+    // Each worker clears the partials it accumulates.
+    double* sumBlock = &blockSum[blockIdx * span];
+    unsigned int* estBlock = &blockEst[blockIdx * span];
+    fill(sumBlock, sumBlock + span, 0.0);
+    fill(estBlock, estBlock + span, 0);
+    unsigned int treeEnd = min(nTree, static_cast<unsigned int>((blockIdx + 1) * treeBlock));
+    IndexT batchIdx[FlatForest::batchRows];
+    // Each tree remains cache-resident while the full block traverses it.
+    for (unsigned int tIdx = blockIdx * treeBlock; tIdx < treeEnd; tIdx++) {
+      size_t obsIdx = blockStart;
+      if (binnedForest == nullptr && flatForest->isBatchable(tIdx)) {
+	for (; obsIdx + FlatForest::batchRows <= obsEnd; obsIdx += FlatForest::batchRows) {
+	  flatForest->walkBatch(frame, obsIdx, tIdx, batchIdx);
+	  for (unsigned int lane = 0; lane < FlatForest::batchRows; lane++) {
+	    if (!isBagged(tIdx, obsIdx + lane)) {
+	      if (!fused)
+		setFinalIdx(obsIdx + lane, tIdx, batchIdx[lane]);
+	      sumBlock[obsIdx + lane - blockStart] += forest->getScore(tIdx, batchIdx[lane]);
+	      estBlock[obsIdx + lane - blockStart]++;
+	    }
+	  }
+	}
+      }
+      for (; obsIdx != obsEnd; obsIdx++) {
+	if (!isBagged(tIdx, obsIdx)) {
+	  IndexT nodeIdx = binnedForest != nullptr ? binnedForest->walkBinned(&blockBin[(obsIdx - blockStart) * nPredBin], tIdx) : flatForest->walkObs(frame, obsIdx, tIdx);
+	  if (!fused)
+	    setFinalIdx(obsIdx, tIdx, nodeIdx);
+	  sumBlock[obsIdx - blockStart] += forest->getScore(tIdx, nodeIdx);
+	  estBlock[obsIdx - blockStart]++;
+	}
+      }
+    }
+  }
+
+  // Partial sums reduced in block order, independent of scheduling.
+#pragma omp for schedule(static)
+  for (OMPBound row = 0; row < span; row++) {
+    double sumScore = 0.0;
+    unsigned int nEst = 0;
+    for (OMPBound blockIdx = 0; blockIdx < nBlock; blockIdx++) {
+      sumScore += blockSum[blockIdx * span + row];
+      nEst += blockEst[blockIdx * span + row];
+    }
+    sumAccum[row] = sumScore;
+    nEstAccum[row] = nEst;
+  }
+  }
+}
+
+
 bool Predict::isLeafIdx(size_t obsIdx,
 			unsigned int tIdx,
 			IndexT& leafIdx) const {
@@ -227,46 +433,20 @@ bool Predict::isNodeIdx(size_t obsIdx,
 
 
 vector<vector<unique_ptr<TestReg>>> SummaryReg::permute(const Predict* predict,
-							const Sampler* sampler,
-							const vector<double>& yTest) {
+							const vector<double>& yTest) const {
   if (yTest.empty() || Predict::nPermute == 0)
     return vector<vector<unique_ptr<TestReg>>>(0);
 
-  RLEFrame* rleFrame = predict->getFrame();
-  vector<vector<unique_ptr<TestReg>>> testPermute(rleFrame->getNPred());
-  for (PredictorT predIdx = 0; predIdx < rleFrame->getNPred(); predIdx++) {
-    vector<RLEVal<szType>> rleTemp = std::move(rleFrame->rlePred[predIdx]);
-    for (unsigned int rep = 0; rep != Predict::nPermute; rep++) {
-      rleFrame->rlePred[predIdx] = rleFrame->permute(predIdx, Sample::permute(rleFrame->getNRow()));
-      unique_ptr<ForestPredictionReg> repReg = predict->forest->makePredictionReg(sampler, predict, false);
-      testPermute[predIdx].emplace_back(repReg->test(yTest));
-    }
-    rleFrame->rlePred[predIdx] = std::move(rleTemp);
-  }
-
-  return testPermute;
+  return Importance(predict, false, 0).permuteReg(prediction.get(), yTest);
 }
 
 
 vector<vector<unique_ptr<TestCtg>>> SummaryCtg::permute(const Predict* predict,
-							const Sampler* sampler,
-							const vector<unsigned int>& yTest) {
+							const vector<unsigned int>& yTest) const {
   if (yTest.empty() || Predict::nPermute == 0)
     return vector<vector<unique_ptr<TestCtg>>>(0);
 
-  RLEFrame* rleFrame = predict->getFrame();
-  vector<vector<unique_ptr<TestCtg>>> testPermute(rleFrame->getNPred());
-  for (PredictorT predIdx = 0; predIdx < rleFrame->getNPred(); predIdx++) {
-    vector<RLEVal<szType>> rleTemp = std::move(rleFrame->rlePred[predIdx]);
-    for (unsigned int rep = 0; rep != Predict::nPermute; rep++) {
-      rleFrame->rlePred[predIdx] = rleFrame->permute(predIdx, Sample::permute(rleFrame->getNRow()));
-      unique_ptr<ForestPredictionCtg> repCtg = predict->forest->makePredictionCtg(sampler, predict, false);
-      testPermute[predIdx].emplace_back(repCtg->test(yTest));
-    }
-    rleFrame->rlePred[predIdx] = std::move(rleTemp);
-  }
-
-  return testPermute;
+  return Importance(predict, !prediction->additive, prediction->nCtg).permuteCtg(prediction.get(), yTest);
 }
 
 
@@ -345,85 +525,11 @@ vector<vector<double>> SummaryCtg::getOOBErrorPermuted() const {
 }
 
 
-vector<double> Predict::forestWeight(const Forest* forest,
-				     const Sampler* sampler,
-				     size_t nPredict,
-				     const double finalIdx[]) {
-  vector<vector<double>> obsWeight(nPredict);
-  for (size_t idxPredict = 0; idxPredict != nPredict; idxPredict++) {
-    obsWeight[idxPredict] = vector<double>(sampler->getNObs());
-  }
-
-  for (unsigned int tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
-    vector<vector<IdCount>> node2Idc = obsCounts(forest, sampler, tIdx);
-    weighNode(forest, &finalIdx[tIdx], node2Idc, obsWeight);
-  }
-
-  return normalizeWeight(sampler, obsWeight);
-}
-
-
-vector<vector<IdCount>> Predict::obsCounts(const Forest* forest,
-					   const Sampler* sampler,
-					   unsigned int tIdx) {
-  const Leaf& leaf = forest->getLeaf();
-  const vector<DecNode>& decNode = forest->getNode(tIdx);
-  const vector<IdCount> idCount = sampler->unpack(tIdx);
-  const vector<vector<size_t>>& indices = leaf.getIndices(tIdx);
-
-  // Dominators need not be computed if it is known in advance
-  // that all final indices are terminal.  This will be the case
-  // if prediction does not employ trap-and-bail.
-  vector<IndexRange> leafDom = forest->leafDominators(decNode);
-  vector<vector<IdCount>> node2Idc(decNode.size());
-  for (IndexT nodeIdx = 0; nodeIdx != decNode.size(); nodeIdx++) {
-    IndexRange leafRange = leafDom[nodeIdx];
-    for (IndexT leafIdx = leafRange.getStart(); leafIdx != leafRange.getEnd(); leafIdx++) {
-      for (size_t sIdx : indices[leafIdx]) {
-	node2Idc[nodeIdx].emplace_back(idCount[sIdx]);
-      }
-    }
-  }
-
-  return node2Idc;
-}
-
-
-void Predict::weighNode(const Forest* forest,
-			const double treeIdx[],
-			const vector<vector<IdCount>>& nodeCount,
-			vector<vector<double>>& obsWeight) {
-  IndexT noNode = forest->getNoNode(); // Excludes bagged observations.
-  size_t finalPosition = 0; // Position of final indices for tree.
-  for (vector<double>& nodeWeight : obsWeight) {
-    IndexT nodeIdx = treeIdx[finalPosition];
-    if (nodeIdx != noNode) {
-      IndexT sampleCount = 0;
-      for (const IdCount &idc : nodeCount[nodeIdx]) {
-	sampleCount += idc.sCount;
-      }
-
-      double recipSCount = 1.0 / sampleCount;
-      for (const IdCount& idc : nodeCount[nodeIdx]) {
-	nodeWeight[idc.id] += idc.sCount * recipSCount;
-      }
-    }
-    finalPosition += forest->getNTree();
-  }
-}
-
-
-vector<double> Predict::normalizeWeight(const Sampler* sampler,
-					const vector<vector<double>>& obsWeight) {
-  size_t nObs = sampler->getNObs();
-  vector<double> weight(obsWeight.size() * nObs);
-  size_t idxPredict = 0;
-  for (const vector<double>& obsW : obsWeight) {
-    double weightRecip = 1.0 / accumulate(obsW.begin(), obsW.end(), 0.0);
-    transform(obsW.begin(), obsW.end(), &weight[idxPredict * nObs],
-                   [&weightRecip](double element) { return element * weightRecip; });
-    idxPredict++;
-  }
-  return weight;
+SparseWeight Predict::forestWeight(Forest* forest,
+				   const Sampler* sampler,
+				   size_t nPredict,
+				   const double finalIdx[]) {
+  forest->initWeight(sampler);
+  return forest->getForestWeight()->weigh(forest->getNoNode(), nPredict, finalIdx);
 }
 
@@ -21,6 +21,8 @@
 #include "block.h"
 #include "typeparam.h"
 #include "bv.h"
+#include "bagcode.h"
+#include "binnedforest.h"
 
 #include <vector>
 #include <algorithm>
@@ -33,6 +35,7 @@ struct SummaryReg {
   unique_ptr<ForestPredictionReg> prediction;
   unique_ptr<TestReg> test;
   vector<vector<unique_ptr<TestReg>>> permutationTest;
+  vector<double> stageLoss; ///< Test loss at each checkpoint, if staged.
 
   SummaryReg(const class Sampler* sampler,
 	     const class Predict* predict,
@@ -40,13 +43,14 @@ struct SummaryReg {
 
 
   void build(class Predict* predict,
-	     const class Sampler* sampler,
 	     const vector<double>& yTest);
 
 
-  static vector<vector<unique_ptr<TestReg>>> permute(const class Predict* predict,
-						     const class Sampler* sampler,
-						     const vector<double>& yTest);
+  /**
+     @brief Tests the prediction with each predictor permuted in turn.
+   */
+  vector<vector<unique_ptr<TestReg>>> permute(const class Predict* predict,
+					      const vector<double>& yTest) const;
 
   size_t getNObs() const {
     return prediction->getNObs();
@@ -60,6 +64,22 @@ struct SummaryReg {
     return prediction->idxFinal;
   }
 
+
+  /**
+     @return handle to per-row scores at each checkpoint, if staged.
+   */
+  const vector<double>& getStaged() const {
+    return prediction->staged;
+  }
+
+
+  /**
+     @return handle to per-row feature contributions, if explaining.
+   */
+  const vector<double>& getContrib() const {
+    return prediction->contrib;
+  }
+
   
   const vector<double>& getYPred() const;
 
@@ -107,6 +127,7 @@ struct SummaryCtg {
   unique_ptr<ForestPredictionCtg> prediction;
   unique_ptr<TestCtg> test;
   vector<vector<unique_ptr<TestCtg>>> permutationTest;
+  vector<double> stageLoss; ///< Test loss at each checkpoint, if staged.
 
   SummaryCtg(const class Sampler* sampler,
 	     const class Predict* predict,
@@ -114,13 +135,14 @@ struct SummaryCtg {
 
   
   void build(class Predict* predict,
-	     const class Sampler* sampler,
 	     const vector<unsigned int>& yTest);
 
 
-  static vector<vector<unique_ptr<TestCtg>>> permute(const class Predict* predict,
-						     const class Sampler* sampler,
-						     const vector<unsigned int>& yTest);
+  /**
+     @brief Tests the prediction with each predictor permuted in turn.
+   */
+  vector<vector<unique_ptr<TestCtg>>> permute(const class Predict* predict,
+					      const vector<unsigned int>& yTest) const;
 
 
   /**
@@ -149,6 +171,22 @@ struct SummaryCtg {
   }
 
 
+  /**
+     @return handle to per-row scores at each checkpoint, if staged.
+   */
+  const vector<double>& getStaged() const {
+    return prediction->staged;
+  }
+
+
+  /**
+     @return handle to per-row feature contributions, if explaining.
+   */
+  const vector<double>& getContrib() const {
+    return prediction->contrib;
+  }
+
+
   const vector<CtgT>& getYPred() const;
 
   const vector<size_t>& getConfusion() const;
@@ -187,8 +225,13 @@ class Predict {
 protected:
   static const size_t obsChunk; ///< Observation block dimension.
   static const unsigned int seqChunk;  ///< Effort to minimize false sharing.
+  static const unsigned int treeBlock; ///< Trees per tree-major work unit.
+  static const size_t treeMajorNodes; ///< Forest size favoring tree-major walk.
+  static const size_t treeMajorRows; ///< Minimal block favoring tree-major walk.
 
-  const unique_ptr<class BitMatrix> bag; ///< Nonnull iff bagging.
+  const unique_ptr<BagCode> bag; ///< Empty unless bagging.
+  unique_ptr<class BitMatrix> bagWindow; ///< Bag decoded over current block.
+  vector<BagCursor> bagCursor; ///< Per-tree decoding state.
   unique_ptr<struct RLEFrame> rleFrame;
   const size_t nObs; ///< # observations under prediction.
 
@@ -198,6 +241,14 @@ protected:
   PredictFrame trFrame; ///< Initialized by RLEFrame, reset per block.
   size_t blockStart; ///< Index of observation heading current block.
   vector<IndexT> idxFinal; ///< Final walk index, typically terminal.
+  bool treeMajor; ///< True iff walking tree blocks over the full row block.
+  bool fused; ///< True iff scores accumulate in place of final indices.
+  vector<double> sumAccum; ///< Per-row score sum, if tree-major or fused.
+  vector<unsigned int> nEstAccum; ///< Per-row # participating trees.
+  vector<double> blockSum; ///< Per-tree-block partial sums, if tree-major.
+  vector<unsigned int> blockEst; ///< Per-tree-block tree counts, " ".
+  vector<BinnedForest::BinT> blockBin; ///< Binned block, if quantized.
+  vector<IndexT> idxCache; ///< Final indices over all rows, if permuting.
 
   void predictBlock(ForestPrediction* prediction);
 
@@ -209,6 +260,23 @@ protected:
   void resetIndices();
 
 
+  /**
+     @brief Bins the rows of the current block against the quantized forest.
+   */
+  void binBlock(const BinnedForest* binnedForest,
+		size_t span);
+
+
+  /**
+     @brief Walks every row of the current block through successive
+     blocks of trees, accumulating per-block partial score sums.
+
+     @param span is the number of rows in the block.
+   */
+  void walkTreeMajor(const PredictFrame& frame,
+		     size_t span);
+
+
   void walkTree(const PredictFrame& frame,
 		size_t obsStart,
 		size_t obsEnd);
@@ -219,6 +287,13 @@ protected:
   }
 
 
+  /**
+     @brief Records the outcome of a tree walk:  either the final index
+     or, if fused, the score at that index.
+   */
+  void recordFinal(size_t obsIdx, unsigned int tIdx, IndexT finalIdx);
+
+
 public:
 
   static bool bagging; ///< True iff bagging.
@@ -287,6 +362,14 @@ public:
   }
 
 
+  /**
+     @return final indices of the full frame, row-major, if permuting.
+   */
+  const vector<IndexT>& getIdxCache() const {
+    return idxCache;
+  }
+
+
   bool isNodeIdx(size_t obsIdx,
 		 unsigned int tIdx,
 		 double& score) const;
@@ -308,6 +391,26 @@ public:
   }
 
 
+  /**
+     @brief Obtains the score sum accumulated by the tree-major walk.
+
+     @param[out] sumScore outputs the sum over participating trees.
+
+     @param[out] nEst outputs the number of participating trees.
+
+     @return true iff sums have been accumulated.
+   */
+  bool getAccumulated(size_t obsIdx,
+		      double& sumScore,
+		      unsigned int& nEst) const {
+    if (!treeMajor && !fused)
+      return false;
+    sumScore = sumAccum[obsIdx - blockStart];
+    nEst = nEstAccum[obsIdx - blockStart];
+    return true;
+  }
+
+
   /**
      @brief Determines whether a given forest coordinate is bagged.
 
@@ -318,7 +421,7 @@ public:
      @return true iff bagging and the coordinate bit is set.
    */
   inline bool isBagged(unsigned int tIdx, size_t row) const {
-    return bagging && bag->testBit(tIdx, row);
+    return bagging && bagWindow->testBit(tIdx, row - blockStart);
   }
 
   
@@ -333,36 +436,18 @@ public:
   /**
      @brief Computes Meinshausen's weight vectors for a block of predictions.
 
+     @param forest caches its per-node sample lists across calls.
+
      @param nPredict is tne number of predictions to weight.
 
      @param finalIdx is a block of nPredict x nTree prediction indices.
      
-     @return prediction-wide vector of response weights.
-   */
-  static vector<double> forestWeight(const class Forest* forest,
-					     const class Sampler* sampler,
-					     size_t nPredict,
-				     const double finalIdx[]);
-
-
-  static vector<vector<struct IdCount>> obsCounts(const class Forest* forest,
-						  const class Sampler* sampler,
-						  unsigned int tIdx);
-
-
-  static void weighNode(const class Forest* forest,
-			const double treeIdx[],
-			const vector<vector<struct IdCount>>& nodeCount,
-			vector<vector<double>>& obsWeight);
-
-
-  /**
-     @brief Normalizes each weight vector passed.
-
-     @return vector of normalized weight vectors.
+     @return sparse weights, by prediction row.
    */
-  static vector<double> normalizeWeight(const class Sampler* sampler,
-					const vector<vector<double>>& obsWeight);
+  static struct SparseWeight forestWeight(class Forest* forest,
+					  const class Sampler* sampler,
+					  size_t nPredict,
+					  const double finalIdx[]);
 };
 
 
@@ -44,6 +44,8 @@ const string PredictR::strBagging = "bagging";
 const string PredictR::strTrapUnobserved = "trapUnobserved";
 const string PredictR::strNThread = "nThread";
 const string PredictR::strCtgProb = "ctgProb";
+const string PredictR::strStage = "stage";
+const string PredictR::strShap = "shap";
 
 
 RcppExport SEXP predictRcpp(const SEXP sDeframe,
@@ -73,6 +75,68 @@ RcppExport SEXP validateRcpp(const SEXP sDeframe,
 }
 
 
+RcppExport SEXP rowHandleRcpp(const SEXP sTrain,
+			      const SEXP sNCtg,
+			      const SEXP sTrap) {
+  BEGIN_RCPP
+
+  return XPtr<RowHandle>(new RowHandle(List(sTrain), as<unsigned int>(sNCtg), as<bool>(sTrap)), true);
+
+  END_RCPP
+}
+
+
+RcppExport SEXP scoreRowsRcpp(const SEXP sHandle,
+			      const SEXP sX) {
+  BEGIN_RCPP
+
+  XPtr<RowHandle> handle(sHandle);
+  NumericMatrix x(sX);
+  if (static_cast<size_t>(x.ncol()) != handle->predMap.size())
+    stop("Row width does not conform with training");
+
+  NumericVector scores(x.nrow());
+  for (R_xlen_t row = 0; row < x.nrow(); row++) {
+    scores[row] = handle->score(&x[row], x.nrow());
+  }
+  return scores;
+
+  END_RCPP
+}
+
+
+RowHandle::RowHandle(const List& lTrain,
+		     unsigned int nCtg,
+		     bool trapUnobserved) :
+  predMap(as<vector<unsigned int>>(lTrain[TrainR::strPredMap])),
+  facCard(SignatureR::getCardinality(lTrain)),
+  nPredNum(predMap.size() - facCard.size()),
+  rowNum(vector<double>(nPredNum)),
+  rowFac(vector<unsigned int>(predMap.size() - nPredNum)) {
+  ForestBridge::init(predMap.size());
+  rowScorer = make_unique<RowScorerBridge>(ForestR::unwrap(lTrain, nCtg > 0), nCtg, nPredNum, rowFac.size(), trapUnobserved);
+  ForestBridge::deInit();
+}
+
+
+RowHandle::~RowHandle() = default;
+
+
+double RowHandle::score(const double row[],
+			size_t stride) {
+  for (unsigned int predIdx = 0; predIdx < nPredNum; predIdx++) {
+    rowNum[predIdx] = row[predMap[predIdx] * stride];
+  }
+  // As in prediction, levels absent from training take the proxy
+  // level, one beyond the cardinality.
+  for (unsigned int facIdx = 0; facIdx < rowFac.size(); facIdx++) {
+    double code = row[predMap[nPredNum + facIdx] * stride];
+    rowFac[facIdx] = (code >= 1 && code <= facCard[facIdx]) ? static_cast<unsigned int>(code) - 1 : facCard[facIdx];
+  }
+  return rowScorer->score(rowNum.data(), rowFac.data());
+}
+
+
 List PredictR::predict(const List& lDeframe,
 		       const List& lTrain,
 		       const List& lSampler,
@@ -209,7 +273,9 @@ List PredictR::getPrediction(const PredictRegBridge* pBridge) {
 				 _["yPred"] = pBridge->getYPred(),
 				 _["qPred"] = getQPred(pBridge),
 				 _["qEst"] = pBridge->getQEst(),
-				 _["indices"] = getIndices(pBridge)
+				 _["indices"] = getIndices(pBridge),
+				 _["staged"] = getStaged(pBridge),
+				 _["contrib"] = getContrib(pBridge)
 				 );
   prediction.attr("class") = "PredictReg";
   return prediction;
@@ -229,6 +295,28 @@ NumericMatrix PredictR::getIndices(const PredictRegBridge* pBridge) {
 }
 
 
+NumericMatrix PredictR::getStaged(const PredictRegBridge* pBridge) {
+  BEGIN_RCPP
+
+  size_t nObs = pBridge->getNObs();
+  const vector<double>& staged = pBridge->getStaged();
+  return staged.empty() ? NumericMatrix(0) : transpose(NumericMatrix(staged.size() / nObs, nObs, staged.begin()));
+
+  END_RCPP
+}
+
+
+NumericMatrix PredictR::getContrib(const PredictRegBridge* pBridge) {
+  BEGIN_RCPP
+
+  size_t nObs = pBridge->getNObs();
+  const vector<double>& contrib = pBridge->getContrib();
+  return contrib.empty() ? NumericMatrix(0) : transpose(NumericMatrix(contrib.size() / nObs, nObs, contrib.begin()));
+
+  END_RCPP
+}
+
+
 NumericMatrix PredictR::getQPred(const PredictRegBridge* pBridge) {
   BEGIN_RCPP
 
@@ -248,7 +336,8 @@ List PredictR::getValidation(const PredictRegBridge* pBridge,
   size_t nRow = yTestFE.length();
   List validation = List::create(_["mse"] = sse / nRow,
 				 _["rsq"] = nRow == 1 ? 0.0 : 1.0 - sse / (var(yTestFE) * (nRow - 1)),
-				 _["mae"] = pBridge->getSAE() / nRow
+				 _["mae"] = pBridge->getSAE() / nRow,
+				 _["stageLoss"] = pBridge->getStageLoss()
 				 );
   validation.attr("class") = "ValidReg";
   return validation;
@@ -369,7 +458,9 @@ List LeafCtgRf::getPrediction(const PredictCtgBridge* pBridge,
 				 _["yPred"] = yPredOne,
 				 _["census"] = getCensus(pBridge, levelsTrain, ctgNames),
 				 _["prob"] = getProb(pBridge, levelsTrain, ctgNames),
-				 _["indices"] = getIndices(pBridge)
+				 _["indices"] = getIndices(pBridge),
+				 _["staged"] = getStaged(pBridge),
+				 _["contrib"] = getContrib(pBridge)
 				 );
   prediction.attr("class") = "PredictCtg";
   return prediction;
@@ -387,12 +478,31 @@ NumericMatrix LeafCtgRf::getIndices(const PredictCtgBridge* pBridge) {
 }
 
 
+NumericMatrix LeafCtgRf::getStaged(const PredictCtgBridge* pBridge) {
+  BEGIN_RCPP
+  size_t nObs = pBridge->getNObs();
+  const vector<double>& staged = pBridge->getStaged();
+  return staged.empty() ? NumericMatrix(0) : transpose(NumericMatrix(staged.size() / nObs, nObs, staged.begin()));
+  END_RCPP
+}
+
+
+NumericMatrix LeafCtgRf::getContrib(const PredictCtgBridge* pBridge) {
+  BEGIN_RCPP
+  size_t nObs = pBridge->getNObs();
+  const vector<double>& contrib = pBridge->getContrib();
+  return contrib.empty() ? NumericMatrix(0) : transpose(NumericMatrix(contrib.size() / nObs, nObs, contrib.begin()));
+  END_RCPP
+}
+
+
 List TestCtgR::getValidation(const PredictCtgBridge* pBridge) {
   BEGIN_RCPP
   List validCtg = List::create(
 			       _["confusion"] = getConfusion(pBridge, levelsTrain),
 			       _["misprediction"] = getMisprediction(pBridge),
-			       _["oobError"] = pBridge->getOOBError()
+			       _["oobError"] = pBridge->getOOBError(),
+			       _["stageLoss"] = pBridge->getStageLoss()
 			       );
   validCtg.attr("class") = "ValidCtg";
   return validCtg;
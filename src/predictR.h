@@ -65,6 +65,67 @@ RcppExport SEXP validateRcpp(const SEXP sFrame,
 			     const SEXP sArgs);
 
 
+/**
+   @brief Prepares a handle for low-latency row scoring.
+
+   @param sTrain contains the trained object.
+
+   @param sNCtg is the response cardinality, if categorical, else zero.
+
+   @param sTrap is true iff missing values exit early.
+
+   @return external pointer to prepared handle.
+ */
+RcppExport SEXP rowHandleRcpp(const SEXP sTrain,
+			      const SEXP sNCtg,
+			      const SEXP sTrap);
+
+
+/**
+   @brief Scores each row of a numeric matrix against a prepared handle.
+
+   @param sHandle is the prepared handle.
+
+   @param sX is a numeric matrix with columns in training order.
+
+   @return vector of scores, one per row.
+ */
+RcppExport SEXP scoreRowsRcpp(const SEXP sHandle,
+			      const SEXP sX);
+
+
+/**
+   @brief Gathers user rows into core order and scores them.
+ */
+struct RowHandle {
+  unique_ptr<struct RowScorerBridge> rowScorer;
+  const vector<unsigned int> predMap; ///< Core to user predictor index.
+  const vector<unsigned int> facCard; ///< Training cardinality, per factor.
+  const unsigned int nPredNum; ///< # numeric predictors.
+  vector<double> rowNum; ///< Scratch row, numeric.
+  vector<unsigned int> rowFac; ///< Scratch row, factor.
+
+  RowHandle(const List& lTrain,
+	    unsigned int nCtg,
+	    bool trapUnobserved);
+
+
+  ~RowHandle();
+
+
+  /**
+     @brief Scores a single row.
+
+     @param row is the user row:  factor codes are one-based.  Missing
+     and out-of-range codes are treated as levels absent from training.
+
+     @param stride separates successive elements of the row.
+   */
+  double score(const double row[],
+	       size_t stride);
+};
+
+
 /**
    @bridge Prediction through unwrapped PredictBridge object.
  */
@@ -76,6 +137,8 @@ struct PredictR {
   static const string strTrapUnobserved;
   static const string strNThread;
   static const string strCtgProb;
+  static const string strStage;
+  static const string strShap;
 
 
   /**
@@ -151,6 +214,19 @@ struct PredictR {
 
   static NumericMatrix getIndices(const struct PredictRegBridge* pBridge);
 
+
+  /**
+     @return row-by-checkpoint matrix of staged scores, if staged, else empty.
+   */
+  static NumericMatrix getStaged(const struct PredictRegBridge* pBridge);
+
+
+  /**
+     @return row-by-predictor matrix of contributions, bias last, if
+     explaining, else empty.
+   */
+  static NumericMatrix getContrib(const struct PredictRegBridge* pBridge);
+
   
   /**
      @param varTest is the variance of the test vector.
@@ -224,6 +300,20 @@ struct LeafCtgRf {
 
   static NumericMatrix getIndices(const struct PredictCtgBridge* pBridge);
 
+
+  /**
+     @return row-by-checkpoint matrix of staged category-one probabilities,
+     if staged, else empty.
+   */
+  static NumericMatrix getStaged(const struct PredictCtgBridge* pBridge);
+
+
+  /**
+     @return row-by-predictor matrix of log-odds contributions, bias
+     last, if explaining, else empty.
+   */
+  static NumericMatrix getContrib(const struct PredictCtgBridge* pBridge);
+
   
   /**
      @brief Produces census summary, which is common to all categorical
@@ -35,6 +35,9 @@ SEXP PredictR::initPerInvocation(const List& lArgs) {
 			     as<unsigned int>(lArgs[strImpPermute]),
 			     as<bool>(lArgs[strTrapUnobserved]));
   PredictBridge::initCtgProb(as<bool>(lArgs[strCtgProb]));
+  if (!Rf_isNull(lArgs[strStage]))
+    PredictBridge::initStage(as<vector<unsigned int>>(lArgs[strStage]));
+  PredictBridge::initShap(as<bool>(lArgs[strShap]));
   PredictBridge::initOmp(as<unsigned int>(lArgs[strNThread]));
 
   END_RCPP
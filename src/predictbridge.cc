@@ -20,6 +20,7 @@
 #include "forest.h"
 #include "predict.h"
 #include "sampler.h"
+#include "rowscorer.h"
 
 // Type completion only:
 #include "dectree.h"
@@ -86,16 +87,32 @@ void PredictBridge::initCtgProb(bool doProb) {
 }
 
 
+void PredictBridge::initStage(vector<unsigned int> stage) {
+  FEPredict::initStage(std::move(stage));
+}
+
+
+void PredictBridge::initShap(bool doShap) {
+  FEPredict::initShap(doShap);
+}
+
+
 void PredictBridge::initOmp(unsigned int nThread) {
   FEPredict::initOmp(nThread);
 }
 
 
-vector<double> PredictBridge::forestWeight(const ForestBridge& forestBridge,
-					   const SamplerBridge& samplerBridge,
-					   const double indices[],
-					   size_t nObs) {
-  return Predict::forestWeight(forestBridge.getForest(), samplerBridge.getSampler(), nObs, indices);
+void PredictBridge::forestWeight(const ForestBridge& forestBridge,
+				 const SamplerBridge& samplerBridge,
+				 const double indices[],
+				 size_t nObs,
+				 vector<size_t>& rowHeight,
+				 vector<size_t>& obsIdx,
+				 vector<double>& weight) {
+  SparseWeight sparse = Predict::forestWeight(forestBridge.getForest(), samplerBridge.getSampler(), nObs, indices);
+  rowHeight = std::move(sparse.rowHeight);
+  obsIdx = std::move(sparse.obsIdx);
+  weight = std::move(sparse.weight);
 }
 
 
@@ -119,6 +136,36 @@ const vector<size_t>& PredictRegBridge::getIndices() const {
 }
 
 
+const vector<double>& PredictCtgBridge::getStaged() const {
+  return summary->getStaged();
+}
+
+
+const vector<double>& PredictRegBridge::getStaged() const {
+  return summary->getStaged();
+}
+
+
+const vector<double>& PredictCtgBridge::getContrib() const {
+  return summary->getContrib();
+}
+
+
+const vector<double>& PredictRegBridge::getContrib() const {
+  return summary->getContrib();
+}
+
+
+const vector<double>& PredictCtgBridge::getStageLoss() const {
+  return summary->stageLoss;
+}
+
+
+const vector<double>& PredictRegBridge::getStageLoss() const {
+  return summary->stageLoss;
+}
+
+
 size_t PredictRegBridge::getNObs() const {
   return summary->getNObs();
 }
@@ -212,3 +259,26 @@ vector<vector<double>> PredictRegBridge::getSSEPermuted() const {
 vector<vector<double>> PredictRegBridge::getSAEPermuted() const {
   return summary->getSAEPermuted();
 }
+
+
+RowScorerBridge::RowScorerBridge(ForestBridge&& forestBridge_,
+				 unsigned int nCtg,
+				 unsigned int nPredNum,
+				 unsigned int nPredFac,
+				 bool trapUnobserved) :
+  forestBridge(make_unique<ForestBridge>(std::move(forestBridge_))) {
+  // Walkers cache the trapping behavior at construction.
+  TreeNode::initTrap(trapUnobserved);
+  forestBridge->getForest()->initWalkers(PredictFrame(nPredNum, nPredFac));
+  TreeNode::initTrap(false);
+  rowScorer = make_unique<RowScorer>(forestBridge->getForest(), nCtg);
+}
+
+
+RowScorerBridge::~RowScorerBridge() = default;
+
+
+double RowScorerBridge::score(const double rowNum[],
+			      const unsigned int rowFac[]) {
+  return rowScorer->score(rowNum, rowFac);
+}
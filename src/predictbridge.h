@@ -58,6 +58,18 @@ struct PredictBridge {
   static void initCtgProb(bool doProb);
 
 
+  /**
+     @brief Initializes staged prediction at the given tree counts.
+   */
+  static void initStage(vector<unsigned int> stage);
+
+
+  /**
+     @brief Initializes TreeSHAP feature contributions.
+   */
+  static void initShap(bool doShap);
+
+
   static void initOmp(unsigned int nThread);
 
   
@@ -66,13 +78,20 @@ struct PredictBridge {
 
   /**
      @brief Computes Meinshausen-style weight vectors over a set of observations.
-     
-     @return vector of normalized weight vectors.
+
+     @param[out] rowHeight outputs the accumulated nonzero count, per row.
+
+     @param[out] obsIdx outputs the training observation of each nonzero.
+
+     @param[out] weight outputs the normalized nonzero weights.
    */
-  static vector<double> forestWeight(const struct ForestBridge& forestBridge,
-				     const struct SamplerBridge& samplerBridge,
-				     const double indices[],
-				     size_t nObs);
+  static void forestWeight(const struct ForestBridge& forestBridge,
+			   const struct SamplerBridge& samplerBridge,
+			   const double indices[],
+			   size_t nObs,
+			   vector<size_t>& rowHeight,
+			   vector<size_t>& obsIdx,
+			   vector<double>& weight);
 };
 
 
@@ -107,6 +126,24 @@ struct PredictRegBridge : public PredictBridge {
      @return reference to cached index vector.
    */
   const vector<size_t>& getIndices() const;
+
+
+  /**
+     @return reference to per-row staged scores, checkpoint-minor.
+   */
+  const vector<double>& getStaged() const;
+
+
+  /**
+     @return test loss at each checkpoint, if staged and validating.
+   */
+  const vector<double>& getStageLoss() const;
+
+
+  /**
+     @return reference to per-row contributions, predictor-minor.
+   */
+  const vector<double>& getContrib() const;
   
 
   double getSAE() const;
@@ -156,6 +193,24 @@ struct PredictCtgBridge : public PredictBridge {
      @return reference to cached index vector.
    */
   const vector<size_t>& getIndices() const;
+
+
+  /**
+     @return reference to per-row staged scores, checkpoint-minor.
+   */
+  const vector<double>& getStaged() const;
+
+
+  /**
+     @return test loss at each checkpoint, if staged and validating.
+   */
+  const vector<double>& getStageLoss() const;
+
+
+  /**
+     @return reference to per-row contributions, predictor-minor.
+   */
+  const vector<double>& getContrib() const;
   
 
   const vector<unsigned int>& getYPred() const;
@@ -197,4 +252,42 @@ struct PredictCtgBridge : public PredictBridge {
 };
 
 
+/**
+   @brief Prepared handle for low-latency scoring of individual rows.
+ */
+struct RowScorerBridge {
+
+  /**
+     @param forestBridge is consumed by the handle.
+
+     @param nCtg is the response cardinality, if categorical, else zero.
+
+     @param trapUnobserved is true iff missing values exit early.
+   */
+  RowScorerBridge(struct ForestBridge&& forestBridge,
+		  unsigned int nCtg,
+		  unsigned int nPredNum,
+		  unsigned int nPredFac,
+		  bool trapUnobserved);
+
+
+  ~RowScorerBridge();
+
+
+  /**
+     @brief Scores a single row, without allocation.
+
+     @param rowNum holds the numeric predictor values, in core order.
+
+     @param rowFac holds the zero-based factor levels, in core order.
+   */
+  double score(const double rowNum[],
+	       const unsigned int rowFac[]);
+
+private:
+  unique_ptr<struct ForestBridge> forestBridge; ///< Owns the forest.
+  unique_ptr<class RowScorer> rowScorer;
+};
+
+
 #endif
@@ -27,6 +27,14 @@ PredictFrame::PredictFrame(const RLEFrame* frame) :
 }
 
 
+PredictFrame::PredictFrame(PredictorT nPredNum_,
+			   PredictorT nPredFac_) :
+  nPredNum(nPredNum_),
+  nPredFac(nPredFac_),
+  baseObs(0) {
+}
+
+
 void PredictFrame::transpose(const RLEFrame* frame,
 			     size_t obsStart,
 			     size_t extent) {
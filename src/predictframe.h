@@ -39,6 +39,13 @@ public:
   PredictFrame(const class RLEFrame* frame);
 
 
+  /**
+     @brief Shape-only constructor, for callers supplying bare rows.
+   */
+  PredictFrame(PredictorT nPredNum_,
+	       PredictorT nPredFac_);
+
+
   void transpose(const class RLEFrame* frame,
 		 size_t obsStart,
 		 size_t obsExtent);
@@ -54,6 +61,14 @@ public:
   }
 
 
+  /**
+     @return # factor-valued predictors.
+   */
+  unsigned int getNPredFac() const {
+    return nPredFac;
+  }
+
+
   /**
      @brief Computes block-relative position for a predictor.
 
@@ -7,8 +7,15 @@
 #include "prediction.h"
 #include "quant.h"
 #include "response.h"
+#include "predictframe.h"
+#include "treeshap.h"
+
+#include <algorithm>
+#include <cmath>
 
 bool ForestPrediction::reportIndices = false;
+vector<unsigned int> ForestPrediction::stage;
+bool ForestPrediction::reportShap = false;
 bool CtgProb::reportProbabilities = false;
 
 
@@ -25,10 +32,60 @@ map<const string, function<void(ForestPredictionCtg*, const Predict*, size_t)>>
 
 
 ForestPrediction::ForestPrediction(const Predict* predict,
-				   const struct ScoreDesc* scoreDesc) :
+				   const struct ScoreDesc* scoreDesc,
+				   const Sampler* sampler,
+				   bool reportAuxiliary) :
   baseScore(scoreDesc->baseScore),
   nu(scoreDesc->nu),
-  idxFinal(vector<size_t>(reportIndices ? predict->getNTree() * predict->getNObs() : 0)) {
+  additive(scoreDesc->scorer == "sum" || scoreDesc->scorer == "logistic"),
+  idxFinal(vector<size_t>(reportIndices ? predict->getNTree() * predict->getNObs() : 0)),
+  staged(vector<double>(additive && reportAuxiliary ? stage.size() * predict->getNObs() : 0)) {
+  // Plurality votes are not a sum of tree scores, so are not explained.
+  if (reportShap && reportAuxiliary && scoreDesc->scorer != "plurality" && !predict->forest->getLeaf().empty()) {
+    treeShap = make_unique<TreeShap>(predict->forest, sampler, predict->getFrame(), scoreDesc);
+    contrib = vector<double>(predict->getNObs() * (treeShap->getNPred() + 1));
+  }
+}
+
+
+ForestPrediction::~ForestPrediction() {
+}
+
+
+void ForestPrediction::explain(const PredictFrame& frame,
+			       size_t obsStart,
+			       size_t obsEnd) {
+  if (treeShap == nullptr)
+    return;
+
+  size_t width = treeShap->getNPred() + 1;
+  for (size_t obsIdx = obsStart; obsIdx != obsEnd; obsIdx++) {
+    treeShap->explainRow(frame.baseNum(obsIdx), frame.baseFac(obsIdx), &contrib[obsIdx * width]);
+  }
+}
+
+
+ScoreCount ForestPrediction::sumStaged(const Predict* predict,
+				       size_t obsIdx) {
+  double sumScore = baseScore;
+  unsigned int nEst = 0;
+  double* stagedRow = &staged[obsIdx * stage.size()];
+  unsigned int stageIdx = 0;
+  for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
+    double score;
+    if (predict->isNodeIdx(obsIdx, tIdx, score)) {
+      sumScore += nu * score;
+      nEst++;
+    }
+    for (; stageIdx != stage.size() && stage[stageIdx] == tIdx + 1; stageIdx++) {
+      stagedRow[stageIdx] = sumScore;
+    }
+  }
+  for (; stageIdx != stage.size(); stageIdx++) { // Checkpoints beyond forest.
+    stagedRow[stageIdx] = sumScore;
+  }
+
+  return ScoreCount(nEst, sumScore);
 }
 
 
@@ -44,7 +101,7 @@ ForestPredictionCtg::ForestPredictionCtg(const ScoreDesc* scoreDesc,
 					 const Sampler* sampler,
 					 const Predict* predict,
 					 bool reportAuxiliary) :
-  ForestPrediction(predict, scoreDesc),
+  ForestPrediction(predict, scoreDesc, sampler, reportAuxiliary),
   scorer(scorerTable[scoreDesc->scorer]),
   nCtg(sampler->getNCtg()),
   prediction(Prediction<CtgT>(predict->getNObs())),
@@ -58,7 +115,7 @@ ForestPredictionReg::ForestPredictionReg(const ScoreDesc* scoreDesc,
 					 const Sampler* sampler,
 					 const Predict* predict,
 					 bool reportAuxiliary) :
-  ForestPrediction(predict, scoreDesc),
+  ForestPrediction(predict, scoreDesc, sampler, reportAuxiliary),
   scorer(scorerTable[scoreDesc->scorer]),
   prediction(Prediction<double>(predict->getNObs())),
   defaultPrediction(reinterpret_cast<const ResponseReg*>(sampler->getResponse())->getDefaultPrediction()),
@@ -66,14 +123,21 @@ ForestPredictionReg::ForestPredictionReg(const ScoreDesc* scoreDesc,
 }
 
 
+bool ForestPredictionReg::accumulates() const {
+  return additive && !reportIndices && quant->isEmpty() && staged.empty();
+}
+
+
 void ForestPredictionReg::predictMean(const Predict* predict, size_t obsIdx) {
   double sumScore = 0.0;
   unsigned int nEst = 0;
-  for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
-    double score;
-    if (predict->isNodeIdx(obsIdx, tIdx, score)) {
-      nEst++;
-      sumScore += score;
+  if (!predict->getAccumulated(obsIdx, sumScore, nEst)) {
+    for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
+      double score;
+      if (predict->isNodeIdx(obsIdx, tIdx, score)) {
+	nEst++;
+	sumScore += score;
+      }
     }
   }
   setScore(predict, obsIdx, ScoreCount(nEst, nEst > 0 ? sumScore / nEst : defaultPrediction));
@@ -81,27 +145,53 @@ void ForestPredictionReg::predictMean(const Predict* predict, size_t obsIdx) {
 
 
 void ForestPredictionReg::predictSum(const Predict* predict, size_t obsIdx) {
+  if (!staged.empty()) {
+    setScore(predict, obsIdx, sumStaged(predict, obsIdx));
+    return;
+  }
+
   double sumScore = baseScore;
   unsigned int nEst = 0;
-  for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
-    double score;
-    if (predict->isNodeIdx(obsIdx, tIdx, score)) {
-      sumScore += nu * score;
-      nEst++;
+  double treeSum;
+  if (predict->getAccumulated(obsIdx, treeSum, nEst)) {
+    sumScore += nu * treeSum;
+  }
+  else {
+    for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
+      double score;
+      if (predict->isNodeIdx(obsIdx, tIdx, score)) {
+	sumScore += nu * score;
+	nEst++;
+      }
     }
   }
   setScore(predict, obsIdx, ScoreCount(nEst, sumScore));
 }
 
 
-ScoreCount ForestPredictionCtg::predictLogOdds(const Predict* predict, size_t obsIdx) const {
+ScoreCount ForestPredictionCtg::predictLogOdds(const Predict* predict, size_t obsIdx) {
+  if (!staged.empty()) {
+    ScoreCount logOdds = sumStaged(predict, obsIdx);
+    // Staged log-odds are reported as probabilities.
+    for (size_t stageIdx = obsIdx * stage.size(); stageIdx != (obsIdx + 1) * stage.size(); stageIdx++) {
+      staged[stageIdx] = 1.0 / (1.0 + exp(-staged[stageIdx]));
+    }
+    return logOdds;
+  }
+
   double sumScore = baseScore;
   unsigned int nEst = 0;
-  for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
-    double score;
-    if (predict->isNodeIdx(obsIdx, tIdx, score)) {
-      sumScore += nu * score;
-      nEst++;
+  double treeSum;
+  if (predict->getAccumulated(obsIdx, treeSum, nEst)) {
+    sumScore += nu * treeSum;
+  }
+  else {
+    for (unsigned int tIdx = 0; tIdx != predict->getNTree(); tIdx++) {
+      double score;
+      if (predict->isNodeIdx(obsIdx, tIdx, score)) {
+	sumScore += nu * score;
+	nEst++;
+      }
     }
   }
   return ScoreCount(nEst, sumScore);
@@ -163,6 +253,17 @@ CtgT ForestPredictionCtg::argMaxJitter(const vector<double>& numVec) const {
   return argMax;
 }
 
+CtgT ForestPredictionCtg::accumCtg(const double accum[],
+				   unsigned int nEst) const {
+  if (additive)
+    return 1.0 / (1.0 + exp(-(baseScore + nu * accum[0]))) > 0.5 ? 1 : 0;
+  else if (nEst == 0)
+    return defaultPrediction;
+  else
+    return argMaxJitter(vector<double>(accum, accum + nCtg));
+}
+
+
 void ForestPredictionCtg::setScore(size_t obsIdx, ScoreCount score) {
   prediction.setScore(obsIdx, score.score.ctg);
 }
@@ -173,6 +274,15 @@ const vector<double>& ForestPredictionCtg::getProb() const {
 }
 
 
+double ForestPredictionReg::accumScore(double treeSum,
+				       unsigned int nEst) const {
+  if (additive)
+    return baseScore + nu * treeSum;
+  else
+    return nEst > 0 ? treeSum / nEst : defaultPrediction;
+}
+
+
 void ForestPredictionReg::setScore(const Predict* predict, size_t obsIdx, ScoreCount score) {
   prediction.setScore(obsIdx, score.score.num);
   // Relies on score having been assigned:
@@ -181,13 +291,17 @@ void ForestPredictionReg::setScore(const Predict* predict, size_t obsIdx, ScoreC
 
 
 unique_ptr<TestReg> ForestPredictionReg::test(const vector<double>& yTest) const {
+  return test(yTest, prediction.value);
+}
+
+
+unique_ptr<TestReg> ForestPredictionReg::test(const vector<double>& yTest,
+					      const vector<double>& yPred) const {
   if (yTest.empty())
     return make_unique<TestReg>();
 
   double absErr = 0.0;
   double SSE = 0.0;
-
-  const vector<double>& yPred = prediction.value;
   for (size_t obsIdx = 0; obsIdx != yTest.size(); obsIdx++) {
     double err = fabs(yTest[obsIdx] - yPred[obsIdx]);
     absErr += err;
@@ -198,17 +312,54 @@ unique_ptr<TestReg> ForestPredictionReg::test(const vector<double>& yTest) const
 }
 
 
+vector<double> ForestPredictionReg::stageLoss(const vector<double>& yTest) const {
+  vector<double> loss(staged.empty() ? 0 : stage.size());
+  for (size_t obsIdx = 0; obsIdx != yTest.size(); obsIdx++) {
+    for (unsigned int stageIdx = 0; stageIdx != loss.size(); stageIdx++) {
+      double err = yTest[obsIdx] - staged[obsIdx * stage.size() + stageIdx];
+      loss[stageIdx] += err * err;
+    }
+  }
+  for (double& stageLoss : loss)
+    stageLoss /= yTest.size();
+
+  return loss;
+}
+
 
 unique_ptr<TestCtg> ForestPredictionCtg::test(const vector<CtgT>& yTest) const {
+  return test(yTest, prediction.value);
+}
+
+
+unique_ptr<TestCtg> ForestPredictionCtg::test(const vector<CtgT>& yTest,
+					      const vector<CtgT>& yPred) const {
   if (yTest.empty())
     return make_unique<TestCtg>();
 
   unique_ptr<TestCtg> testCtg = make_unique<TestCtg>(nCtg, 1 + *max_element(yTest.begin(), yTest.end()));
-  testCtg->buildConfusion(yTest, prediction.value);
+  testCtg->buildConfusion(yTest, yPred);
   return testCtg;
 }
 
 
+vector<double> ForestPredictionCtg::stageLoss(const vector<CtgT>& yTest) const {
+  // Bounds probabilities away from zero and one.
+  const double eps = 1.0e-15;
+  vector<double> loss(staged.empty() ? 0 : stage.size());
+  for (size_t obsIdx = 0; obsIdx != yTest.size(); obsIdx++) {
+    for (unsigned int stageIdx = 0; stageIdx != loss.size(); stageIdx++) {
+      double p1 = min(max(staged[obsIdx * stage.size() + stageIdx], eps), 1.0 - eps);
+      loss[stageIdx] -= yTest[obsIdx] == 1 ? log(p1) : log(1.0 - p1);
+    }
+  }
+  for (double& stageLoss : loss)
+    stageLoss /= yTest.size();
+
+  return loss;
+}
+
+
 void TestCtg::buildConfusion(const vector<CtgT>& yTest,
 			     const vector<CtgT>& yPred) {
   for (size_t obsIdx = 0; obsIdx != yTest.size(); obsIdx++) {
@@ -324,8 +475,22 @@ void ForestPrediction::init(bool indexing) {
 }
 
 
+void ForestPrediction::initStage(vector<unsigned int> stage_) {
+  stage = std::move(stage_);
+  sort(stage.begin(), stage.end());
+  stage.erase(unique(stage.begin(), stage.end()), stage.end());
+}
+
+
+void ForestPrediction::initShap(bool doShap) {
+  reportShap = doShap;
+}
+
+
 void ForestPrediction::deInit() {
   reportIndices = false;
+  stage.clear();
+  reportShap = false;
 }
 
 
@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <vector>
 
 struct ScoreCount {
@@ -81,22 +82,65 @@ struct Prediction {
 
 struct ForestPrediction {
   static bool reportIndices;
+  static vector<unsigned int> stage; ///< Ascending tree-count checkpoints.
+  static bool reportShap; ///< Whether to compute feature contributions.
   
   const double baseScore;
   const double nu;
+  const bool additive; ///< True iff scorer sums nu-scaled tree scores.
 
   vector<size_t> idxFinal; ///< Final index of tree walk; auxilliary.
+  vector<double> staged; ///< Score at each checkpoint, by row; additive only.
+  unique_ptr<class TreeShap> treeShap; ///< Non-null iff explaining.
+  vector<double> contrib; ///< Per-predictor contributions and bias, by row.
   
   ForestPrediction(const class Predict* predict,
-		   const struct ScoreDesc* scoreDesc);
+		   const struct ScoreDesc* scoreDesc,
+		   const class Sampler* sampler,
+		   bool reportAuxiliary);
+
+
+  virtual ~ForestPrediction();
 
 
   static void init(bool doProb);
 
 
+  /**
+     @brief Enables feature contributions for scorers summing tree scores.
+   */
+  static void initShap(bool doShap);
+
+
+  /**
+     @brief Sets the checkpoints at which additive scores are staged.
+   */
+  static void initStage(vector<unsigned int> stage_);
+
+
   static void deInit();
 
 
+  /**
+     @brief Sums nu-scaled tree scores in tree order, recording the
+     running score as each checkpoint is reached.
+
+     @return final score, with participating tree count.
+   */
+  ScoreCount sumStaged(const class Predict* predict,
+		       size_t obsIdx);
+
+
+  /**
+     @brief Computes feature contributions for a range of rows.
+
+     @param frame holds the rows, transposed.
+   */
+  void explain(const class PredictFrame& frame,
+	       size_t obsStart,
+	       size_t obsEnd);
+
+
   /**
      @brief Caches final tree-walk indices.
    */
@@ -106,6 +150,12 @@ struct ForestPrediction {
 
 
   virtual void callScorer(const class Predict*, size_t obsStart, size_t obsEnd) = 0;
+
+
+  /**
+     @return true iff scoring requires only per-row score sums.
+   */
+  virtual bool accumulates() const = 0;
 };
 
 
@@ -127,6 +177,11 @@ struct ForestPredictionCtg : public ForestPrediction {
   vector<CtgT> census; ///< # trees per category, per observation.
   unique_ptr<class CtgProb> ctgProb; ///< probability, per category.
 
+
+  bool accumulates() const {
+    return additive && !reportIndices && staged.empty();
+  }
+
   ForestPredictionCtg(const struct ScoreDesc* scoreDesc,
 		      const class Sampler* sampler,
 		      const class Predict* predict,
@@ -134,7 +189,7 @@ struct ForestPredictionCtg : public ForestPrediction {
 
 
   ScoreCount predictLogOdds(const class Predict* predict,
-			    size_t obsIdx) const;
+			    size_t obsIdx);
 
 
   void predictLogistic(const class Predict* predict,
@@ -148,6 +203,17 @@ struct ForestPredictionCtg : public ForestPrediction {
   CtgT argMaxJitter(const vector<double>& numVec) const;
 
 
+  /**
+     @brief Derives a category from a row's accumulated tree scores.
+
+     @param accum is the log-odds sum if additive, else the jittered census.
+
+     @param nEst is the number of participating trees.
+   */
+  CtgT accumCtg(const double accum[],
+		unsigned int nEst) const;
+
+
   size_t getNObs() const {
     return prediction.getNObs();
   }
@@ -158,6 +224,19 @@ struct ForestPredictionCtg : public ForestPrediction {
 
   unique_ptr<struct TestCtg> test(const vector<CtgT>& yTest) const;
 
+
+  /**
+     @brief Tests an arbitrary prediction, such as under permutation.
+   */
+  unique_ptr<struct TestCtg> test(const vector<CtgT>& yTest,
+				  const vector<CtgT>& yPred) const;
+
+
+  /**
+     @return mean logistic loss of the staged probabilities, per checkpoint.
+   */
+  vector<double> stageLoss(const vector<CtgT>& yTest) const;
+
   
   const vector<double>& getProb() const;
 };
@@ -179,6 +258,9 @@ struct ForestPredictionReg : public ForestPrediction {
   unique_ptr<class Quant> quant; ///< Independent trees only.
 
 
+  bool accumulates() const;
+
+
   ForestPredictionReg(const struct ScoreDesc* scoreDesc,
 		      const class Sampler* sampler,
 		      const class Predict* predict,
@@ -195,6 +277,28 @@ struct ForestPredictionReg : public ForestPrediction {
 
   unique_ptr<struct TestReg> test(const vector<double>& yTest) const;
 
+
+  /**
+     @brief Tests an arbitrary prediction, such as under permutation.
+   */
+  unique_ptr<struct TestReg> test(const vector<double>& yTest,
+				  const vector<double>& yPred) const;
+
+
+  /**
+     @brief Derives a score from a row's summed tree scores.
+
+     @param nEst is the number of participating trees.
+   */
+  double accumScore(double treeSum,
+		    unsigned int nEst) const;
+
+
+  /**
+     @return mean squared error of the staged scores, per checkpoint.
+   */
+  vector<double> stageLoss(const vector<double>& yTest) const;
+
   
   double getValue(size_t obsIdx) const {
     return prediction.value[obsIdx];
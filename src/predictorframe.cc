@@ -35,7 +35,7 @@ PredictorFrame::PredictorFrame(unique_ptr<RLEFrame> rleFrame_,
   feIndex(mapPredictors(rleFrame->factorTop)),
   noRank(rleFrame->noRank),
   denseThresh(autoCompress * nObs),
-  row2Rank(vector<vector<IndexT>>(nPred)),
+  row2Rank(vector<RankMap>(nPred)),
   nonCompact(0),
   lengthCompact(0) {
   implExpl = denseBlock();
@@ -59,9 +59,19 @@ vector<Layout> PredictorFrame::denseBlock() {
 
 
 Layout PredictorFrame::surveyRanks(PredictorT predIdx) {
+  row2Rank[predIdx] = RankMap(nObs, getRankMax(predIdx) + 1);
+  Layout layout;
+  row2Rank[predIdx].visit([&](auto obs2Rank) {
+    layout = surveyRanks(predIdx, obs2Rank);
+  });
+  return layout;
+}
+
+
+template<typename rankType>
+Layout PredictorFrame::surveyRanks(PredictorT predIdx,
+				   rankType obs2Rank[]) const {
   IndexT rankMissing = rleFrame->findRankMissing(feIndex[predIdx]);
-  
-  row2Rank[predIdx] = vector<IndexT>(nObs);
   IndexT denseMax = 0; // Running maximum of run counts.
   PredictorT argMax = noRank;
   PredictorT rankPrev = noRank; // Forces write on first iteration.
@@ -84,9 +94,7 @@ Layout PredictorFrame::surveyRanks(PredictorT predIdx) {
     }
 
     // Piggybacks assignment of rank vector.
-    for (IndexT idx = 0; idx != extent; idx++) {
-      row2Rank[predIdx][rle.row + idx] = rank;
-    }
+    fill(obs2Rank + rle.row, obs2Rank + rle.row + extent, rank);
   }
 
   // Post condition:  rowTot == nObs.
@@ -18,6 +18,7 @@
 
 #include "typeparam.h"
 #include "rleframe.h"
+#include "rankmap.h"
 
 #include <vector>
 #include <cmath>
@@ -63,7 +64,7 @@ class PredictorFrame {
   const PredictorT noRank; // Inattainable rank value.
   const IndexT denseThresh; // Threshold run length for autocompression.
 
-  vector<vector<IndexT>> row2Rank;
+  vector<RankMap> row2Rank; ///< Narrowest width holding rank count.
   PredictorT nonCompact;  // Total count of uncompactified predictors.
   IndexT lengthCompact;  // Sum of compactified lengths.
   vector<Layout> implExpl;
@@ -117,6 +118,16 @@ class PredictorFrame {
    */
   Layout surveyRanks(PredictorT predIdx);
 
+
+  /**
+     @brief As above, but over typed rank storage.
+
+     @param[out] obs2Rank outputs the rank of each observation.
+   */
+  template<typename rankType>
+  Layout surveyRanks(PredictorT predIdx,
+		     rankType obs2Rank[]) const;
+
   
 public:
 
@@ -231,7 +242,7 @@ public:
   }
 
 
-  const vector<IndexT>& getRanks(PredictorT predIdx) const {
+  const RankMap& getRanks(PredictorT predIdx) const {
     return row2Rank[predIdx];
   }
 
@@ -241,13 +252,16 @@ public:
   }
   
 
-  const vector<RLEVal<szType>>& getRLE(PredictorT predIdx) const {
+  const ArraySpan<RLEVal<szType>>& getRLE(PredictorT predIdx) const {
     return rleFrame->getRLE(feIndex[predIdx]);
   }
 
 
+  /**
+     @return highest rank of a predictor, as indexed into its ranked values.
+   */
   inline IndexT getRankMax(PredictorT predIdx) const {
-    return rleFrame->getRLE(feIndex[predIdx]).back().val;
+    return rleFrame->getRankCount(feIndex[predIdx]) - 1;
   }
 
   
@@ -109,6 +109,30 @@ void PreTree::critCut(const SplitFrontier* sf,
 }
 
 
+// Criterion setters are defined here, among the training sources,
+// so that TreeNode's own translation unit links without them.
+void TreeNode::critCut(const SplitNux& nux,
+		       const class SplitFrontier* splitFrontier) {
+  setPredIdx(nux.getPredIdx());
+  criterion.critCut(nux, splitFrontier);
+}
+
+
+void TreeNode::critBits(const SplitNux& nux,
+			size_t bitPos) {
+  setPredIdx(nux.getPredIdx());
+  criterion.critBits(bitPos);
+}
+
+
+void TreeNode::setQuantRank(const PredictorFrame* frame) {
+  PredictorT predIdx = getPredIdx();
+  if (isNonterminal() && !frame->isFactor(predIdx)) {
+    criterion.setQuantRank(frame, predIdx);
+  }
+}
+
+
 void PreTree::setScore(const IndexSet& iSet,
 		       double score) {
   scores[iSet.getPTId()] = score;
@@ -18,6 +18,7 @@
 #define CORE_PRNG_H
 
 #include <vector>
+#include <cstdint>
 using namespace std;
 
 namespace PRNG {
@@ -53,6 +54,24 @@ namespace PRNG {
      @return scaled copy of random variates, as index vector.
    */
   vector<size_t> rUnifIndex(const vector<size_t>& scale);
+
+
+  /**
+     @brief Diverts the calling thread's variates to a private engine
+     for the lifetime of the scope.
+
+     Worker threads may not call back into the front end, so a seed
+     is drawn beforehand from the session's generator, by the master.
+   */
+  class LocalScope {
+  public:
+    /**
+       @param seed is a uniform variate, typically drawn via rUnif().
+     */
+    LocalScope(double seed);
+
+    ~LocalScope();
+  };
 }
 
 #endif
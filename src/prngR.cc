@@ -25,11 +25,47 @@
 
 #include "prng.h"
 
+#include <random>
+#include <memory>
+
 #include <Rcpp.h>
 using namespace Rcpp;
 
 
+/**
+   @brief Per-thread engine, installed by LocalScope.  Null iff
+   variates are to be drawn from the R session.
+ */
+static thread_local unique_ptr<mt19937_64> localEngine;
+
+
+/**
+   @brief Draws scaled uniform variates from the thread-local engine.
+ */
+static vector<double> localUnif(size_t len,
+				double scale) {
+  uniform_real_distribution<double> unif(0.0, scale);
+  vector<double> rn(len);
+  for (auto & ru : rn)
+    ru = unif(*localEngine);
+  return rn;
+}
+
+
+PRNG::LocalScope::LocalScope(double seed) {
+  localEngine = make_unique<mt19937_64>(static_cast<uint64_t>(seed * 9007199254740992.0)); // 2^53.
+}
+
+
+PRNG::LocalScope::~LocalScope() {
+  localEngine = nullptr;
+}
+
+
 vector<double> PRNG::rUnif(size_t len, double scale) {
+  if (localEngine)
+    return localUnif(len, scale);
+
   double dLen = len; // May be necessary for values > 2^32.
   RNGScope scope;
   NumericVector rn(runif(dLen));
@@ -41,6 +77,11 @@ vector<double> PRNG::rUnif(size_t len, double scale) {
 
 
 vector<size_t> PRNG::rUnifIndex(size_t len, size_t scale) {
+  if (localEngine) {
+    vector<double> rn = localUnif(len, scale);
+    return vector<size_t>(rn.begin(), rn.end());
+  }
+
   double dLen = len; // May be necessary for values > 2^32.
   RNGScope scope;
   NumericVector rn(runif(dLen));
@@ -51,6 +92,14 @@ vector<size_t> PRNG::rUnifIndex(size_t len, size_t scale) {
 
 
 vector<size_t> PRNG::rUnifIndex(const vector<size_t>& scale) {
+  if (localEngine) {
+    vector<double> rn = localUnif(scale.size(), 1.0);
+    vector<size_t> rnOut(rn.size());
+    for (size_t i = 0; i < rn.size(); i++)
+      rnOut[i] = rn[i] * scale[i];
+    return rnOut;
+  }
+
   double dLen = scale.size(); // May be necessary for values > 2^32.
   RNGScope scope;
   NumericVector scaleCopy(scale.begin(), scale.end());
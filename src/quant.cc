@@ -49,11 +49,45 @@ Quant::Quant(const Sampler* sampler,
   leafDom((empty || !trapAndBail) ? vector<vector<IndexRange>>(0) : predict->forest->leafDominators()), 
   valRank(RankedObs<double>(&(reinterpret_cast<const ResponseReg*>(sampler->getResponse())->getYTrain())[0],
 			    empty ? 0 : reinterpret_cast<const ResponseReg*>(sampler->getResponse())->getYTrain().size())),
-  rankCount(empty ? vector<vector<vector<RankCount>>>(0) : leaf.alignRanks(sampler, valRank.rank())),
   rankScale(empty ? 0 : binScale()),
   binMean(empty ? vector<double>(0) : binMeans(valRank)),
   qPred(vector<double>(empty ? 0 : predict->getNObs() * qCount)),
   qEst(vector<double>(empty ? 0 : predict->getNObs())) {
+  if (!empty)
+    binLeaves(sampler);
+}
+
+
+void Quant::binLeaves(const Sampler* sampler) {
+  vector<vector<vector<RankCount>>> rankCount = leaf.alignRanks(sampler, valRank.rank());
+  histHeight.push_back(0);
+  for (const vector<vector<RankCount>>& treeRanks : rankCount) {
+    leafBase.push_back(leafTot.size());
+    for (const vector<RankCount>& leafRanks : treeRanks) {
+      size_t histStart = binCount.size();
+      IndexT sampleTot = 0;
+      for (RankCount rc : leafRanks) {
+	binCount.emplace_back(binRank(rc.getRank()), rc.getSCount());
+	sampleTot += rc.getSCount();
+      }
+
+      // Merges samples sharing a bin.
+      sort(binCount.begin() + histStart, binCount.end(), [](const BinCount& a, const BinCount& b) {
+	  return a.bin < b.bin;
+	});
+      size_t histEnd = histStart;
+      for (size_t idx = histStart; idx != binCount.size(); idx++) {
+	if (histEnd > histStart && binCount[histEnd - 1].bin == binCount[idx].bin)
+	  binCount[histEnd - 1].sCount += binCount[idx].sCount;
+	else
+	  binCount[histEnd++] = binCount[idx];
+      }
+      binCount.resize(histEnd, BinCount(0, 0));
+      histHeight.push_back(histEnd);
+      leafTot.push_back(sampleTot);
+    }
+  }
+  binCount.shrink_to_fit();
 }
 
 
@@ -90,7 +124,12 @@ void Quant::predictRow(const Predict* predict,
 		       size_t obsIdx) {
   if (isEmpty())
     return;
-  vector<IndexT> sCountBin(std::min(static_cast<IndexT>(binSize), valRank.getRankCount()));
+
+  // Per-thread bins are reused across rows, and left cleared.
+  static thread_local vector<IndexT> sCountBin;
+  if (sCountBin.size() < binMean.size())
+    sCountBin.resize(binMean.size());
+
   IndexT totSamples = 0;
   if (trapAndBail) {
     for (unsigned int tIdx = 0; tIdx < predict->getNTree(); tIdx++) {
@@ -98,7 +137,7 @@ void Quant::predictRow(const Predict* predict,
       if (predict->getFinalIdx(obsIdx, tIdx, nodeIdx)) {
 	IndexRange leafRange = leafDom[tIdx][nodeIdx];
 	for (IndexT leafIdx = leafRange.getStart(); leafIdx != leafRange.getEnd(); leafIdx++) {
-	  totSamples += sampleLeaf(tIdx, leafIdx, sCountBin);
+	  totSamples += sampleLeaf(tIdx, leafIdx, sCountBin.data());
 	}
       }
     }
@@ -107,50 +146,39 @@ void Quant::predictRow(const Predict* predict,
     for (unsigned int tIdx = 0; tIdx < predict->getNTree(); tIdx++) {
       IndexT leafIdx;
       if (predict->isLeafIdx(obsIdx, tIdx, leafIdx)) {
-	totSamples += sampleLeaf(tIdx, leafIdx, sCountBin);
+	totSamples += sampleLeaf(tIdx, leafIdx, sCountBin.data());
       }
     }
   }
-  // Builds sample-count thresholds for each quantile.
-  vector<double> countThreshold(qCount);
-  unsigned int qSlot = 0;
-  for (auto & thresh : countThreshold) {
-    thresh = totSamples * quantile[qSlot++];  // Rounding properties?
-  }
 
-  // Fills in quantile estimates.
-  quantSamples(prediction, sCountBin, countThreshold, totSamples, obsIdx);
+  quantSamples(prediction, sCountBin.data(), totSamples, obsIdx);
+  fill(sCountBin.begin(), sCountBin.begin() + binMean.size(), 0);
 }
 
 
 IndexT Quant::sampleLeaf(unsigned int tIdx,
 			 IndexT leafIdx,
-			 vector<IndexT>& sCountBin) const {
-  IndexT sampleTot = 0;
-  // sampleTot can be precomputed and cached, but rank traversal is
-  // irregular.
-  for (RankCount rc : rankCount[tIdx][leafIdx]) {
-    sCountBin[binRank(rc.getRank())] += rc.getSCount();
-    sampleTot += rc.getSCount();
+			 IndexT sCountBin[]) const {
+  size_t leafPos = leafBase[tIdx] + leafIdx;
+  for (size_t idx = histHeight[leafPos]; idx != histHeight[leafPos + 1]; idx++) {
+    sCountBin[binCount[idx].bin] += binCount[idx].sCount;
   }
-  return sampleTot; // Single leaf, so fits in IndexT.
+  return leafTot[leafPos]; // Single leaf, so fits in IndexT.
 }
 
 
 void Quant::quantSamples(const ForestPredictionReg* prediction,
-			 const vector<IndexT>& sCountBin,
-                         const vector<double>& threshold,
+			 const IndexT sCountBin[],
 			 IndexT totSample,
 			 size_t obsIdx) {
   unsigned int qSlot = 0;
-  unsigned int binIdx = 0;
   IndexT samplesSeen = 0;
   IndexT leftSamples = 0; // # samples with y-values <= yPred.
   double yPred = prediction->getValue(obsIdx);
   double* qRow = &qPred[qCount * obsIdx];
-  for (auto sc : sCountBin) {
-    samplesSeen += sc;
-    while (qSlot < qCount && samplesSeen >= threshold[qSlot]) {
+  for (unsigned int binIdx = 0; binIdx != binMean.size(); binIdx++) {
+    samplesSeen += sCountBin[binIdx];
+    while (qSlot < qCount && samplesSeen >= totSample * quantile[qSlot]) {
       qRow[qSlot++] = binMean[binIdx];
     }
     if (yPred > binMean[binIdx]) {
@@ -158,7 +186,6 @@ void Quant::quantSamples(const ForestPredictionReg* prediction,
     }
     else if (qSlot >= qCount)
       break;
-    binIdx++;
   }
 
   qEst[obsIdx] = static_cast<double>(leftSamples) / totSample;
@@ -25,6 +25,21 @@
 #include <vector>
 
 
+/**
+   @brief Sample count at a binned rank.
+ */
+struct BinCount {
+  unsigned int bin; ///< Binned rank.
+  IndexT sCount; ///< # samples at bin.
+
+  BinCount(unsigned int bin_,
+	   IndexT sCount_) :
+    bin(bin_),
+    sCount(sCount_) {
+  }
+};
+
+
 /**
  @brief Quantile signature.
 */
@@ -37,9 +52,12 @@ class Quant {
   const bool trapAndBail; ///< Whether nonterminal exit permitted.
   const vector<vector<IndexRange>> leafDom;
   const RankedObs<double> valRank;
-  const vector<vector<vector<RankCount>>> rankCount; // forest-wide, by sample.
   const unsigned int rankScale; // log2 of scaling factor.
   const vector<double> binMean;
+  vector<size_t> leafBase; ///< Forest-wide position of tree's first leaf.
+  vector<size_t> histHeight; ///< Accumulated histogram extent, per leaf.
+  vector<BinCount> binCount; ///< Leaf histograms, bin-ascending.
+  vector<IndexT> leafTot; ///< Sample count, per leaf.
   vector<double> qPred; // predicted quantiles.
   vector<double> qEst; // quantile of response estimates.
   
@@ -75,39 +93,41 @@ n     @brief Bins response means.
    */
   vector<double> binMeans(const RankedObs<double>& valRank) const;
 
+
+  /**
+     @brief Builds the binned histogram of each leaf, once per model.
+   */
+  void binLeaves(const class Sampler* sampler);
+
   
   /**
      @brief Writes quantile values for a row of predictions.
 
-     @param sCount is a bin of ranked sample counts.
-
-     @param threshold is the sample count threshold for a given quantile.
-
-     @param yPred is the predicted response for the current row.
+     @param sCountBin holds the ranked sample counts, by bin.
 
-     @param[out] qRow[] outputs the derived quantiles.
+     @param totSample is the total sample count, from which the
+     count threshold of each quantile derives.
    */
   void quantSamples(const class ForestPredictionReg* prediction,
-		    const vector<IndexT>& sCount,
-		    const vector<double>& threshold,
+		    const IndexT sCountBin[],
 		    IndexT totSample,
 		    size_t obsIdx);
   
 
   /**
-     @brief Accumulates the ranks assocated with predicted leaf.
+     @brief Accumulates the histogram of a predicted leaf.
 
      @param tIdx is a tree index.
 
      @param leafIdx is a tree-relative leaf index.
 
-     @param[in,out] sCount counts the number of samples at a (binned) rank.
+     @param[in,out] sCountBin counts the number of samples at a (binned) rank.
 
      @return count of samples subsumed by leaf.
   */
   IndexT sampleLeaf(unsigned int tIdx,
 		    IndexT leafIdx,
-		    vector<IndexT>& scountBin) const;
+		    IndexT sCountBin[]) const;
 
 
 public:
@@ -0,0 +1,121 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file quickscorer.cc
+
+   @brief Builds and applies the bitvector representation.
+
+   @author Mark Seligman
+ */
+
+#include "quickscorer.h"
+#include "dectree.h"
+#include "predictframe.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+bool QuickScorer::eligible(const vector<DecTree>& decTree,
+			   const PredictFrame& frame) {
+  if (frame.getNPredFac() != 0 || DecNode::trapAndBail())
+    return false;
+
+  for (const DecTree& tree : decTree) {
+    IndexT nLeaf = 0;
+    for (const DecNode& node : tree.getNode()) {
+      nLeaf += node.isTerminal() ? 1 : 0;
+    }
+    if (nLeaf > leafMax)
+      return false;
+  }
+  return true;
+}
+
+
+QuickScorer::QuickScorer(const vector<DecTree>& decTree,
+			 PredictorT nPredNum) :
+  nTree(decTree.size()),
+  predOffset(vector<size_t>(nPredNum + 1)),
+  leafNode(vector<vector<IndexT>>(nTree)) {
+  vector<QSCond> cond;
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    (void) mapLeaves(decTree[tIdx], tIdx, 0, 0, cond);
+  }
+
+  stable_sort(cond.begin(), cond.end(),
+	      [](const QSCond& a, const QSCond& b) {
+		return a.predIdx < b.predIdx || (a.predIdx == b.predIdx && a.split < b.split);
+	      });
+  for (const QSCond& qc : cond) {
+    condSplit.push_back(qc.split);
+    condTree.push_back(qc.tIdx);
+    condMask.push_back(qc.mask);
+    condNaNTrue.push_back(qc.nanTrue ? 1 : 0);
+    predOffset[qc.predIdx + 1]++;
+  }
+  for (PredictorT predIdx = 0; predIdx < nPredNum; predIdx++) {
+    predOffset[predIdx + 1] += predOffset[predIdx];
+  }
+}
+
+
+unsigned int QuickScorer::mapLeaves(const DecTree& tree,
+				    unsigned int tIdx,
+				    IndexT nodeIdx,
+				    unsigned int leafStart,
+				    vector<QSCond>& cond) {
+  const DecNode& node = tree.getNode()[nodeIdx];
+  if (node.isTerminal()) {
+    leafNode[tIdx].push_back(nodeIdx);
+    return leafStart + 1;
+  }
+
+  IndexT idxTrue = nodeIdx + node.getDelIdx();
+  unsigned int trueEnd = mapLeaves(tree, tIdx, idxTrue, leafStart, cond);
+  uint64_t trueBits = (trueEnd - leafStart == leafMax) ? ~0ull : ((1ull << (trueEnd - leafStart)) - 1) << leafStart;
+  // NaN fails both the <= test and its inverted counterpart.
+  cond.push_back(QSCond{node.getPredIdx(), node.getSplitNum(), tIdx, ~trueBits, node.delInvert(false) == node.getDelIdx()});
+
+  return mapLeaves(tree, tIdx, idxTrue + 1, trueEnd, cond);
+}
+
+
+void QuickScorer::walkRow(const PredictFrame& frame,
+			  size_t obsIdx,
+			  uint64_t leafBits[],
+			  IndexT idxOut[]) const {
+  walkRow(frame.baseNum(obsIdx), leafBits, idxOut);
+}
+
+
+void QuickScorer::walkRow(const double rowNum[],
+			  uint64_t leafBits[],
+			  IndexT idxOut[]) const {
+  fill(leafBits, leafBits + nTree, ~0ull);
+  for (PredictorT predIdx = 0; predIdx + 1 < predOffset.size(); predIdx++) {
+    double numVal = rowNum[predIdx];
+    size_t condEnd = predOffset[predIdx + 1];
+    if (std::isnan(numVal)) {
+      for (size_t condIdx = predOffset[predIdx]; condIdx < condEnd; condIdx++) {
+	if (!condNaNTrue[condIdx])
+	  leafBits[condTree[condIdx]] &= condMask[condIdx];
+      }
+    }
+    else {
+      // Tests fail for precisely those thresholds lying below the value.
+      for (size_t condIdx = predOffset[predIdx]; condIdx < condEnd && condSplit[condIdx] < numVal; condIdx++) {
+	leafBits[condTree[condIdx]] &= condMask[condIdx];
+      }
+    }
+  }
+
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    idxOut[tIdx] = leafNode[tIdx][__builtin_ctzll(leafBits[tIdx])];
+  }
+}
@@ -0,0 +1,106 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file quickscorer.h
+
+   @brief Bitvector traversal of shallow, numeric-only forests.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_QUICKSCORER_H
+#define FOREST_QUICKSCORER_H
+
+#include "typeparam.h"
+
+#include <vector>
+#include <cstdint>
+
+
+/**
+   @brief Node condition, prior to sorting by predictor and threshold.
+ */
+struct QSCond {
+  PredictorT predIdx;
+  double split;
+  unsigned int tIdx;
+  uint64_t mask;
+  bool nanTrue;
+};
+
+
+/**
+   @brief QuickScorer-style traversal:  trees are not walked node by node
+   but rather visited by predictor, in order of increasing threshold.
+
+   Each tree maintains a bitvector of its candidate exit leaves, ordered
+   left to right.  A node whose test fails clears the leaves of its true
+   branch, whereupon the exit leaf is the lowest bit remaining.
+ */
+class QuickScorer {
+  const unsigned int nTree;
+  vector<size_t> predOffset; ///< Per-predictor condition start, plus terminal.
+  vector<double> condSplit; ///< Thresholds, ascending within predictor.
+  vector<unsigned int> condTree; ///< Tree of condition.
+  vector<uint64_t> condMask; ///< Clears leaves of true branch.
+  vector<unsigned char> condNaNTrue; ///< True iff NaN takes true branch.
+  vector<vector<IndexT>> leafNode; ///< Per-tree node index of each leaf.
+
+
+  /**
+     @brief Maps the leaves below a node and accumulates its conditions.
+
+     @param[out] cond collects the conditions, unsorted.
+
+     @return position following the last leaf mapped.
+   */
+  unsigned int mapLeaves(const class DecTree& tree,
+			 unsigned int tIdx,
+			 IndexT nodeIdx,
+			 unsigned int leafStart,
+			 vector<QSCond>& cond);
+
+public:
+  static constexpr unsigned int leafMax = 64; ///< Bits per tree.
+
+  /**
+     @brief Determines whether traversal can be by bitvector.
+
+     @return true iff frame is numeric, missing data is not trapped and
+     no tree has more than leafMax leaves.
+   */
+  static bool eligible(const vector<class DecTree>& decTree,
+		       const class PredictFrame& frame);
+
+
+  QuickScorer(const vector<class DecTree>& decTree,
+	      PredictorT nPredNum);
+
+
+  /**
+     @brief Traverses all trees for a single observation.
+
+     @param leafBits is a scratch buffer of nTree slots.
+
+     @param[out] idxOut outputs the per-tree exit node index.
+   */
+  void walkRow(const class PredictFrame& frame,
+	       size_t obsIdx,
+	       uint64_t leafBits[],
+	       IndexT idxOut[]) const;
+
+
+  /**
+     @brief As above, but over a bare row of numeric values.
+   */
+  void walkRow(const double rowNum[],
+	       uint64_t leafBits[],
+	       IndexT idxOut[]) const;
+};
+
+#endif
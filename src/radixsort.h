@@ -0,0 +1,150 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file radixsort.h
+
+   @brief Stable least-significant-digit radix sort of value/row pairs.
+
+   @author Mark Seligman
+ */
+
+
+#ifndef DEFRAME_RADIXSORT_H
+#define DEFRAME_RADIXSORT_H
+
+#include "ompthread.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Maps values to unsigned keys having the same ordering.
+ */
+template<typename valType>
+struct RadixKey;
+
+
+/**
+   @brief Order-preserving bit transform of IEEE doubles.
+
+   Negative values have all bits flipped and nonnegative values have
+   the sign bit set, so that keys compare as the values do.  Signed
+   zeroes share a key, as they compare equal, and every NaN maps to the
+   greatest key, so that NaNs sort last and tie with one another.
+ */
+template<>
+struct RadixKey<double> {
+  typedef uint64_t keyType;
+
+  static keyType key(double val) {
+    if (isnan(val))
+      return ~keyType(0);
+    if (val == 0.0)
+      val = 0.0;
+    keyType bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return (bits >> 63) ? ~bits : (bits | (keyType(1) << 63));
+  }
+};
+
+
+/**
+   @brief Factor codes are their own keys.
+ */
+template<>
+struct RadixKey<unsigned int> {
+  typedef uint32_t keyType;
+
+  static keyType key(unsigned int val) {
+    return val;
+  }
+};
+
+
+/**
+   @brief Sorts records on the key of their 'val' member.
+
+   Input in row order therefore emerges ordered on value, then row.
+   Digits are eight bits wide and passes in which every key shares a
+   digit are skipped.  With more than one thread, each pass counts and
+   scatters contiguous chunks concurrently, with per-chunk bucket
+   offsets preserving stability.
+ */
+class RadixSort {
+  static constexpr unsigned int digitBits = 8;
+  static constexpr unsigned int nBucket = 1 << digitBits;
+
+public:
+
+  /**
+     @brief Records shorter than this are left to comparison sorting.
+   */
+  static constexpr size_t radixMin = 0x400;
+
+
+  /**
+     @param nThread is the number of threads over which to sort.
+   */
+  template<typename recType>
+  static void sort(vector<recType>& rec,
+		   unsigned int nThread) {
+    typedef RadixKey<decltype(rec[0].val)> Key;
+    typedef typename Key::keyType keyType;
+    size_t nRec = rec.size();
+    OMPBound nChunk = max<size_t>(1, min<size_t>(nThread, nRec / radixMin));
+    size_t chunkSize = (nRec + nChunk - 1) / nChunk;
+    vector<recType> buf(rec);
+    vector<size_t> bucketOff(nChunk * nBucket);
+
+    for (unsigned int shift = 0; shift < 8 * sizeof(keyType); shift += digitBits) {
+      fill(bucketOff.begin(), bucketOff.end(), 0);
+#pragma omp parallel for default(shared) schedule(static, 1) num_threads(nChunk) if(nChunk > 1)
+      for (OMPBound chunk = 0; chunk < nChunk; chunk++) {
+	size_t* count = &bucketOff[chunk * nBucket];
+	size_t recEnd = min(nRec, (chunk + 1) * chunkSize);
+	for (size_t idx = chunk * chunkSize; idx < recEnd; idx++) {
+	  count[(Key::key(rec[idx].val) >> shift) & (nBucket - 1)]++;
+	}
+      }
+
+      // Exclusive prefix sums, bucket-major then chunk-minor.
+      size_t offset = 0;
+      bool trivial = false;
+      for (unsigned int bucket = 0; bucket < nBucket; bucket++) {
+	size_t bucketStart = offset;
+	for (OMPBound chunk = 0; chunk < nChunk; chunk++) {
+	  size_t count = bucketOff[chunk * nBucket + bucket];
+	  bucketOff[chunk * nBucket + bucket] = offset;
+	  offset += count;
+	}
+	if (offset - bucketStart == nRec)
+	  trivial = true;
+      }
+      if (trivial) // Pass would not reorder.
+	continue;
+
+#pragma omp parallel for default(shared) schedule(static, 1) num_threads(nChunk) if(nChunk > 1)
+      for (OMPBound chunk = 0; chunk < nChunk; chunk++) {
+	size_t* offChunk = &bucketOff[chunk * nBucket];
+	size_t recEnd = min(nRec, (chunk + 1) * chunkSize);
+	for (size_t idx = chunk * chunkSize; idx < recEnd; idx++) {
+	  buf[offChunk[(Key::key(rec[idx].val) >> shift) & (nBucket - 1)]++] = rec[idx];
+	}
+      }
+      rec.swap(buf);
+    }
+  }
+};
+
+#endif
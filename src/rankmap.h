@@ -0,0 +1,144 @@
+// This file is part of ArboristBase.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file rankmap.h
+
+   @brief Rank vectors stored at the narrowest sufficient width.
+
+   @author Mark Seligman
+ */
+
+#ifndef OBS_RANKMAP_H
+#define OBS_RANKMAP_H
+
+#include "typeparam.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Maps positions to the ranks of a single predictor.
+
+   Ranks are held in eight, sixteen or 32 bits, according to the
+   predictor's rank count, so that binary and low-cardinality
+   predictors occupy a fraction of full-width storage.  Scans dispatch
+   on the width once, through visit(), and then run over a typed
+   array; random access dispatches per lookup.
+ */
+class RankMap {
+  unsigned int width; ///< Bytes per rank.
+  vector<uint8_t> rank8;
+  vector<uint16_t> rank16;
+  vector<uint32_t> rank32;
+
+
+  /**
+     @brief Selects storage by overloading on a null pointer of its type.
+   */
+  uint8_t* base(uint8_t*) {
+    return rank8.data();
+  }
+
+
+  uint16_t* base(uint16_t*) {
+    return rank16.data();
+  }
+
+
+  uint32_t* base(uint32_t*) {
+    return rank32.data();
+  }
+
+public:
+
+  RankMap() :
+    width(sizeof(uint32_t)) {
+  }
+
+
+  /**
+     @param nElt is the number of positions mapped.
+
+     @param rankCount bounds the ranks stored, exclusive.
+   */
+  RankMap(size_t nElt,
+	  IndexT rankCount) :
+    width(rankCount <= 0x100 ? sizeof(uint8_t) : (rankCount <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t))) {
+    if (width == sizeof(uint8_t))
+      rank8 = vector<uint8_t>(nElt);
+    else if (width == sizeof(uint16_t))
+      rank16 = vector<uint16_t>(nElt);
+    else
+      rank32 = vector<uint32_t>(nElt);
+  }
+
+
+  unsigned int getWidth() const {
+    return width;
+  }
+
+
+  /**
+     @return base of the ranks, which must be held as rankType.
+   */
+  template<typename rankType>
+  rankType* getBase() {
+    return base(static_cast<rankType*>(nullptr));
+  }
+
+
+  template<typename rankType>
+  const rankType* getBase() const {
+    return const_cast<RankMap*>(this)->getBase<rankType>();
+  }
+
+
+  /**
+     @brief Applies a function to the typed base of the ranks.
+
+     @param fn is invoked with a pointer to the type held.
+   */
+  template<typename Fn>
+  void visit(const Fn& fn) const {
+    if (width == sizeof(uint8_t))
+      fn(getBase<uint8_t>());
+    else if (width == sizeof(uint16_t))
+      fn(getBase<uint16_t>());
+    else
+      fn(getBase<uint32_t>());
+  }
+
+
+  /**
+     @brief As above, but permits writing.
+   */
+  template<typename Fn>
+  void visit(const Fn& fn) {
+    if (width == sizeof(uint8_t))
+      fn(getBase<uint8_t>());
+    else if (width == sizeof(uint16_t))
+      fn(getBase<uint16_t>());
+    else
+      fn(getBase<uint32_t>());
+  }
+
+
+  IndexT operator[](size_t idx) const {
+    if (width == sizeof(uint8_t))
+      return rank8[idx];
+    else if (width == sizeof(uint16_t))
+      return rank16[idx];
+    else
+      return rank32[idx];
+  }
+};
+
+#endif
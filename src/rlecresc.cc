@@ -14,6 +14,8 @@
  */
 
 #include "rlecresc.h"
+#include "columnfile.h"
+#include "spillsort.h"
 #include "ompthread.h"
 #include <cmath>
 
@@ -33,21 +35,16 @@ void RLECresc::encodeFrame(const vector<void*>& colBase) {
   valFac = vector<vector<unsigned int>>(nFactor);
   valNum = vector<vector<double>>(nNumeric);
 
-  OMPBound nPred = colBase.size();
-#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
-  {
-#pragma omp for schedule(dynamic, 1)
-  for (OMPBound predIdx = 0; predIdx < nPred; predIdx++) {
+  encodeColumns(colBase.size(), [&](OMPBound predIdx, unsigned int nThread) {
     bool isFactor;
     unsigned int typedIdx = getTypedIdx(predIdx, isFactor);
     if (isFactor) { // Only factors and numerics present.
-      encodeColumn<unsigned int>(static_cast<unsigned int*>(colBase[predIdx]), valFac[typedIdx], rle[predIdx]);
+      encodeColumn<unsigned int>(static_cast<unsigned int*>(colBase[predIdx]), valFac[typedIdx], rle[predIdx], nThread);
     }
     else {
-      encodeColumn<double>(static_cast<double*>(colBase[predIdx]), valNum[typedIdx], rle[predIdx]);
+      encodeColumn<double>(static_cast<double*>(colBase[predIdx]), valNum[typedIdx], rle[predIdx], nThread);
     }
-  }
-  }
+  });
 }
 
 
@@ -63,13 +60,9 @@ void RLECresc::encodeFrameNum(const double* feVal) {
   OMPBound nPred = topIdx.size();
   valFac = vector<vector<unsigned int>>(0);
   valNum = vector<vector<double>>(nPred);
-#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
-  {
-#pragma omp for schedule(dynamic, 1)
-    for (OMPBound predIdx = 0; predIdx < nPred; predIdx++) {
-      encodeColumn(&feVal[predIdx * nRow], valNum[predIdx], rle[predIdx]);
-    }
-  }
+  encodeColumns(nPred, [&](OMPBound predIdx, unsigned int nThread) {
+    encodeColumn(&feVal[predIdx * nRow], valNum[predIdx], rle[predIdx], nThread);
+  });
 }
 
 
@@ -77,16 +70,52 @@ void RLECresc::encodeFrameFac(const uint32_t*  feVal) {
   OMPBound nPred = topIdx.size();
   valFac = vector<vector<unsigned int>>(nPred);
   valNum = vector<vector<double>>(0);
-#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
-  {
-#pragma omp for schedule(dynamic, 1)
-    for (OMPBound predIdx = 0; predIdx < nPred; predIdx++) {
-      encodeColumn(&feVal[predIdx * nRow], valFac[predIdx], rle[predIdx]);
+  encodeColumns(nPred, [&](OMPBound predIdx, unsigned int nThread) {
+    encodeColumn(&feVal[predIdx * nRow], valFac[predIdx], rle[predIdx], nThread);
+  });
+}
+
+
+void RLECresc::encodeFile(ColumnFile& colFile,
+			  size_t memBudget) {
+  const vector<unsigned int>& factorTop = colFile.getFactorTop();
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+    setFactor(predIdx, factorTop[predIdx]);
+  }
+  valFac = vector<vector<unsigned int>>(nFactor);
+  valNum = vector<vector<double>>(nNumeric);
+
+  // Columns are visited singly, so that the full budget, and every
+  // thread, is available to each sort.
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+    bool isFactor;
+    unsigned int typedIdx = getTypedIdx(predIdx, isFactor);
+    if (isFactor) {
+      encodeSpill<unsigned int>(colFile, predIdx, memBudget, valFac[typedIdx]);
+    }
+    else {
+      encodeSpill<double>(colFile, predIdx, memBudget, valNum[typedIdx]);
     }
   }
 }
 
 
+template<typename valType>
+void RLECresc::encodeSpill(ColumnFile& colFile,
+			   unsigned int predIdx,
+			   size_t memBudget,
+			   vector<valType>& valOut) {
+  SpillSort<valType>(memBudget).sort(nRow,
+				     [&](size_t rowStart, size_t extent, valType val[]) {
+				       colFile.read(predIdx, rowStart, extent, val);
+				     },
+				     [&](valType val, size_t row) {
+				       encodeNext(val, row, valOut, rle[predIdx]);
+				     },
+				     OmpThread::nThread);
+}
+
+
 void RLECresc::dump(vector<size_t>& valOut,
 		    vector<size_t>& extentOut,
 		    vector<size_t>& rowOut) const {
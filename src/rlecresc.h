@@ -18,6 +18,7 @@
 
 #include "rle.h"
 #include "valrank.h"
+#include "ompthread.h"
 
 #include <cstdint>
 #include <vector>
@@ -98,6 +99,43 @@ class RLECresc {
     }
   }
 
+
+  /**
+     @brief Appends the next value/row pair of a stably-sorted column.
+
+     Incremental form of encode(), for columns arriving as a stream.
+
+     @param[in, out] runValue accumulates unique values in sorted order.
+   */
+  template<typename obsType>
+  void encodeNext(obsType val,
+		  size_t row,
+		  vector<obsType>& runValue,
+		  vector<RLEVal<szType>>& rlePred) {
+    if (runValue.empty() || !areEqual(val, runValue.back())) {
+      runValue.push_back(val);
+      rlePred.emplace_back(RLEVal<szType>(runValue.size() - 1, row));
+    }
+    else if (row != rlePred.back().getRowEnd()) {
+      rlePred.emplace_back(RLEVal<szType>(runValue.size() - 1, row));
+    }
+    else {
+      rlePred.back().extent++;
+    }
+  }
+
+
+  /**
+     @brief Sorts and encodes a single column read from file.
+
+     @param memBudget bounds the bytes held by sorting.
+   */
+  template<typename valType>
+  void encodeSpill(class ColumnFile& colFile,
+		   unsigned int predIdx,
+		   size_t memBudget,
+		   vector<valType>& valOut);
+
   
   /**
      @brief Presorts runlength-encoded numerical block supplied by front end.
@@ -290,6 +328,19 @@ public:
   void encodeFrameFac(const uint32_t* feVal);
 
 
+  /**
+     @brief Encodes a frame read from file, column by column.
+
+     Columns are sorted externally, so that intermediate storage
+     remains within budget regardless of the row count.  Predictor
+     types are set from the file.
+
+     @param memBudget is the number of bytes available to sorting.
+   */
+  void encodeFile(class ColumnFile& colFile,
+		  size_t memBudget);
+
+
   void dump(vector<size_t>& valOut,
 	    vector<size_t>& lengthOut,
 	    vector<size_t>& rowOut) const;
@@ -309,12 +360,43 @@ public:
      @param[out] valOut tabulates the predictor values.
 
      @param[out] rleVal encodes the run-length elements.
+
+     @param nThread is the number of threads sorting the column.
    */
   template<typename valType>
   void encodeColumn(const valType val[],
 		    vector<valType>& valOut,
-		    vector<RLEVal<szType>>& rleVal) {
-    encode(RankedObs<valType>(val, nRow), valOut, rleVal);
+		    vector<RLEVal<szType>>& rleVal,
+		    unsigned int nThread = 1) {
+    encode(RankedObs<valType>(val, nRow, nThread), valOut, rleVal);
+  }
+
+
+  /**
+     @brief Divides threads between columns and within columns.
+
+     Columns are sorted concurrently when there are at least as many
+     as threads, otherwise one at a time, each over all threads.
+
+     @param encodePred encodes a single predictor over a given thread count.
+   */
+  template<typename EncodeFn>
+  void encodeColumns(OMPBound nPred,
+		     const EncodeFn& encodePred) {
+    if (nPred >= OmpThread::nThread) {
+#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+      {
+#pragma omp for schedule(dynamic, 1)
+	for (OMPBound predIdx = 0; predIdx < nPred; predIdx++) {
+	  encodePred(predIdx, 1);
+	}
+      }
+    }
+    else {
+      for (OMPBound predIdx = 0; predIdx < nPred; predIdx++) {
+	encodePred(predIdx, OmpThread::nThread);
+      }
+    }
   }
 };
 #endif
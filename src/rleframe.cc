@@ -14,7 +14,10 @@
  */
 
 #include "rleframe.h"
+#include "framefile.h"
 #include <cmath>
+#include <numeric>
+#include <stdexcept>
 
 
 RLEFrame::RLEFrame(size_t nRow_,
@@ -30,61 +33,110 @@ RLEFrame::RLEFrame(size_t nRow_,
   nObs(nRow_),
   factorTop(factorTop_),
   noRank(max(nObs, static_cast<size_t>(*max_element(factorTop.begin(), factorTop.end())))),
-  rlePred(packRLE(rleHeight, runVal, runRow, runLength)),
-  numRanked(vector<vector<double>>(numHeight.size())),
-  facRanked(vector<vector<unsigned int>>(facHeight.size())),
-  blockIdx(vector<unsigned int>(rleHeight.size())) {
+  rleStore(packRLE(runVal, runRow, runLength)),
+  numStore(numVal),
+  facStore(facVal),
+  denseNum(nullptr) {
 
-  unsigned int numIdx = 0;
+  // Clamps factor values to the proxy level.
   unsigned int factorIdx = 0;
-  size_t numOff = 0;
   size_t facOff = 0;
-  for (unsigned predIdx = 0; predIdx != blockIdx.size(); predIdx++) {
-    if (factorTop[predIdx] == 0) {
-      for (; numOff < numHeight[numIdx]; numOff++) {
-	numRanked[numIdx].emplace_back(numVal[numOff]);
-      }
-      blockIdx[predIdx] = numIdx++;
-    }
-    else {
-      unsigned int maxVal = factorTop[predIdx] + 1;
+  for (auto top : factorTop) {
+    if (top != 0) {
       for (; facOff < facHeight[factorIdx]; facOff++) {
-	facRanked[factorIdx].emplace_back(min(maxVal, facVal[facOff]));
+	facStore[facOff] = min(top + 1, facStore[facOff]);
       }
-      blockIdx[predIdx] = factorIdx++;
+      factorIdx++;
     }
   }
+
+  setSpans(rleStore.data(), rleHeight, numStore.data(), numHeight, facStore.data(), facHeight);
+}
+
+
+RLEFrame::RLEFrame(size_t nObs_,
+		   unsigned int nPred,
+		   const double* denseNum_) :
+  nObs(nObs_),
+  factorTop(vector<unsigned int>(nPred)),
+  noRank(nObs),
+  rlePred(vector<ArraySpan<RLEVal<szType>>>(nPred)),
+  numRanked(vector<ArraySpan<double>>(nPred)),
+  blockIdx(vector<unsigned int>(nPred)),
+  denseNum(denseNum_) {
+  iota(blockIdx.begin(), blockIdx.end(), 0);
+}
+
+
+RLEFrame::RLEFrame(shared_ptr<const FrameFile> frameFile_) :
+  frameFile(frameFile_),
+  nObs(frameFile->getNObs()),
+  factorTop(frameFile->getFactorTop()),
+  noRank(max(nObs, static_cast<size_t>(*max_element(factorTop.begin(), factorTop.end())))),
+  denseNum(nullptr) {
+  setSpans(frameFile->getRLE(), frameFile->getRLEHeight(), frameFile->getNumVal(), frameFile->getNumHeight(), frameFile->getFacVal(), frameFile->getFacHeight());
 }
 
 
-vector<vector<RLEVal<szType>>> RLEFrame::packRLE(const vector<size_t>& rleHeight,
-		       const vector<size_t>& runVal,
-		       const vector<size_t>& runRow,
-		       const vector<size_t>& runLength) {
-  vector<vector<RLEVal<szType>>> rlePred(rleHeight.size());
+RLEFrame::~RLEFrame() = default;
+
+
+void RLEFrame::setSpans(const RLEVal<szType>* rleBase,
+			const vector<size_t>& rleHeight,
+			const double* numBase,
+			const vector<size_t>& numHeight,
+			const unsigned int* facBase,
+			const vector<size_t>& facHeight) {
   size_t rleOff = 0;
-  for (unsigned int predIdx = 0; predIdx < rleHeight.size(); predIdx++) {
-    for (; rleOff < rleHeight[predIdx]; rleOff++) {
-      rlePred[predIdx].emplace_back(runVal[rleOff], runRow[rleOff], runLength[rleOff]);
-    }
+  for (auto height : rleHeight) {
+    rlePred.emplace_back(rleBase + rleOff, height - rleOff);
+    rleOff = height;
   }
 
-  return rlePred;
+  size_t numOff = 0;
+  size_t facOff = 0;
+  for (auto top : factorTop) {
+    if (top == 0) {
+      size_t height = numHeight[numRanked.size()];
+      blockIdx.push_back(numRanked.size());
+      numRanked.emplace_back(numBase + numOff, height - numOff);
+      numOff = height;
+    }
+    else {
+      size_t height = facHeight[facRanked.size()];
+      blockIdx.push_back(facRanked.size());
+      facRanked.emplace_back(facBase + facOff, height - facOff);
+      facOff = height;
+    }
+  }
 }
 
 
+vector<RLEVal<szType>> RLEFrame::packRLE(const vector<size_t>& runVal,
+					 const vector<size_t>& runRow,
+					 const vector<size_t>& runLength) {
+  vector<RLEVal<szType>> rle;
+  rle.reserve(runVal.size());
+  for (size_t rleOff = 0; rleOff < runVal.size(); rleOff++) {
+    rle.emplace_back(runVal[rleOff], runRow[rleOff], runLength[rleOff]);
+  }
+
+  return rle;
+}
+
 
 size_t RLEFrame::findRankMissing(unsigned int predIdx) const {
+  // Missing data, if any, takes the highest rank.
   size_t rankMissing = noRank;
   unsigned int idx = blockIdx[predIdx];
   if (factorTop[predIdx] > 0) { // Factor
     if (facRanked[idx].back() > factorTop[predIdx]) {
-      rankMissing = rlePred[predIdx].back().val;
+      rankMissing = getRankCount(predIdx) - 1;
     }
   }
   else { // Numeric.
     if (isnan(numRanked[idx].back())) {
-      rankMissing = rlePred[predIdx].back().val;
+      rankMissing = getRankCount(predIdx) - 1;
     }
   }
   
@@ -93,8 +145,51 @@ size_t RLEFrame::findRankMissing(unsigned int predIdx) const {
 
 
 void RLEFrame::reorderRow() {
+  if (frameFile != nullptr && rleStore.empty()) {
+    for (auto rleVal : rlePred) {
+      rleStore.insert(rleStore.end(), rleVal.begin(), rleVal.end());
+    }
+  }
+
+  size_t rleOff = 0;
   for (auto & rleVal : rlePred) {
-    sort(rleVal.begin(), rleVal.end(), RLECompareRow<szType>);
+    RLEVal<szType>* rleBase = rleStore.data() + rleOff;
+    sort(rleBase, rleBase + rleVal.size(), RLECompareRow<szType>);
+    rleVal = ArraySpan<RLEVal<szType>>(rleBase, rleVal.size());
+    rleOff += rleVal.size();
+
+    // Images are bounds-checked when mapped, but only once sorted can
+    // their runs be seen to tile the rows, as transposition assumes.
+    if (frameFile != nullptr) {
+      size_t rowEnd = 0;
+      for (auto rle : rleVal) {
+	if (rle.row != rowEnd)
+	  throw runtime_error("Frame image runs do not tile the rows");
+	rowEnd = rle.getRowEnd();
+      }
+    }
+  }
+}
+
+
+void RLEFrame::column(unsigned int predIdx,
+		      vector<double>& num,
+		      vector<unsigned int>& fac) const {
+  unsigned int idx = blockIdx[predIdx];
+  if (denseNum != nullptr) {
+    num.assign(denseNum + idx * nObs, denseNum + (idx + 1) * nObs);
+  }
+  else if (factorTop[predIdx] == 0) {
+    num.resize(nObs);
+    for (auto rle : rlePred[predIdx]) {
+      fill(num.begin() + rle.row, num.begin() + rle.getRowEnd(), numRanked[idx][rle.val]);
+    }
+  }
+  else {
+    fac.resize(nObs);
+    for (auto rle : rlePred[predIdx]) {
+      fill(fac.begin() + rle.row, fac.begin() + rle.getRowEnd(), facRanked[idx][rle.val] - 1);
+    }
   }
 }
 
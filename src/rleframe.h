@@ -18,6 +18,8 @@
 
 #include "rlecresc.h"
 
+#include <memory>
+
 /**
    @brief Sorts on row, for reorder.
 */
@@ -27,17 +29,84 @@ bool RLECompareRow (const RLEVal<valType>& a, const RLEVal<valType>& b) {
 }
 
 
+/**
+   @brief Read-only view of a contiguous array held elsewhere.
+ */
+template<typename eltType>
+class ArraySpan {
+  const eltType* base;
+  size_t extent;
+
+public:
+  ArraySpan(const eltType* base_ = nullptr,
+	    size_t extent_ = 0) :
+    base(base_),
+    extent(extent_) {
+  }
+
+
+  const eltType* begin() const {
+    return base;
+  }
+
+
+  const eltType* end() const {
+    return base + extent;
+  }
+
+
+  size_t size() const {
+    return extent;
+  }
+
+
+  const eltType& operator[](size_t idx) const {
+    return base[idx];
+  }
+
+
+  const eltType& back() const {
+    return base[extent - 1];
+  }
+};
+
+
 /**
    @brief Completed form, constructed from front end representation.
+
+   Runs and ranked values are stored flat, in predictor order, and
+   viewed per predictor.  Storage is either owned or, when constructed
+   over a frame image, viewed in place.
  */
 struct RLEFrame {
+  const shared_ptr<const class FrameFile> frameFile; ///> Image viewed, if any.
   const size_t nObs;
   const vector<unsigned int> factorTop; ///> top factor index / 0.
   const size_t noRank; ///> Inattainable rank index.
-  vector<vector<RLEVal<szType>>> rlePred;
-  vector<vector<double>> numRanked;
-  vector<vector<unsigned int>> facRanked;
+  vector<RLEVal<szType>> rleStore; ///> Owned runs, unless viewing image.
+  vector<double> numStore; ///> Owned numeric values, likewise.
+  vector<unsigned int> facStore; ///> Owned factor values, likewise.
+  vector<ArraySpan<RLEVal<szType>>> rlePred;
+  vector<ArraySpan<double>> numRanked;
+  vector<ArraySpan<unsigned int>> facRanked;
   vector<unsigned int> blockIdx; ///> position of value in block.
+  const double* denseNum; ///> Column-major numeric values, if dense.
+  static constexpr unsigned int denseTile = 0x10; ///> Columns per transpose pass.
+
+
+  /**
+     @brief Partitions flat storage into per-predictor views.
+
+     Heights are cumulative, by predictor, numeric and factor block,
+     respectively.
+   */
+  void setSpans(const RLEVal<szType>* rleBase,
+		const vector<size_t>& rleHeight,
+		const double* numBase,
+		const vector<size_t>& numHeight,
+		const unsigned int* facBase,
+		const vector<size_t>& facHeight);
+
 
   /**
      @brief Constructor from unpacked representation.
@@ -55,12 +124,33 @@ struct RLEFrame {
 
 
   /**
-     @brief Builds the per-predictor vectors of run-length encodings.
+     @brief Constructor over a dense, column-major numeric block.
+
+     Values are read in place, bypassing ranking and encoding.  The
+     block must outlive the frame.
    */
-  static vector<vector<RLEVal<szType>>> packRLE(const vector<size_t>& rleHeight,
-						const vector<size_t>& runVal,
-						const vector<size_t>& runRow,
-						const vector<size_t>& runLength);
+  RLEFrame(size_t nObs_,
+	   unsigned int nPred,
+	   const double* denseNum_);
+
+
+  /**
+     @brief Constructor viewing a mapped frame image, without copying.
+
+     The image remains mapped for the lifetime of the frame.
+   */
+  RLEFrame(shared_ptr<const class FrameFile> frameFile_);
+
+
+  ~RLEFrame();
+
+
+  /**
+     @brief Builds the flat vector of run-length encodings.
+   */
+  static vector<RLEVal<szType>> packRLE(const vector<size_t>& runVal,
+					const vector<size_t>& runRow,
+					const vector<size_t>& runLength);
 
 
   /**
@@ -107,15 +197,31 @@ struct RLEFrame {
   }
 
 
+  /**
+     @return core index of a predictor:  numeric predictors precede factors.
+   */
+  unsigned int getCoreIdx(unsigned int predIdx) const {
+    return factorTop[predIdx] == 0 ? blockIdx[predIdx] : getNPredNum() + blockIdx[predIdx];
+  }
+
+
   unsigned int getFactorTop(unsigned int predIdx) const {
     return factorTop[predIdx];
   }
   
 
-  const vector<RLEVal<szType>>& getRLE(unsigned int predIdx) const {
+  const ArraySpan<RLEVal<szType>>& getRLE(unsigned int predIdx) const {
     return rlePred[predIdx];
   }
 
+
+  /**
+     @return # distinct ranked values of a predictor.
+   */
+  size_t getRankCount(unsigned int predIdx) const {
+    return factorTop[predIdx] == 0 ? numRanked[blockIdx[predIdx]].size() : facRanked[blockIdx[predIdx]].size();
+  }
+
   
   /**
      @brief Derives # distinct values, including possible NA.
@@ -131,6 +237,8 @@ struct RLEFrame {
 
   /**
      @brief Reorders the predictor RLE vectors by row.
+
+     A viewed image is copied first, as it is read-only.
    */
   void reorderRow();
 
@@ -145,6 +253,18 @@ struct RLEFrame {
 				 const vector<size_t>& idxPerm) const;
 
 
+  /**
+     @brief Decodes a single predictor over every row.
+
+     @param[out] num outputs the values, if numeric.
+
+     @param[out] fac outputs the zero-based levels, if factor-valued.
+   */
+  void column(unsigned int predIdx,
+	      vector<double>& num,
+	      vector<unsigned int>& fac) const;
+
+
   /**
      @brief Obtains the predictor rank at a given row.
 
@@ -171,6 +291,10 @@ struct RLEFrame {
 		 size_t extent,
 		 vector<double>& num,
 		 vector<unsigned int>& fac) const {
+    if (denseNum != nullptr) {
+      transposeDense(obsStart, extent, num);
+      return;
+    }
     for (size_t obsIdx = obsStart; obsIdx != min(nObs, obsStart + extent); obsIdx++) {
       unsigned int numIdx = 0;
       unsigned int facIdx = 0;
@@ -186,6 +310,30 @@ struct RLEFrame {
       }
     }
   }
+
+
+  /**
+     @brief Transposes a block of rows directly from dense storage.
+
+     Columns are visited in tiles, so that each is read sequentially
+     while writes remain confined to a few lines per row.
+   */
+  void transposeDense(size_t obsStart,
+		      size_t extent,
+		      vector<double>& num) const {
+    size_t obsEnd = min(nObs, obsStart + extent);
+    size_t nPred = numRanked.size();
+    num.resize((obsEnd - obsStart) * nPred);
+    for (size_t tileStart = 0; tileStart < nPred; tileStart += denseTile) {
+      size_t tileEnd = min(nPred, tileStart + denseTile);
+      for (size_t obsIdx = obsStart; obsIdx != obsEnd; obsIdx++) {
+	double* rowOut = &num[(obsIdx - obsStart) * nPred];
+	for (size_t predIdx = tileStart; predIdx != tileEnd; predIdx++) {
+	  rowOut[predIdx] = denseNum[predIdx * nObs + obsIdx];
+	}
+      }
+    }
+  }
 };
 
 
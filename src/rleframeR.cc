@@ -25,6 +25,8 @@
 
 #include "rleframeR.h"
 #include "signatureR.h"
+#include "columnfile.h"
+#include "framefile.h"
 
 
 List RLEFrameR::presortDF(const DataFrame& df, SEXP sSigTrain, SEXP sLevel, const CharacterVector& predClass) {
@@ -165,6 +167,19 @@ List RLEFrameR::presortFac(const SEXP sX) {
 }
 
 
+List RLEFrameR::presortFile(ColumnFile& colFile,
+			    size_t memBudget) {
+  BEGIN_RCPP
+
+  auto rleCresc = make_unique<RLECresc>(colFile.getNRow(), colFile.getNPred());
+  rleCresc->encodeFile(colFile, memBudget);
+
+  return wrap(rleCresc.get());
+
+  END_RCPP
+}
+
+
 List RLEFrameR::wrap(const RLECresc* rleCresc) {
   BEGIN_RCPP
 
@@ -256,7 +271,16 @@ List RLEFrameR::wrapRF(const RLECresc* rleCresc) {
 
 
 unique_ptr<RLEFrame> RLEFrameR::unwrap(const List& lDeframe) {
+  if (lDeframe.containsElementNamed("denseNum")) {
+    NumericMatrix denseNum((SEXP) lDeframe["denseNum"]);
+    return make_unique<RLEFrame>(denseNum.nrow(), denseNum.ncol(), denseNum.begin());
+  }
+
   List rleList((SEXP) lDeframe["rleFrame"]);
+  if (rleList.inherits("RLEFrameFile")) { // Viewed in place.
+    return make_unique<RLEFrame>(make_shared<const FrameFile>(as<string>(rleList["path"])));
+  }
+
   List blockNum = checkNumRanked((SEXP) rleList["numRanked"]);
   NumericVector numVal(Rf_isNull(blockNum["numVal"]) ? NumericVector(0) : NumericVector((SEXP) blockNum["numVal"]));
   IntegerVector numHeight(Rf_isNull(blockNum["numHeight"]) ? IntegerVector(0) : IntegerVector((SEXP) blockNum["numHeight"]));
@@ -137,6 +137,15 @@ struct RLEFrameR {
 			size_t nRow,
 			unsigned int nPred);
 
+  /**
+     @brief Presorts a frame read from file, within a memory budget.
+
+     @param memBudget is the number of bytes available to sorting.
+   */
+  static List presortFile(class ColumnFile& colFile,
+			  size_t memBudget);
+
+
   /**
      @brief Produces an R-style run-length encoding of the frame.
 
@@ -154,6 +163,9 @@ struct RLEFrameR {
   static List wrapFac(const class RLECresc* rleCresc);
 
   
+  /**
+     @brief Recovers the core frame, mapping its image if file-backed.
+   */
   static unique_ptr<RLEFrame> unwrap(const List& lDeframe);
 
 
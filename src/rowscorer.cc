@@ -0,0 +1,123 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file rowscorer.cc
+
+   @brief Methods for scoring individual rows.
+
+   @author Mark Seligman
+ */
+
+#include "rowscorer.h"
+#include "forest.h"
+
+#include <cmath>
+
+
+static RowScoring scoringOf(const string& scorer) {
+  if (scorer == "sum")
+    return RowScoring::sum;
+  else if (scorer == "logistic")
+    return RowScoring::logistic;
+  else if (scorer == "plurality")
+    return RowScoring::plurality;
+  else
+    return RowScoring::mean;
+}
+
+
+RowScorer::RowScorer(const Forest* forest_,
+		     CtgT nCtg_) :
+  forest(forest_),
+  flatForest(forest->getFlatForest()),
+  quickScorer(forest->getQuickScorer()),
+  nTree(forest->getNTree()),
+  nCtg(nCtg_),
+  scoring(scoringOf(forest->getScoreDesc().scorer)),
+  baseScore(forest->getScoreDesc().baseScore),
+  nu(forest->getScoreDesc().nu),
+  leafBits(vector<uint64_t>(nTree)),
+  treeIdx(vector<IndexT>(nTree)),
+  treeScore(vector<double>(nTree)),
+  census(vector<double>(nCtg)),
+  jitter(vector<double>(nCtg)) {
+}
+
+
+RowScorer::RowScorer(const FlatForest* flatForest_,
+		     const ScoreDesc& scoreDesc,
+		     CtgT nCtg_) :
+  forest(nullptr),
+  flatForest(flatForest_),
+  quickScorer(nullptr),
+  nTree(flatForest->getNTree()),
+  nCtg(nCtg_),
+  scoring(scoringOf(scoreDesc.scorer)),
+  baseScore(scoreDesc.baseScore),
+  nu(scoreDesc.nu),
+  treeScore(vector<double>(nTree)),
+  census(vector<double>(nCtg)),
+  jitter(vector<double>(nCtg)) {
+}
+
+
+void RowScorer::walkRow(const double rowNum[],
+			const CtgT rowFac[]) {
+  if (quickScorer != nullptr) {
+    quickScorer->walkRow(rowNum, &leafBits[0], &treeIdx[0]);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      treeScore[tIdx] = forest->getScore(tIdx, treeIdx[tIdx]);
+    }
+  }
+  else {
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      treeScore[tIdx] = flatForest->getScore(flatForest->walkFlat(rowNum, rowFac, tIdx));
+    }
+  }
+}
+
+
+double RowScorer::score(const double rowNum[],
+			const CtgT rowFac[]) {
+  walkRow(rowNum, rowFac);
+
+  if (scoring == RowScoring::plurality) {
+    fill(census.begin(), census.end(), 0.0);
+    fill(jitter.begin(), jitter.end(), 0.0);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      double score = treeScore[tIdx];
+      CtgT ctg = floor(score); // Truncates jittered score ut index.
+      census[ctg] += 1.0;
+      jitter[ctg] += score - ctg;
+    }
+    // As in ForestPredictionCtg::predictPlurality.
+    double scale = 1.0 / (2 * nTree);
+    CtgT argMax = 0;
+    double valMax = 0.0;
+    for (CtgT ctg = 0; ctg != nCtg; ctg++) {
+      double numVal = census[ctg] + jitter[ctg] * scale;
+      if (numVal > valMax) {
+	valMax = numVal;
+	argMax = ctg;
+      }
+    }
+    return argMax;
+  }
+
+  double sumScore = scoring == RowScoring::mean ? 0.0 : baseScore;
+  for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+    double score = treeScore[tIdx];
+    sumScore += scoring == RowScoring::mean ? score : nu * score;
+  }
+  if (scoring == RowScoring::mean)
+    return sumScore / nTree;
+  else if (scoring == RowScoring::logistic)
+    return 1.0 / (1.0 + exp(-sumScore));
+  else
+    return sumScore;
+}
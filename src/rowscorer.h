@@ -0,0 +1,94 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file rowscorer.h
+
+   @brief Low-latency scoring of individual rows.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_ROWSCORER_H
+#define FOREST_ROWSCORER_H
+
+#include "typeparam.h"
+
+#include <vector>
+#include <cstdint>
+
+
+/**
+   @brief Forest-wide scoring method, resolved once from the descriptor.
+ */
+enum class RowScoring { mean, sum, logistic, plurality };
+
+
+/**
+   @brief Scores bare rows against a prepared forest.
+
+   Walkers and scratch space are built at construction, so scoring
+   neither allocates nor starts a thread team.  An instance is not
+   reentrant:  concurrent callers require separate instances.
+ */
+class RowScorer {
+  const class Forest* forest; ///< Null if scoring a bare layout.
+  const class FlatForest* flatForest;
+  const class QuickScorer* quickScorer; ///< Nonnull iff bitvector-walked.
+  const unsigned int nTree;
+  const CtgT nCtg; ///< Training cardinality; plurality only.
+  const RowScoring scoring;
+  const double baseScore;
+  const double nu;
+  vector<uint64_t> leafBits; ///< QuickScorer scratch.
+  vector<IndexT> treeIdx; ///< Per-tree final index.
+  vector<double> treeScore; ///< Per-tree score.
+  vector<double> census; ///< Plurality scratch, per category.
+  vector<double> jitter; ///< " "
+
+
+  /**
+     @brief Walks the row through every tree, recording final scores.
+   */
+  void walkRow(const double rowNum[],
+	       const CtgT rowFac[]);
+
+public:
+
+  /**
+     @param forest has had its walkers initialized for the row shape.
+
+     @param nCtg is the response cardinality, if categorical, else zero.
+   */
+  RowScorer(const class Forest* forest_,
+	    CtgT nCtg_);
+
+
+  /**
+     @brief Scores against a flattened layout alone, such as one mapped
+     from a file.
+   */
+  RowScorer(const class FlatForest* flatForest_,
+	    const struct ScoreDesc& scoreDesc,
+	    CtgT nCtg_);
+
+
+  /**
+     @brief Scores a single row.
+
+     @param rowNum holds the numeric predictor values, in core order.
+
+     @param rowFac holds the zero-based factor levels, in core order.
+
+     @return regression score, category-one probability under logistic
+     scoring, or zero-based category under plurality.
+   */
+  double score(const double rowNum[],
+	       const CtgT rowFac[]);
+};
+
+#endif
@@ -42,10 +42,14 @@ SampledObs::SampledObs(const Sampler* sampler,
 SampledObs::~SampledObs() = default;
 
 
-void SampledObs::sampleRoot(const PredictorFrame* frame,
-			    NodeScorer* scorer) {
+void SampledObs::prepareRoot(const PredictorFrame* frame,
+			     unsigned int nThread) {
   bagSamples(frame);
-  setRanks(frame);
+  setRanks(frame, nThread);
+}
+
+
+void SampledObs::updateResidual(NodeScorer* scorer) {
   Booster::updateResidual(scorer, this, bagSum);
 }
 
@@ -125,11 +129,12 @@ void SampledObs::bagTrivial(const vector<double>& y,
 }
 
 
-void SampledObs::setRanks(const PredictorFrame* layout) {
-  sample2Rank = vector<vector<IndexT>>(layout->getNPred());
+void SampledObs::setRanks(const PredictorFrame* layout,
+			  unsigned int nThread) {
+  sample2Rank = vector<RankMap>(layout->getNPred());
   runCount = vector<IndexT>(layout->getNPred());
 
-#pragma omp parallel default(shared) num_threads(OmpThread::nThread)
+#pragma omp parallel default(shared) num_threads(nThread)
   {
 #pragma omp for schedule(dynamic, 1)
     for (OMPBound predIdx = 0; predIdx < layout->getNPred(); predIdx++)
@@ -138,19 +143,30 @@ void SampledObs::setRanks(const PredictorFrame* layout) {
 }
 
 
-vector<IndexT> SampledObs::sampleRanks(const PredictorFrame* layout, PredictorT predIdx) {
-  vector<IndexT> sampledRanks(bagCount);
-  const vector<IndexT>& obs2Rank = layout->getRanks(predIdx);
+RankMap SampledObs::sampleRanks(const PredictorFrame* layout, PredictorT predIdx) {
+  IndexT rankCount = layout->getRankMax(predIdx) + 1;
+  RankMap sampledRanks(bagCount, rankCount);
+  layout->getRanks(predIdx).visit([&](const auto* obs2Rank) {
+    typedef remove_const_t<remove_pointer_t<decltype(obs2Rank)>> rankType;
+    runCount[predIdx] = sampleRanks(obs2Rank, sampledRanks.getBase<rankType>(), rankCount);
+  });
+
+  return sampledRanks;
+}
+
+
+template<typename rankType>
+IndexT SampledObs::sampleRanks(const rankType obs2Rank[],
+			       rankType sampledRanks[],
+			       IndexT rankCount) const {
   IndexT sIdx = 0;
-  vector<unsigned char> rankSeen(obs2Rank.size());
-  for (IndexT row = 0; row != obs2Rank.size(); row++) {
+  vector<unsigned char> rankSeen(rankCount);
+  for (IndexT row = 0; row != obs2Sample.size(); row++) {
     if (obs2Sample[row] < bagCount) {
-      IndexT rank = obs2Rank[row];
+      rankType rank = obs2Rank[row];
       sampledRanks[sIdx++] = rank;
       rankSeen[rank] = 1;
     }
   }
-  runCount[predIdx] = accumulate(rankSeen.begin(), rankSeen.end(), 0);
-
-  return sampledRanks;
+  return accumulate(rankSeen.begin(), rankSeen.end(), 0);
 }
@@ -20,6 +20,7 @@
 #include "typeparam.h"
 #include "samplenux.h"
 #include "obs.h"
+#include "rankmap.h"
 
 #include <vector>
 
@@ -42,7 +43,7 @@ class SampledObs {
   vector<SampleNux> sampleNux; ///< Per-sample summary, with row-delta.
 
   // Reset at staging:
-  vector<vector<IndexT>> sample2Rank; ///< Splitting rank map.
+  vector<RankMap> sample2Rank; ///< Splitting rank map, as wide as frame's.
   vector<IndexT> runCount; ///< Staging initialization.
 
 
@@ -70,8 +71,21 @@ class SampledObs {
   /**
      @return map from sample index to predictor rank.
    */
-  vector<IndexT> sampleRanks(const class PredictorFrame* layout,
-			     PredictorT predIdx);
+  RankMap sampleRanks(const class PredictorFrame* layout,
+		      PredictorT predIdx);
+
+
+  /**
+     @brief As above, but over typed rank storage.
+
+     @param[out] sampledRanks outputs the rank of each sample.
+
+     @return number of distinct ranks sampled.
+   */
+  template<typename rankType>
+  IndexT sampleRanks(const rankType obs2Rank[],
+		     rankType sampledRanks[],
+		     IndexT rankCount) const;
 
 
 public:
@@ -99,8 +113,24 @@ public:
   virtual ~SampledObs();
 
   
-  void sampleRoot(const class PredictorFrame* frame,
-		  struct NodeScorer* scorer);
+  /**
+     @brief Bags the samples and maps them to predictor ranks.
+
+     Independent of the boosted estimate, so may overlap training
+     of the preceding tree.
+
+     @param nThread is the number of threads over which to map ranks.
+   */
+  void prepareRoot(const class PredictorFrame* frame,
+		   unsigned int nThread);
+
+
+  /**
+     @brief Applies the boosted estimate to the bagged responses.
+
+     Must follow training of all preceding trees.
+   */
+  void updateResidual(struct NodeScorer* scorer);
 
   
   /**
@@ -244,7 +274,8 @@ public:
   }
 
   
-  void setRanks(const class PredictorFrame* layout);
+  void setRanks(const class PredictorFrame* layout,
+		unsigned int nThread);
 };
 
 
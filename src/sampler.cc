@@ -17,6 +17,7 @@
 #include "quant.h"
 #include "rleframe.h"
 #include "bv.h"
+#include "bagcode.h"
 #include "prng.h"
 
 
@@ -124,19 +125,8 @@ Sampler::Sampler(const vector<PredictorT>& yTrain,
 Sampler::~Sampler() = default;
 
 
-unique_ptr<BitMatrix> Sampler::bagRows(bool bagging) const {
-  if (!bagging)
-    return make_unique<BitMatrix>(0, 0);
-
-  unique_ptr<BitMatrix> matrix = make_unique<BitMatrix>(nRep, nObs);
-  for (unsigned int tIdx = 0; tIdx < nRep; tIdx++) {
-    IndexT obsIdx = 0;
-    for (IndexT sIdx = 0; sIdx != getBagCount(tIdx); sIdx++) {
-      obsIdx += getDelRow(tIdx, sIdx);
-      matrix->setBit(tIdx, obsIdx);
-    }
-  }
-  return matrix;
+unique_ptr<BagCode> Sampler::bagRows(bool bagging) const {
+  return make_unique<BagCode>(this, bagging);
 }
 
 
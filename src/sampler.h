@@ -178,9 +178,9 @@ public:
 
 
   /**
-     @brief Constructs bag according to encoding.
+     @brief Constructs compressed bag according to encoding.
    */
-  unique_ptr<class BitMatrix> bagRows(bool bagging) const;
+  unique_ptr<class BagCode> bagRows(bool bagging) const;
 
 
   IndexT getExtent(unsigned int tIdx) const {
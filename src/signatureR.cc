@@ -72,6 +72,28 @@ List SignatureR::wrapSparse(unsigned int nPred,
 }
 
 
+List SignatureR::wrapTop(const vector<unsigned int>& factorTop,
+			 const vector<string>& colNames,
+			 const vector<vector<string>>& levels) {
+  BEGIN_RCPP
+
+  CharacterVector predClass(factorTop.size());
+  List level;
+  for (unsigned int predIdx = 0; predIdx < factorTop.size(); predIdx++) {
+    if (factorTop[predIdx] == 0) {
+      predClass[predIdx] = strNumericType;
+    }
+    else {
+      predClass[predIdx] = strFactorType;
+      level.push_back(CharacterVector(levels[predIdx].begin(), levels[predIdx].end()));
+    }
+  }
+  return wrapMixed(factorTop.size(), predClass, level, List::create(0), CharacterVector(colNames.begin(), colNames.end()), CharacterVector(0));
+
+  END_RCPP
+}
+
+
 List SignatureR::wrapNumeric(const NumericMatrix& blockNum) {
   BEGIN_RCPP
 
@@ -226,6 +248,16 @@ List SignatureR::getLevel(const List& lTrain) {
 }
 
 
+vector<unsigned int> SignatureR::getCardinality(const List& lTrain) {
+  List level(getLevel(lTrain));
+  vector<unsigned int> facCard;
+  for (R_xlen_t facIdx = 0; facIdx < level.length(); facIdx++) {
+    facCard.push_back(as<CharacterVector>(level[facIdx]).length());
+  }
+  return facCard;
+}
+
+
 SEXP SignatureR::checkFrame(const List &lDeframe) {
   BEGIN_RCPP
   if (!lDeframe.inherits("Deframe")) {
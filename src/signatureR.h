@@ -32,6 +32,7 @@
 #include <Rcpp.h>
 using namespace Rcpp;
 
+#include <vector>
 using namespace std;
 
 
@@ -141,6 +142,12 @@ struct SignatureR {
    */
   static List getLevel(const List& lTrain);
 
+
+  /**
+     @return number of training levels of each categorical predictor.
+   */
+  static vector<unsigned int> getCardinality(const List& lTrain);
+
   
   /**
      @brief Provides a signature for a factor-valued matrix.
@@ -164,6 +171,21 @@ struct SignatureR {
 			 const CharacterVector& colNames,
 			 const CharacterVector& rowNames);
 
+
+  /**
+     @brief Provides a signature for a frame read from file.
+
+     @param factorTop is the highest level, per predictor, else zero.
+
+     @param colNames are the predictor names.
+
+     @param levels are the level labels, per predictor.
+   */
+  static List wrapTop(const vector<unsigned int>& factorTop,
+		      const vector<string>& colNames,
+		      const vector<vector<string>>& levels);
+
+
   /**
      @brief Provides a signature for a mixed data frame.
    */
@@ -0,0 +1,267 @@
+// This file is part of deframe.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file spillsort.h
+
+   @brief External sorting of columns exceeding a memory budget.
+
+   @author Mark Seligman
+ */
+
+#ifndef DEFRAME_SPILLSORT_H
+#define DEFRAME_SPILLSORT_H
+
+#include "radixsort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+
+/**
+   @brief Orders a column on value, then row, within a fixed budget.
+
+   The column is read in chunks, each radix-sorted in memory and, unless
+   the column fits in a single chunk, spilled to an anonymous temporary
+   file as a sorted run.  Runs are then merged, through a heap, fanIn
+   at a time, with intermediate merges spilled as well, until a single
+   merge streams the column to the caller.  Budgeted memory therefore
+   bounds the sort buffers and the merge buffers, but not the caller's
+   output.
+ */
+template<typename valType>
+class SpillSort {
+  /**
+     @brief Sort record:  value and row.
+   */
+  struct ValRow {
+    valType val;
+    size_t row;
+  };
+
+  typedef typename RadixKey<valType>::keyType keyType;
+  typedef unique_ptr<FILE, int(*)(FILE*)> RunFile;
+
+  static constexpr size_t sliceMax = 0x10000; ///< Values per column read.
+  static constexpr size_t bufMin = 0x1000; ///< Minimum records per merge buffer.
+
+  const size_t recMax; ///< # records held within budget.
+  const size_t runMax; ///< # records per run:  sorting doubles footprint.
+  const size_t fanIn; ///< Maximum # runs merged at once.
+  vector<RunFile> run;
+
+
+  /**
+     @brief Sequential reader over a single run, buffered.
+   */
+  struct RunReader {
+    FILE* file;
+    vector<ValRow> buf;
+    size_t pos;
+    size_t end;
+
+    RunReader(FILE* file_,
+	      size_t bufSize) :
+      file(file_),
+      buf(vector<ValRow>(bufSize)),
+      pos(0),
+      end(0) {
+    }
+
+
+    /**
+       @return true iff a record is available at 'pos'.
+     */
+    bool fill() {
+      if (pos == end) {
+	end = fread(buf.data(), sizeof(ValRow), buf.size(), file);
+	pos = 0;
+	if (end == 0 && ferror(file))
+	  throw runtime_error("Error reading sorted run");
+      }
+      return pos < end;
+    }
+  };
+
+
+  static bool precedes(const ValRow& a,
+		       const ValRow& b) {
+    keyType keyA = RadixKey<valType>::key(a.val);
+    keyType keyB = RadixKey<valType>::key(b.val);
+    return keyA < keyB || (keyA == keyB && a.row < b.row);
+  }
+
+
+  static RunFile openRun() {
+    RunFile file(tmpfile(), fclose);
+    if (file == nullptr)
+      throw runtime_error("Cannot create temporary file for sorted run");
+    return file;
+  }
+
+
+  static void writeRun(FILE* file,
+		       const ValRow rec[],
+		       size_t nRec) {
+    if (fwrite(rec, sizeof(ValRow), nRec, file) != nRec)
+      throw runtime_error("Error writing sorted run");
+  }
+
+
+  /**
+     @brief Merges runs via a heap over their current heads.
+
+     @param runs are positioned at their first record.
+
+     @param emit consumes records in merged order.
+   */
+  template<typename EmitFn>
+  void merge(const vector<FILE*>& runs,
+	     const EmitFn& emit) const {
+    size_t bufSize = max(bufMin, recMax / (runs.size() + 1));
+    vector<RunReader> reader;
+    for (FILE* file : runs) {
+      reader.emplace_back(file, bufSize);
+    }
+
+    auto later = [&reader](size_t a, size_t b) {
+      return precedes(reader[b].buf[reader[b].pos], reader[a].buf[reader[a].pos]);
+    };
+    priority_queue<size_t, vector<size_t>, decltype(later)> head(later);
+    for (size_t runIdx = 0; runIdx < reader.size(); runIdx++) {
+      if (reader[runIdx].fill())
+	head.push(runIdx);
+    }
+    while (!head.empty()) {
+      size_t runIdx = head.top();
+      head.pop();
+      RunReader& top = reader[runIdx];
+      emit(top.buf[top.pos++]);
+      if (top.fill())
+	head.push(runIdx);
+    }
+  }
+
+
+  /**
+     @brief Merges successive groups of fanIn runs until fanIn or fewer remain.
+   */
+  void reduceRuns() {
+    while (run.size() > fanIn) {
+      vector<RunFile> runNext;
+      vector<ValRow> out;
+      out.reserve(bufMin);
+      for (size_t runStart = 0; runStart < run.size(); runStart += fanIn) {
+	vector<FILE*> group;
+	for (size_t runIdx = runStart; runIdx < min(run.size(), runStart + fanIn); runIdx++) {
+	  group.push_back(run[runIdx].get());
+	}
+	RunFile merged = openRun();
+	merge(group, [&](const ValRow& rec) {
+	  out.push_back(rec);
+	  if (out.size() == out.capacity()) {
+	    writeRun(merged.get(), out.data(), out.size());
+	    out.clear();
+	  }
+	});
+	writeRun(merged.get(), out.data(), out.size());
+	out.clear();
+	rewind(merged.get());
+	runNext.push_back(std::move(merged));
+	for (size_t runIdx = runStart; runIdx < min(run.size(), runStart + fanIn); runIdx++) {
+	  run[runIdx].reset();
+	}
+      }
+      run = std::move(runNext);
+    }
+  }
+
+public:
+
+  /**
+     @brief Lower bound on budget, in bytes, below which merging thrashes.
+   */
+  static constexpr size_t budgetMin = 4 * bufMin * sizeof(ValRow);
+
+
+  /**
+     @param memBudget is the number of bytes available to sort buffers.
+   */
+  SpillSort(size_t memBudget) :
+    recMax(max(memBudget, budgetMin) / sizeof(ValRow)),
+    runMax(recMax / 2),
+    fanIn(max<size_t>(2, recMax / bufMin - 1)) {
+  }
+
+
+  /**
+     @brief Sorts a column, streaming the result.
+
+     @param nRow is the column length.
+
+     @param read copies a slice of values, given its starting row and extent.
+
+     @param emit consumes values and rows in sorted order.
+
+     @param nThread is the number of threads over which to sort chunks.
+   */
+  template<typename ReadFn, typename EmitFn>
+  void sort(size_t nRow,
+	    const ReadFn& read,
+	    const EmitFn& emit,
+	    unsigned int nThread) {
+    vector<ValRow> rec;
+    vector<valType> slice(min(nRow, sliceMax));
+    for (size_t runStart = 0; runStart < nRow; runStart += runMax) {
+      size_t runEnd = min(nRow, runStart + runMax);
+      rec.clear();
+      rec.reserve(runEnd - runStart);
+      for (size_t rowStart = runStart; rowStart < runEnd; rowStart += slice.size()) {
+	size_t extent = min(slice.size(), runEnd - rowStart);
+	read(rowStart, extent, slice.data());
+	for (size_t idx = 0; idx < extent; idx++) {
+	  rec.push_back(ValRow{slice[idx], rowStart + idx});
+	}
+      }
+
+      if (rec.size() >= RadixSort::radixMin)
+	RadixSort::sort(rec, nThread);
+      else
+	std::sort(rec.begin(), rec.end(), precedes);
+
+      if (runEnd - runStart == nRow) { // Column fits:  no spilling.
+	for (const ValRow& vr : rec) {
+	  emit(vr.val, vr.row);
+	}
+	return;
+      }
+      RunFile file = openRun();
+      writeRun(file.get(), rec.data(), rec.size());
+      rewind(file.get());
+      run.push_back(std::move(file));
+    }
+    vector<ValRow>().swap(rec);
+
+    reduceRuns();
+    vector<FILE*> runs;
+    for (const RunFile& file : run) {
+      runs.push_back(file.get());
+    }
+    merge(runs, [&emit](const ValRow& vr) {
+      emit(vr.val, vr.row);
+    });
+    run.clear();
+  }
+};
+
+#endif
@@ -51,7 +51,8 @@ SEXP TrainR::initPerInvocation(const List& argList,
   trainBridge.initNodeScorer(as<string>(argList["nodeScore"]));
   trainBridge.initTree(as<unsigned int>(argList["maxLeaf"]));
   trainBridge.initGrove(as<bool>(argList["thinLeaves"]),
-			as<unsigned int>(argList["treeBlock"]));
+			as<unsigned int>(argList["treeBlock"]),
+			as<double>(argList["memCap"]) * 1.0e6);
   trainBridge.initOmp(as<unsigned int>(argList["nThread"]));
   
   if (!Rf_isFactor((SEXP) argList["y"])) {
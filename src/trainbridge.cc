@@ -37,8 +37,9 @@ void TrainBridge::init(unsigned int nPred) {
 
 
 void TrainBridge::initGrove(bool thinLeaves,
-			    unsigned int trainBlock) {
-  FETrain::initGrove(thinLeaves, trainBlock);
+			    unsigned int trainBlock,
+			    size_t memCap) {
+  FETrain::initGrove(thinLeaves, trainBlock, memCap);
 }
 
 
@@ -57,9 +57,12 @@ struct TrainBridge {
      @param thinLeaves is true iff leaf information elided.
      
      @param trainBlock is the number of trees by which to block.
+
+     @param memCap bounds the bytes used by concurrently-trained trees.
   */
   static void initGrove(bool thinLeaves,
-			unsigned int trainBlock);
+			unsigned int trainBlock,
+			size_t memCap);
 
 
   static void initProb(unsigned int predFixed,
@@ -16,9 +16,7 @@
 
 #include "treenode.h"
 #include "predictframe.h"
-#include "predictorframe.h"
 #include "bv.h"
-#include "splitnux.h"
 
 unsigned int TreeNode::rightBits = 0;
 PredictorT TreeNode::rightMask = 0;
@@ -49,28 +47,6 @@ bool TreeNode::trapAndBail() {
 }
 
 
-void TreeNode::critCut(const SplitNux& nux,
-		       const class SplitFrontier* splitFrontier) {
-  setPredIdx(nux.getPredIdx());
-  criterion.critCut(nux, splitFrontier);
-}
-
-
-void TreeNode::critBits(const SplitNux& nux,
-			size_t bitPos) {
-  setPredIdx(nux.getPredIdx());
-  criterion.critBits(bitPos);
-}
-  
-
-void TreeNode::setQuantRank(const PredictorFrame* frame) {
-  PredictorT predIdx = getPredIdx();
-  if (isNonterminal() && !frame->isFactor(predIdx)) {
-    criterion.setQuantRank(frame, predIdx);
-  }
-}
-
-
 IndexT TreeNode::advanceMixed(const PredictFrame& frame,
 			      const vector<BV>& factorBits,
 			      const vector<BV>& bitsObserved,
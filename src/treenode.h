@@ -212,7 +212,17 @@ public:
     if (trapUnobserved && isnan(numVal))
       return 0;
     else
-      return delInvert(invert ? (numVal > getSplitNum()) : (numVal <= getSplitNum()));
+      return branchNum(numVal);
+  }
+
+
+  /**
+     @brief As above, but taking a branch irrespective of trapping.
+
+     @return delta to branch target.
+   */
+  inline IndexT branchNum(const double numVal) const {
+    return delInvert(invert ? (numVal > getSplitNum()) : (numVal <= getSplitNum()));
   }
 
 
@@ -0,0 +1,218 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file treeshap.cc
+
+   @brief Methods computing TreeSHAP contributions.
+
+   @author Mark Seligman
+ */
+
+#include "treeshap.h"
+#include "forest.h"
+#include "sampler.h"
+#include "rleframe.h"
+#include "scoredesc.h"
+
+#include <algorithm>
+
+
+TreeShap::TreeShap(const Forest* forest_,
+		   const Sampler* sampler,
+		   const RLEFrame* rleFrame,
+		   const ScoreDesc* scoreDesc) :
+  forest(forest_),
+  nPredNum(rleFrame->getNPredNum()),
+  scale(scoreDesc->scorer == "mean" ? 1.0 / forest->getNTree() : scoreDesc->nu),
+  core2FE(vector<PredictorT>(rleFrame->getNPred())),
+  nodeCover(forest->getLeaf().cover(sampler)),
+  maxDepth(0),
+  bias(scoreDesc->scorer == "mean" ? 0.0 : scoreDesc->baseScore) {
+  for (PredictorT predIdx = 0; predIdx < core2FE.size(); predIdx++) {
+    core2FE[rleFrame->getCoreIdx(predIdx)] = predIdx;
+  }
+
+  // Leaf cover is propagated upward, children succeeding parents.
+  for (unsigned int tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
+    const vector<DecNode>& node = forest->getNode(tIdx);
+    vector<double> cover(node.size());
+    vector<unsigned int> depth(node.size());
+    for (IndexT nodeIdx = 0; nodeIdx < node.size(); nodeIdx++) {
+      IndexT leafIdx;
+      if (node[nodeIdx].getLeafIdx(leafIdx)) {
+	cover[nodeIdx] = nodeCover[tIdx][leafIdx];
+      }
+      else {
+	IndexT delIdx = node[nodeIdx].getDelIdx();
+	depth[nodeIdx + delIdx] = depth[nodeIdx + delIdx + 1] = depth[nodeIdx] + 1;
+	maxDepth = max(maxDepth, depth[nodeIdx] + 1);
+      }
+    }
+    double expected = 0.0;
+    for (IndexT nodeIdx = node.size(); nodeIdx-- > 0; ) {
+      if (node[nodeIdx].isTerminal()) {
+	expected += cover[nodeIdx] * forest->getScore(tIdx, nodeIdx);
+      }
+      else {
+	IndexT delIdx = node[nodeIdx].getDelIdx();
+	cover[nodeIdx] = cover[nodeIdx + delIdx] + cover[nodeIdx + delIdx + 1];
+      }
+    }
+    if (cover[0] > 0.0)
+      bias += scale * expected / cover[0];
+    nodeCover[tIdx] = std::move(cover);
+  }
+}
+
+
+void TreeShap::explainRow(const double rowNum[],
+			  const CtgT rowFac[],
+			  double phiOut[]) const {
+  PredictorT nPred = core2FE.size();
+  // Per-thread scratch is reused across rows.
+  static thread_local vector<double> phi;
+  static thread_local vector<PathElt> path;
+  phi.assign(nPred, 0.0);
+  size_t pathSize = ((maxDepth + 2) * (maxDepth + 3)) / 2;
+  if (path.size() < pathSize)
+    path.resize(pathSize);
+  for (unsigned int tIdx = 0; tIdx < forest->getNTree(); tIdx++) {
+    if (nodeCover[tIdx][0] > 0.0)
+      recurse(tIdx, 0, rowNum, rowFac, phi.data(), path.data(), 0, 1.0, 1.0, -1);
+  }
+
+  for (PredictorT coreIdx = 0; coreIdx < nPred; coreIdx++) {
+    phiOut[core2FE[coreIdx]] = scale * phi[coreIdx];
+  }
+  phiOut[nPred] = bias;
+}
+
+
+IndexT TreeShap::branch(unsigned int tIdx,
+			IndexT nodeIdx,
+			const double rowNum[],
+			const CtgT rowFac[]) const {
+  const DecNode& node = forest->getNode(tIdx)[nodeIdx];
+  PredictorT predIdx = node.getPredIdx();
+  if (predIdx < nPredNum)
+    return nodeIdx + node.branchNum(rowNum[predIdx]);
+  else
+    return nodeIdx + node.delTest(forest->getTree(tIdx).getFacSplit().testBit(node.getBitOffset() + rowFac[predIdx - nPredNum]));
+}
+
+
+void TreeShap::recurse(unsigned int tIdx,
+		       IndexT nodeIdx,
+		       const double rowNum[],
+		       const CtgT rowFac[],
+		       double phi[],
+		       PathElt parentPath[],
+		       unsigned int depth,
+		       double zeroFraction,
+		       double oneFraction,
+		       int predIdx) const {
+  PathElt* path = parentPath + depth + 1;
+  copy(parentPath, parentPath + depth + 1, path);
+  extendPath(path, depth, zeroFraction, oneFraction, predIdx);
+
+  const DecNode& node = forest->getNode(tIdx)[nodeIdx];
+  if (node.isTerminal()) {
+    double score = forest->getScore(tIdx, nodeIdx);
+    for (unsigned int pathIdx = 1; pathIdx <= depth; pathIdx++) {
+      const PathElt& elt = path[pathIdx];
+      phi[elt.predIdx] += unwoundSum(path, depth, pathIdx) * (elt.oneFraction - elt.zeroFraction) * score;
+    }
+    return;
+  }
+
+  IndexT hotIdx = branch(tIdx, nodeIdx, rowNum, rowFac);
+  IndexT delIdx = node.getDelIdx();
+  IndexT coldIdx = hotIdx == nodeIdx + delIdx ? hotIdx + 1 : nodeIdx + delIdx;
+  const vector<double>& cover = nodeCover[tIdx];
+  double hotZero = cover[hotIdx] / cover[nodeIdx];
+  double coldZero = cover[coldIdx] / cover[nodeIdx];
+
+  // A predictor recurring along the path is unwound, then re-extended.
+  int splitIdx = node.getPredIdx();
+  double inZero = 1.0;
+  double inOne = 1.0;
+  unsigned int pathIdx = 0;
+  for (; pathIdx <= depth; pathIdx++) {
+    if (path[pathIdx].predIdx == splitIdx)
+      break;
+  }
+  if (pathIdx <= depth) {
+    inZero = path[pathIdx].zeroFraction;
+    inOne = path[pathIdx].oneFraction;
+    unwindPath(path, depth, pathIdx);
+    depth--;
+  }
+
+  if (cover[hotIdx] > 0.0)
+    recurse(tIdx, hotIdx, rowNum, rowFac, phi, path, depth + 1, hotZero * inZero, inOne, splitIdx);
+  if (cover[coldIdx] > 0.0)
+    recurse(tIdx, coldIdx, rowNum, rowFac, phi, path, depth + 1, coldZero * inZero, 0.0, splitIdx);
+}
+
+
+void TreeShap::extendPath(PathElt path[],
+			  unsigned int depth,
+			  double zeroFraction,
+			  double oneFraction,
+			  int predIdx) {
+  path[depth] = PathElt{predIdx, zeroFraction, oneFraction, depth == 0 ? 1.0 : 0.0};
+  for (int i = depth - 1; i >= 0; i--) {
+    path[i + 1].pWeight += oneFraction * path[i].pWeight * (i + 1) / (depth + 1);
+    path[i].pWeight = zeroFraction * path[i].pWeight * (depth - i) / (depth + 1);
+  }
+}
+
+
+void TreeShap::unwindPath(PathElt path[],
+			  unsigned int depth,
+			  unsigned int pathIdx) {
+  double oneFraction = path[pathIdx].oneFraction;
+  double zeroFraction = path[pathIdx].zeroFraction;
+  double nextOne = path[depth].pWeight;
+  for (int i = depth - 1; i >= 0; i--) {
+    if (oneFraction != 0.0) {
+      double pWeight = path[i].pWeight;
+      path[i].pWeight = nextOne * (depth + 1) / ((i + 1) * oneFraction);
+      nextOne = pWeight - path[i].pWeight * zeroFraction * (depth - i) / (depth + 1);
+    }
+    else {
+      path[i].pWeight = path[i].pWeight * (depth + 1) / (zeroFraction * (depth - i));
+    }
+  }
+  for (unsigned int i = pathIdx; i < depth; i++) {
+    path[i].predIdx = path[i + 1].predIdx;
+    path[i].zeroFraction = path[i + 1].zeroFraction;
+    path[i].oneFraction = path[i + 1].oneFraction;
+  }
+}
+
+
+double TreeShap::unwoundSum(const PathElt path[],
+			    unsigned int depth,
+			    unsigned int pathIdx) {
+  double oneFraction = path[pathIdx].oneFraction;
+  double zeroFraction = path[pathIdx].zeroFraction;
+  double nextOne = path[depth].pWeight;
+  double total = 0.0;
+  for (int i = depth - 1; i >= 0; i--) {
+    if (oneFraction != 0.0) {
+      double pWeight = nextOne * (depth + 1) / ((i + 1) * oneFraction);
+      total += pWeight;
+      nextOne = path[i].pWeight - pWeight * zeroFraction * (depth - i) / double(depth + 1);
+    }
+    else if (zeroFraction != 0.0) {
+      total += (path[i].pWeight / zeroFraction) / ((depth - i) / double(depth + 1));
+    }
+  }
+  return total;
+}
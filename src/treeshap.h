@@ -0,0 +1,141 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file treeshap.h
+
+   @brief Per-row feature contributions by polynomial-time TreeSHAP.
+
+   @author Mark Seligman
+ */
+
+#ifndef FOREST_TREESHAP_H
+#define FOREST_TREESHAP_H
+
+#include "typeparam.h"
+
+#include <vector>
+
+
+/**
+   @brief Attributes each row's forest score to its predictors.
+
+   Contributions are the exact Shapley values of the tree-path-dependent
+   conditional expectation, computed in time polynomial in tree depth
+   by the recursion of Lundberg, Erion and Lee.  Node cover is the
+   in-bag sample count, summed over the leaves a node dominates.  The
+   untrapped model is explained:  contributions and bias sum to the
+   score obtained by walking every tree.
+ */
+class TreeShap {
+  /**
+     @brief Summary of a distinct predictor along the path to a node.
+   */
+  struct PathElt {
+    int predIdx; ///< Core predictor index; -1 at root.
+    double zeroFraction; ///< Cover fraction of the path with predictor absent.
+    double oneFraction; ///< Unity iff row follows the path.
+    double pWeight; ///< Permutation weight.
+  };
+
+  const class Forest* forest;
+  const PredictorT nPredNum;
+  const double scale; ///< Weighs each tree's score in the forest score.
+  vector<PredictorT> core2FE; ///< Maps core to front-end predictor index.
+  vector<vector<double>> nodeCover; ///< Training cover, per tree/node.
+  unsigned int maxDepth; ///< Deepest node over the forest.
+  double bias; ///< Expected forest score.
+
+
+  /**
+     @brief Grows the path by a single predictor.
+   */
+  static void extendPath(PathElt path[],
+			 unsigned int depth,
+			 double zeroFraction,
+			 double oneFraction,
+			 int predIdx);
+
+
+  /**
+     @brief Removes a path element, restoring the weights it displaced.
+   */
+  static void unwindPath(PathElt path[],
+			 unsigned int depth,
+			 unsigned int pathIdx);
+
+
+  /**
+     @return total permutation weight with a path element removed.
+   */
+  static double unwoundSum(const PathElt path[],
+			   unsigned int depth,
+			   unsigned int pathIdx);
+
+
+  /**
+     @return node index reached by a row from a nonterminal node.
+   */
+  IndexT branch(unsigned int tIdx,
+		IndexT nodeIdx,
+		const double rowNum[],
+		const CtgT rowFac[]) const;
+
+
+  /**
+     @brief Accumulates contributions from the subtree rooted at a node.
+
+     @param path holds the parent's path, followed by scratch space.
+
+     @param[in, out] phi accumulates contributions by core index.
+   */
+  void recurse(unsigned int tIdx,
+	       IndexT nodeIdx,
+	       const double rowNum[],
+	       const CtgT rowFac[],
+	       double phi[],
+	       PathElt path[],
+	       unsigned int depth,
+	       double zeroFraction,
+	       double oneFraction,
+	       int predIdx) const;
+
+public:
+
+  /**
+     @param forest has a populated leaf.
+
+     @param sampler supplies in-bag sample counts.
+
+     @param rleFrame orders the predictors as in the front end.
+   */
+  TreeShap(const class Forest* forest_,
+	   const class Sampler* sampler,
+	   const class RLEFrame* rleFrame,
+	   const struct ScoreDesc* scoreDesc);
+
+
+  /**
+     @return # front-end predictors.
+   */
+  PredictorT getNPred() const {
+    return core2FE.size();
+  }
+
+
+  /**
+     @brief Computes the contributions of a single row.
+
+     @param[out] phiOut outputs a contribution for each front-end
+     predictor, in order, followed by the bias.
+   */
+  void explainRow(const double rowNum[],
+		  const CtgT rowFac[],
+		  double phiOut[]) const;
+};
+
+#endif
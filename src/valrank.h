@@ -18,6 +18,7 @@
 #define DEFRAME_VALRANK_H
 
 #include "typeparam.h" // For now
+#include "radixsort.h"
 
 #include <algorithm>
 #include <vector>
@@ -70,12 +71,17 @@ class RankedObs {
 
 public:
 
+  /**
+     @param nThread is the number of threads over which to sort.
+   */
   RankedObs(const valType val[],
-	    size_t nRow) {
+	    size_t nRow,
+	    unsigned int nThread = 1) {
+    valRow.reserve(nRow);
     for (size_t row = 0; row < nRow; row++) {
       valRow.emplace_back(val[row], row);
     }
-    order();
+    order(nThread);
   }
 
 
@@ -117,12 +123,17 @@ public:
   /**
      @brief Orders and assigns ranks.
      
-     Ensures a stable sort ut identify maximal runs.
+     Ensures a stable sort ut identify maximal runs.  Entries arrive in
+     row order, so a stable radix sort on value alone suffices for all
+     but short inputs.
 
      N.B.:  extraneous parentheses work around parser error in older g++.
    */
-  void order() {
-    sort(valRow.begin(), valRow.end(), ValRankCompare<valType>);
+  void order(unsigned int nThread) {
+    if (valRow.size() >= RadixSort::radixMin)
+      RadixSort::sort(valRow, nThread);
+    else
+      sort(valRow.begin(), valRow.end(), ValRankCompare<valType>);
 
     // Increments rank values beginning from default value of zero at base.
     //